@@ -1,5 +1,12 @@
 #include "bezier_library/bezier_library.hpp"
+#include "bezier_library/bezier_checkpoint.hpp"
+#include "bezier_library/bezier_display.hpp"
+#include "bezier_library/bezier_pass_view.hpp"
+#include "bezier_library/bezier_preview.hpp"
+#include "bezier_library/bezier_reachability.hpp"
+#include "bezier_library/bezier_trajectory.hpp"
 //C++ common
+#include <algorithm>
 #include <limits>
 
 // ROS headers
@@ -9,13 +16,19 @@
 #include <visualization_msgs/Marker.h>
 #include <moveit/move_group_interface/move_group.h>
 #include <moveit/planning_interface/planning_interface.h>
+#include <moveit/robot_state/robot_state.h>
 #include <tf/transform_listener.h>
 #include <tf_conversions/tf_eigen.h>
 #include <visualization_msgs/MarkerArray.h>
 #include <moveit_msgs/ExecuteKnownTrajectory.h>
 #include <eigen_conversions/eigen_msg.h>
 #include <math.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <sys/stat.h>
 #include <Eigen/StdVector>
+#include <boost/lexical_cast.hpp>
+#include <boost/scoped_ptr.hpp>
 
 /**
  * @file bezier_application.hpp
@@ -29,6 +42,61 @@
  */
 
 
+/** @brief Print progress of path generation in ROS log (once per second, and at the end) */
+class LogProgressCallback : public BezierProgressCallback
+{
+  public:
+    void progress(const BezierProgress &progress)
+    {
+        if (progress.stage == BEZIER_STAGE_DONE)
+            ROS_INFO("Path generation done in %.1f s", progress.elapsed_time);
+        else
+            ROS_INFO_THROTTLE(1.0, "Path generation : stage %d, passe %d/%d, %.0f %% (%.0f s remaining)", (int)progress.stage,
+                              progress.passe + 1, progress.number_of_passes, progress.fraction * 100, progress.remaining_time);
+    }
+};
+
+/** @brief Convert a timed Cartesian trajectory into a joint trajectory (IK of each pose, seeded with previous solution)
+ * @param[in] timed_trajectory timed poses (see BezierTrajectory)
+ * @param[in] frame pose of the trajectory frame in the robot model frame
+ * @param[in, out] state robot state used as IK seed (current robot state)
+ * @param[in] joint_model_group group solving IK
+ * @param[out] trajectory joint trajectory (positions, finite difference velocities and times)
+ * @return false if a pose has no IK solution */
+bool timedTrajectoryToJointTrajectory(const BezierTrajectory::Points &timed_trajectory, const Eigen::Affine3d &frame, robot_state::RobotState &state,
+                                      const robot_state::JointModelGroup *joint_model_group, moveit_msgs::RobotTrajectory &trajectory)
+{
+    trajectory_msgs::JointTrajectory &joint_trajectory = trajectory.joint_trajectory;
+    joint_trajectory.joint_names = joint_model_group->getVariableNames();
+    joint_trajectory.points.resize(timed_trajectory.size());
+    for (size_t i = 0; i < timed_trajectory.size(); i++)
+    {
+        if (!state.setFromIK(joint_model_group, frame * timed_trajectory[i].pose, 10, 0.1))
+        {
+            ROS_ERROR("No IK solution for timed pose %lu", (unsigned long)i);
+            return false;
+        }
+        state.copyJointGroupPositions(joint_model_group, joint_trajectory.points[i].positions);
+        joint_trajectory.points[i].time_from_start = ros::Duration(timed_trajectory[i].time);
+    }
+    // Joint velocities : central differences, robot at rest at both ends
+    for (size_t i = 0; i < joint_trajectory.points.size(); i++)
+    {
+        std::vector<double> &velocities = joint_trajectory.points[i].velocities;
+        velocities.assign(joint_trajectory.joint_names.size(), 0);
+        if (i == 0 || i + 1 == joint_trajectory.points.size())
+            continue;
+        const trajectory_msgs::JointTrajectoryPoint &previous = joint_trajectory.points[i - 1];
+        const trajectory_msgs::JointTrajectoryPoint &next = joint_trajectory.points[i + 1];
+        double dt = (next.time_from_start - previous.time_from_start).toSec();
+        if (dt <= 0)
+            continue;
+        for (size_t j = 0; j < velocities.size(); j++)
+            velocities[j] = (next.positions[j] - previous.positions[j]) / dt;
+    }
+    return true;
+}
+
 /** @brief The main function
  * @param[in] argc
  * @param[in] argv
@@ -69,11 +137,12 @@ int main(int argc, char **argv)
 
     ////////// CREATE PUBLISHERS FOR POINT CLOUDS AND MARKER //////////
     ros::Publisher trajectory_publisher, input_mesh_publisher, default_mesh_publisher, dilated_mesh_publisher, normal_publisher;
-    trajectory_publisher = node.advertise<visualization_msgs::Marker>("my_trajectory", 1);
-    input_mesh_publisher = node.advertise<visualization_msgs::Marker>("my_input_mesh", 1);
-    default_mesh_publisher = node.advertise<visualization_msgs::Marker>("my_default_mesh", 1);
-    dilated_mesh_publisher = node.advertise<visualization_msgs::Marker>("my_dilated_mesh", 1);
-    normal_publisher = node.advertise<visualization_msgs::MarkerArray>("my_normals", 1);
+    //latched publishers : markers are received by RVIZ whenever it connects, display never waits
+    trajectory_publisher = node.advertise<visualization_msgs::Marker>("my_trajectory", 1, true);
+    input_mesh_publisher = node.advertise<visualization_msgs::Marker>("my_input_mesh", 1, true);
+    default_mesh_publisher = node.advertise<visualization_msgs::Marker>("my_default_mesh", 1, true);
+    dilated_mesh_publisher = node.advertise<visualization_msgs::Marker>("my_dilated_mesh", 1, true);
+    normal_publisher = node.advertise<visualization_msgs::Marker>("my_normals", 1, true);
 
     ////////// GENERATE TRAJECTORY //////////
     double covering_percentage = 0.5; //value between 0 & 1
@@ -81,48 +150,195 @@ int main(int argc, char **argv)
     double grind_depth = 0.05;
     int extrication_frequency = 5; //genere a new extrication mesh each 4 pass generated
     int extrication_coefficiant = 1;
-    Bezier grind_object(MESH_ORIGIN_DIR,MESH_DEFAULT_DIR,grind_depth,grind_diameter,covering_percentage,extrication_coefficiant,extrication_frequency);
     std::vector<bool> points_color_viz;
     std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > way_points_vector;
     std::vector<int> index_vector;
+    std::vector<bool> reachable_vector;
 
     ////////// DISPLAY IN RVIZ //////////
+    BezierDisplay display;
 
-    grind_object.displayMesh(input_mesh_publisher, mesh_ressource+input_mesh_filename);
-    grind_object.displayMesh(default_mesh_publisher, mesh_ressource+default_mesh_filename);
-    grind_object.generateTrajectory(way_points_vector,points_color_viz, index_vector);
+    display.displayMesh(input_mesh_publisher, mesh_ressource+input_mesh_filename);
+    display.displayMesh(default_mesh_publisher, mesh_ressource+default_mesh_filename);
+    bool check_reachability = false;
+    node.param("check_reachability", check_reachability, check_reachability);
+    double generation_deadline = 0; //0 : no deadline
+    node.param("generation_deadline", generation_deadline, generation_deadline);
+    double smoothing_window = 0; //0 : raw normals
+    double smoothing_max_deviation = 5 * M_PI / 180;
+    node.param("smoothing_window", smoothing_window, smoothing_window);
+    node.param("smoothing_max_deviation", smoothing_max_deviation, smoothing_max_deviation);
+    double resampling_chordal_tolerance = 0.0002; //0 : lines keep every slicing point
+    double resampling_angular_tolerance = 2 * M_PI / 180;
+    node.param("resampling_chordal_tolerance", resampling_chordal_tolerance, resampling_chordal_tolerance);
+    node.param("resampling_angular_tolerance", resampling_angular_tolerance, resampling_angular_tolerance);
+    double stitch_gap = 0; //0 : only touching slice fragments are joined
+    node.param("stitch_gap", stitch_gap, stitch_gap);
+    double preview_budget = 0; //0 : no preview, full quality trajectory only
+    node.param("preview_budget", preview_budget, preview_budget);
 
-    ////////// SAVE DILATED MESH //////////
-    grind_object.saveDilatedMeshes(MESH_DIR+"dilatedMeshes");
+    ////////// PATH GENERATION SETTINGS //////////
+    BezierPreview *preview_object = NULL;
+    boost::scoped_ptr<Bezier> grind_object;
+    if (preview_budget > 0)
+    {
+        preview_object = new BezierPreview(MESH_ORIGIN_DIR,MESH_DEFAULT_DIR,grind_depth,grind_diameter,covering_percentage,extrication_coefficiant,extrication_frequency);
+        grind_object.reset(preview_object);
+    }
+    else
+        grind_object.reset(new Bezier(MESH_ORIGIN_DIR,MESH_DEFAULT_DIR,grind_depth,grind_diameter,covering_percentage,extrication_coefficiant,extrication_frequency));
+    if (check_reachability) // Fanuc M10iA model : unreachable poses are re-oriented around tool axis
+        grind_object->set_robot_model(BezierRobotModel(), M_PI);
+    grind_object->set_deadline(generation_deadline);
+    grind_object->set_normal_smoothing(smoothing_window, smoothing_max_deviation);
+    grind_object->set_stitch_gap(stitch_gap);
+    grind_object->set_resampling_tolerances(resampling_chordal_tolerance, resampling_angular_tolerance);
+    LogProgressCallback progress_callback;
+    grind_object->set_progress_callback(&progress_callback);
+
+    ////////// CHECKPOINTS : RESUME FROM CACHED TRAJECTORY //////////
+    bool resume = false; //opt-in : trajectory and checkpoints are only cached when resume is requested
+    std::string checkpoint_directory;
+    node.param("resume", resume, resume);
+    node.param("checkpoint_directory", checkpoint_directory, checkpoint_directory);
+    if (checkpoint_directory.empty()) //default : ROS home (~/.ros), never the source tree
+    {
+        const char *ros_home = getenv("ROS_HOME");
+        const char *home = getenv("HOME");
+        checkpoint_directory = ros_home ? std::string(ros_home) : std::string(home ? home : ".") + "/.ros";
+        checkpoint_directory += "/" + package;
+    }
+    if (checkpoint_directory[checkpoint_directory.size() - 1] != '/')
+        checkpoint_directory += "/";
+    std::string checkpoint_name = checkpoint_directory + input_mesh_filename.substr(0, input_mesh_filename.size() - 4);
+    std::string trajectory_file = checkpoint_name + ".trajectory";
+    std::string checkpoint_file = checkpoint_name + ".checkpoint";
+    std::string trajectory_id;
+    if (resume)
+    {
+        if (mkdir(checkpoint_directory.c_str(), 0755) != 0 && errno != EEXIST)
+            ROS_WARN("Can't create checkpoint directory %s : execution can't be resumed", checkpoint_directory.c_str());
+        // Mesh files and every setting that changes the trajectory (engine version included)
+        std::vector<std::string> trajectory_files;
+        trajectory_files.push_back(MESH_ORIGIN_DIR);
+        trajectory_files.push_back(MESH_DEFAULT_DIR);
+        trajectory_id = BezierCheckpoint::trajectoryId(trajectory_files, grind_object->get_settings());
+    }
+
+    if (resume && !trajectory_id.empty()
+            && BezierCheckpoint::loadTrajectory(trajectory_file, trajectory_id, way_points_vector, points_color_viz, index_vector, reachable_vector))
+    {
+        ROS_INFO("Cached trajectory loaded from %s : path generation skipped", trajectory_file.c_str());
+    }
+    else
+    {
+        bool generated;
+        if (preview_object)
+        {
+            ////////// PREVIEW : COARSE TRAJECTORY DISPLAYED WHILE FULL QUALITY TRAJECTORY IS REFINED //////////
+            if (preview_object->generatePreview(way_points_vector, points_color_viz, index_vector, preview_budget))
+            {
+                ROS_INFO("Preview trajectory : %lu poses, full quality path generation continues", (unsigned long)way_points_vector.size());
+                display.displayTrajectory(way_points_vector, points_color_viz, trajectory_publisher);
+            }
+            else
+                ROS_WARN("No preview trajectory within %.1f s : waiting for full quality path generation", preview_budget);
+            // Only the full quality trajectory is executed
+            while (!preview_object->waitRefinement(0.5))
+            {
+                if (!ros::ok())
+                    preview_object->cancelRefinement();
+            }
+            generated = preview_object->getRefinedTrajectory(way_points_vector, points_color_viz, index_vector);
+            if (generated)
+                display.displayTrajectory(way_points_vector, points_color_viz, trajectory_publisher); //replaces preview
+        }
+        else
+            generated = grind_object->generateTrajectory(way_points_vector,points_color_viz, index_vector);
+        if (!generated)
+        {
+            ROS_ERROR("Path generation did not complete (status %d)", (int)grind_object->get_status());
+            return -1;
+        }
+        grind_object->get_reachability(reachable_vector);
+        std::vector<double> angular_rates;
+        grind_object->get_angular_rates(angular_rates);
+        if (!angular_rates.empty())
+        {
+            // Feed rate at which the controller reaches its angular velocity limit on the sharpest line
+            double peak_rate = *std::max_element(angular_rates.begin(), angular_rates.end());
+            double angular_velocity = BezierTrajectoryLimits().angular_velocity;
+            if (peak_rate > 0)
+                ROS_INFO("Peak angular rate of grind lines : %.1f deg/m (feed rate up to %.3f m/s at %.0f deg/s)", peak_rate * 180 / M_PI,
+                         angular_velocity / peak_rate, angular_velocity * 180 / M_PI);
+        }
+
+        ////////// SAVE DILATED MESH //////////
+        grind_object->saveDilatedMeshes(MESH_DIR+"dilatedMeshes");
+
+        if (!trajectory_id.empty()
+                && !BezierCheckpoint::saveTrajectory(trajectory_file, trajectory_id, way_points_vector, points_color_viz, index_vector, reachable_vector))
+            ROS_WARN("Can't save trajectory in %s : execution can't be resumed", trajectory_file.c_str());
+    }
+    grind_object.reset(); //meshes and passes are not needed to execute the trajectory
+
+    // Passes completed before a stop are not executed again
+    BezierCheckpointState checkpoint;
+    if (resume && BezierCheckpoint::loadState(checkpoint_file, checkpoint) && checkpoint.trajectory_id == trajectory_id
+            && checkpoint.passe < (int)index_vector.size() - 1 && checkpoint.pose == index_vector[checkpoint.passe])
+    {
+        ROS_INFO("Resume at passe %d/%d (pose %d)", checkpoint.passe + 1, (int)index_vector.size() - 1, checkpoint.pose + 1);
+    }
+    else
+    {
+        checkpoint = BezierCheckpointState();
+        checkpoint.trajectory_id = trajectory_id;
+    }
 
     ////////////////// ROBOT TRAJECTORY //////////////////
     move_group_interface::MoveGroup group("manipulator");
     group.setPoseReferenceFrame("/base"); // Otherwise "base_link" is the reference!
 
+    ////////// TIME PARAMETERISATION (NO CARTESIAN PLANNER) //////////
+    bool time_parameterised = false;
+    BezierTrajectoryLimits limits;
+    node.param("time_parameterised", time_parameterised, time_parameterised);
+    node.param("grind_velocity", limits.grind_velocity, limits.grind_velocity);
+    node.param("extrication_velocity", limits.extrication_velocity, limits.extrication_velocity);
+    node.param("acceleration", limits.acceleration, limits.acceleration);
+    BezierCycleEstimate cycle;
+    if (BezierTrajectory::estimateCycleTime(way_points_vector, points_color_viz, index_vector, limits, cycle))
+        ROS_INFO("Estimated cycle time : %.1f s (grind %.3f m, air %.3f m, %d reversals)", cycle.time, cycle.grind_length,
+                 cycle.air_length, cycle.reversals);
+
     while (ros::ok())
     {
-        for(int i=0;i<index_vector.size()-1;i++){ //For each passe
-            std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > way_points_vector_passe; //get pose in this passe
-            way_points_vector_passe.insert(way_points_vector_passe.begin(), way_points_vector.begin() + index_vector[i]+1, way_points_vector.begin() + index_vector[i+1]);
-            std::vector<bool> points_color_viz_passe; //get bool data in this passe (real/extrication path in this passe)
-            points_color_viz_passe.insert(points_color_viz_passe.begin(), points_color_viz.begin() + index_vector[i]+1, points_color_viz.begin() + index_vector[i+1]);
+        for(int i=checkpoint.passe;i<(int)index_vector.size()-1;i++){ //For each passe (from checkpoint)
+            BezierPassView passe(way_points_vector, points_color_viz, index_vector, i); //poses and colors of this passe (no copy)
+
+            if (!passe.reachable(reachable_vector))
+            {
+                ROS_WARN("Passe %d has unreachable poses : skipped", i);
+                checkpoint.passe = i + 1;
+                checkpoint.pose = index_vector[i + 1];
+                if (resume)
+                    BezierCheckpoint::saveState(checkpoint_file, checkpoint);
+                continue;
+            }
 
             std::string number (boost::lexical_cast<std::string>(i));
-            grind_object.displayMesh(dilated_mesh_publisher,mesh_ressource+"dilatedMeshes/mesh_"+number+".ply");
-            grind_object.displayTrajectory(way_points_vector_passe, points_color_viz_passe, trajectory_publisher); //display trajectory in this passe
-            grind_object.displayNormal(way_points_vector_passe, points_color_viz_passe, normal_publisher); //display normal in this passe
+            display.displayMesh(dilated_mesh_publisher,mesh_ressource+"dilatedMeshes/mesh_"+number+".ply");
+            display.displayTrajectory(passe, trajectory_publisher); //display trajectory in this passe
+            display.displayNormal(passe, normal_publisher); //display normal in this passe
 
             ////////// ADD OFFSET BASE/BASE_LINK //////////
-            for (int j = 0; j < way_points_vector_passe.size(); j++)
-            {
-                way_points_vector_passe[j].translation().z() -= 0.45; //In order to face Z robot offset
-            }
+            Eigen::Affine3d offset(Eigen::Affine3d::Identity());
+            offset.translation().z() = -0.45; //In order to face Z robot offset
 
-            // Copy the vector of Eigen poses into a vector of ROS poses
-            std::vector<geometry_msgs::Pose> way_points_msg;
-            way_points_msg.resize(way_points_vector_passe.size());
+            // Convert Eigen poses of this passe into ROS poses (with offset)
+            std::vector<geometry_msgs::Pose> way_points_msg(passe.size());
             for (size_t j = 0; j < way_points_msg.size(); j++)
-                tf::poseEigenToMsg(way_points_vector_passe[j], way_points_msg[j]);
+                tf::poseEigenToMsg(offset * passe.pose(j), way_points_msg[j]);
 
             // execute this trajectory
             ROS_WARN("Start ExecuteKnownTrajectory trajectory");
@@ -130,8 +346,58 @@ int main(int argc, char **argv)
             srv.request.wait_for_execution = true;
             ros::ServiceClient executeKnownTrajectoryServiceClient = node.serviceClient<
                     moveit_msgs::ExecuteKnownTrajectory>("/execute_kinematic_path");
-            group.computeCartesianPath(way_points_msg, 0.05, 0.0, srv.request.trajectory);
-            executeKnownTrajectoryServiceClient.call(srv);
+            bool trajectory_ready = false;
+            if (time_parameterised)
+            {
+                // Timed trajectory sent to the controller : no Cartesian planning
+                try
+                {
+                    // Start from current tool pose (extrication move to the first pose of the passe)
+                    tf::StampedTransform tool_transform;
+                    listener.waitForTransform("/base", "/tool0", ros::Time(0), ros::Duration(3.0));
+                    listener.lookupTransform("/base", "/tool0", ros::Time(0), tool_transform);
+                    Eigen::Affine3d tool_pose;
+                    tf::transformTFToEigen(tool_transform, tool_pose);
+                    std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > timed_poses;
+                    std::vector<bool> timed_colors;
+                    timed_poses.reserve(passe.size() + 1);
+                    timed_colors.reserve(passe.size() + 1);
+                    timed_poses.push_back(tool_pose);
+                    timed_colors.push_back(false);
+                    for (size_t j = 0; j < passe.size(); j++)
+                    {
+                        timed_poses.push_back(offset * passe.pose(j));
+                        timed_colors.push_back(passe.color(j));
+                    }
+
+                    BezierTrajectory::Points timed_passe;
+                    robot_state::RobotStatePtr state = group.getCurrentState();
+                    tf::StampedTransform frame_transform; // "/base" poses are solved in robot model frame
+                    listener.lookupTransform(state->getRobotModel()->getModelFrame(), "/base", ros::Time(0), frame_transform);
+                    Eigen::Affine3d frame;
+                    tf::transformTFToEigen(frame_transform, frame);
+                    trajectory_ready = BezierTrajectory::timeParameterise(timed_poses, timed_colors, limits, timed_passe)
+                            && timedTrajectoryToJointTrajectory(timed_passe, frame, *state, state->getJointModelGroup("manipulator"), srv.request.trajectory);
+                }
+                catch (tf::TransformException &ex)
+                {
+                    ROS_ERROR("%s", ex.what());
+                }
+                if (!trajectory_ready)
+                    ROS_WARN("Time parameterisation failed : use Cartesian planner for this passe");
+            }
+            if (!trajectory_ready)
+                group.computeCartesianPath(way_points_msg, 0.05, 0.0, srv.request.trajectory);
+            if (!executeKnownTrajectoryServiceClient.call(srv) || srv.response.error_code.val != moveit_msgs::MoveItErrorCodes::SUCCESS)
+            {
+                ROS_ERROR("Passe %d execution failed (error code %d) : restart to resume at this passe", i, srv.response.error_code.val);
+                return -1;
+            }
+            // Passe segment completed : checkpoint saved before moving on
+            checkpoint.passe = i + 1;
+            checkpoint.pose = index_vector[i + 1];
+            if (resume && !BezierCheckpoint::saveState(checkpoint_file, checkpoint))
+                ROS_WARN("Can't save checkpoint in %s", checkpoint_file.c_str());
 
             way_points_msg.resize(1);
             listener.waitForTransform("/base", "/tool0", ros::Time::now(), ros::Duration(3.0));
@@ -140,6 +406,11 @@ int main(int argc, char **argv)
             executeKnownTrajectoryServiceClient.call(srv);
             sleep(1);
         }
+        // Cycle completed : next cycle starts from first passe
+        checkpoint.passe = 0;
+        checkpoint.pose = -1;
+        if (resume)
+            BezierCheckpoint::saveState(checkpoint_file, checkpoint);
     }
     return 0;
   }
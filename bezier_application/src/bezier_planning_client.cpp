@@ -0,0 +1,109 @@
+#include <bezier_application/PlanPathAction.h>
+//C++ common
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// ROS headers
+#include <ros/ros.h>
+#include <ros/package.h>
+#include <actionlib/client/simple_action_client.h>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+
+/**
+ * @file bezier_planning_client.cpp
+ * @brief Local client of bezier_planning_server : sends goals, prints feedback, results and timing stats.
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+typedef actionlib::SimpleActionClient<bezier_application::PlanPathAction> PlanPathClient;
+
+/** @brief Print feedback of a goal (once per second)
+ * @param[in] index_goal index of goal
+ * @param[in] feedback feedback of goal */
+void feedbackCallback(int index_goal, const bezier_application::PlanPathFeedbackConstPtr &feedback)
+{
+    ROS_INFO_THROTTLE(1.0, "Goal %d : stage %d, passe %d/%d, %.0f %% (%.0f s remaining)", index_goal, (int)feedback->stage,
+                      feedback->passe + 1, feedback->number_of_passes, feedback->fraction * 100, feedback->remaining_time);
+}
+
+/** @brief The main function
+ * Private parameters : input_mesh and default_mesh (filenames in meshes directory), grind_depth, effector_diameter, covering,
+ * extrication_coefficiant, extrication_frequency, deadline, goals (number of goals sent at once) and
+ * cancel_after (cancel goals after this duration in seconds, 0 : never).
+ * @param[in] argc
+ * @param[in] argv
+ * @return Exit status (0 if all goals succeeded) */
+int main(int argc, char **argv)
+{
+    ros::init(argc, argv, "bezier_planning_client");
+    ros::NodeHandle private_node("~");
+    ros::AsyncSpinner spinner(1);
+    spinner.start();
+
+    ////////// GOAL FROM PARAMETERS //////////
+    std::string mesh_directory = ros::package::getPath("bezier_application") + "/meshes/";
+    std::string input_mesh, default_mesh;
+    private_node.param("input_mesh", input_mesh, std::string("complicated_square.ply"));
+    default_mesh = input_mesh.substr(0, input_mesh.size() - 4) + "_default.ply";
+    private_node.param("default_mesh", default_mesh, default_mesh);
+    bezier_application::PlanPathGoal goal;
+    goal.input_mesh = input_mesh[0] == '/' ? input_mesh : mesh_directory + input_mesh;
+    goal.default_mesh = default_mesh[0] == '/' ? default_mesh : mesh_directory + default_mesh;
+    private_node.param("grind_depth", goal.grind_depth, 0.05);
+    private_node.param("effector_diameter", goal.effector_diameter, 0.1);
+    private_node.param("covering", goal.covering, 0.5);
+    private_node.param("extrication_coefficiant", goal.extrication_coefficiant, 1);
+    private_node.param("extrication_frequency", goal.extrication_frequency, 5);
+    private_node.param("deadline", goal.deadline, 0.0);
+    int number_of_goals;
+    double cancel_after;
+    private_node.param("goals", number_of_goals, 1);
+    private_node.param("cancel_after", cancel_after, 0.0);
+
+    ////////// SEND GOALS //////////
+    std::vector<boost::shared_ptr<PlanPathClient> > clients(std::max(number_of_goals, 0));
+    for (size_t i = 0; i < clients.size(); i++)
+    {
+        clients[i].reset(new PlanPathClient("plan_path", false));
+        if (!clients[i]->waitForServer(ros::Duration(10.0)))
+        {
+            ROS_ERROR("Planning server is not available");
+            return -1;
+        }
+        clients[i]->sendGoal(goal, PlanPathClient::SimpleDoneCallback(), PlanPathClient::SimpleActiveCallback(),
+                             boost::bind(&feedbackCallback, (int)i, _1));
+    }
+    ROS_INFO("%lu goals sent : %s", (unsigned long)clients.size(), goal.input_mesh.c_str());
+
+    ////////// WAIT FOR RESULTS //////////
+    int failures = 0;
+    ros::WallTime start = ros::WallTime::now();
+    for (size_t i = 0; i < clients.size(); i++)
+    {
+        if (cancel_after > 0)
+        {
+            double remaining = cancel_after - (ros::WallTime::now() - start).toSec();
+            if (remaining <= 0 || !clients[i]->waitForResult(ros::Duration(remaining)))
+                clients[i]->cancelGoal();
+        }
+        clients[i]->waitForResult();
+        actionlib::SimpleClientGoalState state = clients[i]->getState();
+        bezier_application::PlanPathResultConstPtr result = clients[i]->getResult();
+        if (state != actionlib::SimpleClientGoalState::SUCCEEDED)
+            failures++;
+        if (!result)
+        {
+            ROS_INFO("Goal %lu : %s", (unsigned long)i, state.toString().c_str());
+            continue;
+        }
+        ROS_INFO("Goal %lu : %s (status %d), %lu poses, %lu passes, %s part | queue %.2f s, load %.2f s, planning %.2f s",
+                 (unsigned long)i, state.toString().c_str(), (int)result->status, (unsigned long)result->poses.poses.size(),
+                 (unsigned long)(result->passe_indices.empty() ? 0 : result->passe_indices.size() - 1), result->warm ? "warm" : "cold",
+                 result->queue_time, result->load_time, result->planning_time);
+    }
+    ROS_INFO("%lu goals done in %.2f s, %d not succeeded", (unsigned long)clients.size(), (ros::WallTime::now() - start).toSec(), failures);
+    return failures == 0 ? 0 : -1;
+}
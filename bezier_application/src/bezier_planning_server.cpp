@@ -0,0 +1,387 @@
+#include "bezier_library/bezier_library.hpp"
+#include "bezier_library/bezier_trajectory.hpp"
+#include <bezier_application/PlanPathAction.h>
+//C++ common
+#include <list>
+#include <map>
+#include <string>
+#include <sys/stat.h>
+
+// ROS headers
+#include <ros/ros.h>
+#include <actionlib/server/action_server.h>
+#include <eigen_conversions/eigen_msg.h>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+/**
+ * @file bezier_planning_server.cpp
+ * @brief Long-running planning node : grinding paths are planned as actions by a pool of workers.
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+typedef actionlib::ActionServer<bezier_application::PlanPathAction> PlanPathServer;
+typedef PlanPathServer::GoalHandle GoalHandle;
+
+/** @brief Send progress of path generation as action feedback */
+class FeedbackProgressCallback : public BezierProgressCallback
+{
+  public:
+    explicit FeedbackProgressCallback(GoalHandle goal_handle) : goal_handle_(goal_handle) {}
+
+    void progress(const BezierProgress &progress)
+    {
+        bezier_application::PlanPathFeedback feedback;
+        feedback.stage = progress.stage;
+        feedback.passe = progress.passe;
+        feedback.number_of_passes = progress.number_of_passes;
+        feedback.fraction = progress.fraction;
+        feedback.remaining_time = progress.remaining_time;
+        this->goal_handle_.publishFeedback(feedback);
+    }
+
+  private:
+    GoalHandle goal_handle_;
+};
+
+/** @brief BezierPlanningServer plans grinding paths (PlanPath action) with a pool of worker threads.
+ *
+ * Accepted goals wait in a FIFO queue until a worker is free. Cancelling a queued goal removes it from the queue,
+ * cancelling a running goal stops its path generation at the next check (see BezierCancellationToken).
+ * Loaded parts (meshes, normals, plane model and passes of the last grind depth) are kept in a LRU cache :
+ * the next goal on the same part skips loading and preparation. A cached part is used by one worker at a time.
+ */
+class BezierPlanningServer
+{
+  public:
+    /**@brief Constructor : starts action server and workers
+     * @param[in] node node handle of the action server
+     * @param[in] name action name
+     * @param[in] number_of_workers number of goals planned concurrently
+     * @param[in] cache_size maximal number of idle parts kept in cache
+     * @param[in] frame_id frame of result poses
+     */
+    BezierPlanningServer(ros::NodeHandle &node, const std::string &name, int number_of_workers, int cache_size, const std::string &frame_id) :
+            server_(node, name, boost::bind(&BezierPlanningServer::goalCallback, this, _1),
+                    boost::bind(&BezierPlanningServer::cancelCallback, this, _1), false),
+            cache_size_(cache_size), frame_id_(frame_id), stop_(false), succeeded_jobs_(0), failed_jobs_(0), warm_jobs_(0)
+    {
+        for (int i = 0; i < number_of_workers; i++)
+            this->workers_.create_thread(boost::bind(&BezierPlanningServer::workLoop, this));
+        this->server_.start();
+        ROS_INFO("Planning server : action %s, %d workers, cache of %d parts", name.c_str(), number_of_workers, cache_size);
+    }
+
+    ///@brief Destructor : queued goals are aborted, running goals are cancelled, then workers stop
+    ~BezierPlanningServer()
+    {
+        {
+            boost::mutex::scoped_lock lock(this->mutex_);
+            this->stop_ = true;
+            for (std::list<Job>::iterator it = this->queue_.begin(); it != this->queue_.end(); ++it)
+                it->goal_handle.setAborted(bezier_application::PlanPathResult(), "Planning server is shutting down");
+            this->queue_.clear();
+            for (std::map<std::string, boost::shared_ptr<BezierCancellationToken> >::iterator it = this->running_.begin();
+                    it != this->running_.end(); ++it)
+                it->second->cancel();
+        }
+        this->condition_.notify_all();
+        this->workers_.join_all();
+    }
+
+  private:
+    // Non copyable
+    BezierPlanningServer(const BezierPlanningServer &);
+    BezierPlanningServer &operator=(const BezierPlanningServer &);
+
+    /** @brief Accepted goal waiting for a worker */
+    struct Job
+    {
+        /** @brief goal handle */
+        GoalHandle goal_handle;
+        /** @brief cancellation token of the goal */
+        boost::shared_ptr<BezierCancellationToken> token;
+        /** @brief time the goal was accepted */
+        ros::WallTime queued_time;
+    };
+
+    /** @brief Idle part in cache */
+    struct CachedPart
+    {
+        /** @brief mesh filenames and modification times */
+        std::string key;
+        /** @brief loaded part */
+        boost::shared_ptr<Bezier> bezier;
+    };
+
+    /**@brief Get cache key of a part : filenames and modification times (a modified mesh is loaded again)
+     * @param[in] goal goal
+     * @param[out] key cache key
+     * @return false if a mesh file does not exist
+     */
+    static bool partKey(const bezier_application::PlanPathGoal &goal, std::string &key)
+    {
+        struct stat input_stat, default_stat;
+        if (stat(goal.input_mesh.c_str(), &input_stat) != 0 || stat(goal.default_mesh.c_str(), &default_stat) != 0)
+            return false;
+        key = goal.input_mesh + "@" + boost::lexical_cast<std::string>(input_stat.st_mtime) + "|" + goal.default_mesh + "@"
+                + boost::lexical_cast<std::string>(default_stat.st_mtime);
+        return true;
+    }
+
+    /**@brief Action server goal callback : check goal and queue it
+     * @param[in] goal_handle new goal
+     */
+    void goalCallback(GoalHandle goal_handle)
+    {
+        const bezier_application::PlanPathGoalConstPtr goal_ptr = goal_handle.getGoal();
+        const bezier_application::PlanPathGoal &goal = *goal_ptr;
+        std::string key;
+        if (!partKey(goal, key))
+        {
+            goal_handle.setRejected(bezier_application::PlanPathResult(), "Can't find mesh files");
+            return;
+        }
+        if (goal.grind_depth <= 0 || goal.effector_diameter <= 0 || goal.covering <= 0 || goal.covering > 1
+                || goal.extrication_coefficiant < 1 || goal.extrication_frequency < 1 || goal.deadline < 0)
+        {
+            goal_handle.setRejected(bezier_application::PlanPathResult(), "Invalid grinding parameters");
+            return;
+        }
+        Job job;
+        job.goal_handle = goal_handle;
+        job.token.reset(new BezierCancellationToken());
+        job.queued_time = ros::WallTime::now();
+        {
+            boost::mutex::scoped_lock lock(this->mutex_);
+            if (this->stop_)
+            {
+                goal_handle.setRejected(bezier_application::PlanPathResult(), "Planning server is shutting down");
+                return;
+            }
+            goal_handle.setAccepted();
+            this->queue_.push_back(job);
+            ROS_INFO("Goal %s queued (%lu waiting)", goal_handle.getGoalID().id.c_str(), (unsigned long)this->queue_.size());
+        }
+        this->condition_.notify_one();
+    }
+
+    /**@brief Action server cancel callback : remove queued goal or stop its path generation
+     * @param[in] goal_handle cancelled goal
+     */
+    void cancelCallback(GoalHandle goal_handle)
+    {
+        const std::string id = goal_handle.getGoalID().id;
+        boost::mutex::scoped_lock lock(this->mutex_);
+        for (std::list<Job>::iterator it = this->queue_.begin(); it != this->queue_.end(); ++it)
+        {
+            if (it->goal_handle == goal_handle)
+            {
+                it->goal_handle.setCanceled(bezier_application::PlanPathResult(), "Cancelled before planning");
+                this->queue_.erase(it);
+                ROS_INFO("Goal %s cancelled in queue", id.c_str());
+                return;
+            }
+        }
+        std::map<std::string, boost::shared_ptr<BezierCancellationToken> >::iterator running = this->running_.find(id);
+        if (running != this->running_.end())
+            running->second->cancel();
+    }
+
+    ///@brief Worker thread loop : plan queued goals until server stops
+    void workLoop()
+    {
+        while (true)
+        {
+            Job job;
+            {
+                boost::mutex::scoped_lock lock(this->mutex_);
+                while (this->queue_.empty() && !this->stop_)
+                    this->condition_.wait(lock);
+                if (this->stop_)
+                    break;
+                job = this->queue_.front();
+                this->queue_.pop_front();
+                this->running_[job.goal_handle.getGoalID().id] = job.token;
+            }
+            plan(job);
+            boost::mutex::scoped_lock lock(this->mutex_);
+            this->running_.erase(job.goal_handle.getGoalID().id);
+        }
+    }
+
+    /**@brief Plan a goal and send its result
+     * @param[in] job goal to plan
+     */
+    void plan(Job &job)
+    {
+        const bezier_application::PlanPathGoalConstPtr goal_ptr = job.goal_handle.getGoal();
+        const bezier_application::PlanPathGoal &goal = *goal_ptr;
+        const std::string id = job.goal_handle.getGoalID().id;
+        bezier_application::PlanPathResult result;
+        result.queue_time = (ros::WallTime::now() - job.queued_time).toSec();
+
+        //////////// GET PART FROM CACHE OR LOAD IT ////////////
+        std::string key;
+        if (!partKey(goal, key))
+        {
+            job.goal_handle.setAborted(result, "Can't find mesh files");
+            return;
+        }
+        ros::WallTime start = ros::WallTime::now();
+        boost::shared_ptr<Bezier> bezier = acquire(key);
+        result.warm = (bool)bezier;
+        if (bezier)
+            bezier->set_parameters(goal.grind_depth, goal.effector_diameter, goal.covering, goal.extrication_coefficiant,
+                                   goal.extrication_frequency);
+        else
+        {
+            bezier.reset(new Bezier(goal.input_mesh, goal.default_mesh, goal.grind_depth, goal.effector_diameter, goal.covering,
+                                    goal.extrication_coefficiant, goal.extrication_frequency));
+            result.load_time = (ros::WallTime::now() - start).toSec();
+        }
+
+        //////////// GENERATE PATH ////////////
+        start = ros::WallTime::now();
+        FeedbackProgressCallback callback(job.goal_handle);
+        bezier->set_progress_callback(&callback);
+        bezier->set_cancellation_token(job.token.get());
+        bezier->set_deadline(goal.deadline);
+        std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > way_points_vector;
+        std::vector<bool> color_vector;
+        std::vector<int> index_vector;
+        bool success = bezier->generateTrajectory(way_points_vector, color_vector, index_vector);
+        result.planning_time = (ros::WallTime::now() - start).toSec();
+        result.status = bezier->get_status();
+        bezier->set_progress_callback(NULL);
+        bezier->set_cancellation_token(NULL);
+        release(key, bezier);
+
+        //////////// SEND RESULT ////////////
+        result.poses.header.stamp = ros::Time::now();
+        result.poses.header.frame_id = this->frame_id_;
+        result.poses.poses.resize(way_points_vector.size());
+        for (size_t i = 0; i < way_points_vector.size(); i++)
+            tf::poseEigenToMsg(way_points_vector[i], result.poses.poses[i]);
+        result.grinding.assign(color_vector.begin(), color_vector.end()); //bool[] fields are vectors of uint8
+        result.passe_indices = index_vector;
+        BezierCycleEstimate cycle;
+        if (success && BezierTrajectory::estimateCycleTime(way_points_vector, color_vector, index_vector, BezierTrajectoryLimits(), cycle))
+        {
+            result.grind_length = cycle.grind_length;
+            result.air_length = cycle.air_length;
+            result.reversals = cycle.reversals;
+            result.cycle_time = cycle.time;
+        }
+        {
+            boost::mutex::scoped_lock lock(this->mutex_);
+            if (success)
+                this->succeeded_jobs_++;
+            else
+                this->failed_jobs_++;
+            if (result.warm)
+                this->warm_jobs_++;
+            ROS_INFO("Goal %s : status %d, %lu poses (queue %.2f s, load %.2f s, planning %.2f s) | %d succeeded, %d failed, %d warm",
+                     id.c_str(), (int)result.status, (unsigned long)way_points_vector.size(), result.queue_time, result.load_time,
+                     result.planning_time, this->succeeded_jobs_, this->failed_jobs_, this->warm_jobs_);
+        }
+        if (success)
+            job.goal_handle.setSucceeded(result);
+        else if (result.status == BEZIER_CANCELLED)
+            job.goal_handle.setCanceled(result, "Path generation cancelled");
+        else if (result.status == BEZIER_DEADLINE_EXCEEDED)
+            job.goal_handle.setAborted(result, "Path generation deadline exceeded");
+        else
+            job.goal_handle.setAborted(result, "Path generation failed");
+    }
+
+    /**@brief Take an idle part out of cache
+     * @param[in] key cache key of part
+     * @return part, empty pointer if part is not in cache
+     */
+    boost::shared_ptr<Bezier> acquire(const std::string &key)
+    {
+        boost::mutex::scoped_lock lock(this->mutex_);
+        for (std::list<CachedPart>::iterator it = this->cache_.begin(); it != this->cache_.end(); ++it)
+        {
+            if (it->key == key)
+            {
+                boost::shared_ptr<Bezier> bezier = it->bezier;
+                this->cache_.erase(it);
+                return bezier;
+            }
+        }
+        return boost::shared_ptr<Bezier>();
+    }
+
+    /**@brief Put a part back in cache (least recently used parts are dropped)
+     * @param[in] key cache key of part
+     * @param[in] bezier part
+     */
+    void release(const std::string &key, const boost::shared_ptr<Bezier> &bezier)
+    {
+        boost::shared_ptr<Bezier> dropped;
+        boost::mutex::scoped_lock lock(this->mutex_);
+        CachedPart part;
+        part.key = key;
+        part.bezier = bezier;
+        this->cache_.push_front(part);
+        while ((int)this->cache_.size() > this->cache_size_)
+        {
+            dropped = this->cache_.back().bezier; // destroyed after lock is released
+            this->cache_.pop_back();
+        }
+    }
+
+    /** @brief action server */
+    PlanPathServer server_;
+    /** @brief maximal number of idle parts in cache */
+    int cache_size_;
+    /** @brief frame of result poses */
+    std::string frame_id_;
+    /** @brief goals waiting for a worker */
+    std::list<Job> queue_;
+    /** @brief cancellation tokens of running goals (by goal id) */
+    std::map<std::string, boost::shared_ptr<BezierCancellationToken> > running_;
+    /** @brief idle parts, most recently used first */
+    std::list<CachedPart> cache_;
+    /** @brief true when workers must stop */
+    bool stop_;
+    /** @brief statistics : number of succeeded, failed and warm (cached part) goals */
+    int succeeded_jobs_, failed_jobs_, warm_jobs_;
+    /** @brief mutex protecting queue_, running_, cache_, stop_ and statistics */
+    boost::mutex mutex_;
+    /** @brief condition used to wake workers */
+    boost::condition_variable condition_;
+    /** @brief worker threads */
+    boost::thread_group workers_;
+};
+
+/** @brief The main function
+ * @param[in] argc
+ * @param[in] argv
+ * @return Exit status */
+int main(int argc, char **argv)
+{
+    ros::init(argc, argv, "bezier_planning_server");
+    ros::NodeHandle node;
+    ros::NodeHandle private_node("~");
+    int number_of_workers, cache_size;
+    std::string frame_id;
+    private_node.param("workers", number_of_workers, 2); // each path generation also uses OpenMP threads
+    private_node.param("cache_size", cache_size, 4);
+    private_node.param("frame_id", frame_id, std::string("/base"));
+    if (number_of_workers < 1)
+    {
+        ROS_ERROR("Planning server needs at least one worker");
+        return -1;
+    }
+    BezierPlanningServer server(node, "plan_path", number_of_workers, cache_size, frame_id);
+    ros::spin();
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include "bezier_library/bezier_library.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+/**
+ * @file allocation_benchmark.cpp
+ * @brief Count heap allocations (number and bytes) of Bezier::generateTrajectory.
+ * Usage : allocation_benchmark input_mesh.ply default_mesh.ply [repetitions]
+ * @note Global operator new and delete are replaced : every allocation of the process is counted
+ * (library, VTK, PCL, standard containers), from all threads.
+ */
+
+// Exception specifications of replaced operators (dynamic specifications are removed in C++17)
+#if __cplusplus >= 201103L
+#define BENCHMARK_THROW_BAD_ALLOC
+#define BENCHMARK_NO_THROW noexcept
+#else
+#define BENCHMARK_THROW_BAD_ALLOC throw (std::bad_alloc)
+#define BENCHMARK_NO_THROW throw ()
+#endif
+
+///@brief Allocation counters (updated with atomic builtins : OpenMP threads allocate too)
+static long allocation_count = 0;
+static long allocation_bytes = 0;
+
+static void *countedAllocation(size_t size)
+{
+    __sync_fetch_and_add(&allocation_count, 1);
+    __sync_fetch_and_add(&allocation_bytes, (long)size);
+    void *pointer = std::malloc(size ? size : 1);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void *operator new(size_t size) BENCHMARK_THROW_BAD_ALLOC
+{
+    return countedAllocation(size);
+}
+
+void *operator new[](size_t size) BENCHMARK_THROW_BAD_ALLOC
+{
+    return countedAllocation(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) BENCHMARK_NO_THROW
+{
+    try
+    {
+        return countedAllocation(size);
+    }
+    catch (std::bad_alloc &)
+    {
+        return NULL;
+    }
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) BENCHMARK_NO_THROW
+{
+    try
+    {
+        return countedAllocation(size);
+    }
+    catch (std::bad_alloc &)
+    {
+        return NULL;
+    }
+}
+
+void operator delete(void *pointer) BENCHMARK_NO_THROW
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) BENCHMARK_NO_THROW
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) BENCHMARK_NO_THROW
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) BENCHMARK_NO_THROW
+{
+    std::free(pointer);
+}
+
+///@brief Allocations counted between start and stop
+struct AllocationCounter
+{
+    long count;
+    long bytes;
+
+    void start()
+    {
+        count = __sync_fetch_and_add(&allocation_count, 0);
+        bytes = __sync_fetch_and_add(&allocation_bytes, 0);
+    }
+
+    void stop()
+    {
+        count = __sync_fetch_and_add(&allocation_count, 0) - count;
+        bytes = __sync_fetch_and_add(&allocation_bytes, 0) - bytes;
+    }
+};
+
+/**@brief Print allocations of a step
+ * @param[in] step step name
+ * @param[in] counter allocations of the step (total over repetitions)
+ * @param[in] repetitions number of repetitions of the step
+ * @param[in] number_of_poses number of generated poses
+ */
+static void printAllocations(const char *step, const AllocationCounter &counter, int repetitions, size_t number_of_poses)
+{
+    double count = (double)counter.count / repetitions;
+    double bytes = (double)counter.bytes / repetitions;
+    printf("%-40s %12.0f %14.0f %12.2f %14.1f\n", step, count, bytes, number_of_poses ? count / number_of_poses : 0.0,
+           number_of_poses ? bytes / number_of_poses : 0.0);
+}
+
+/** @brief The main function
+ * @param[in] argc
+ * @param[in] argv
+ * @return Exit status */
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        printf("Usage : %s input_mesh.ply default_mesh.ply [repetitions]\n", argv[0]);
+        return -1;
+    }
+    const int repetitions = argc > 3 ? std::max(1, atoi(argv[3])) : 5;
+    std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > way_points_vector;
+    std::vector<bool> color_vector;
+    std::vector<int> index_vector;
+    AllocationCounter counter;
+
+    // Same parameters as bezier_application
+    counter.start();
+    Bezier bezier(argv[1], argv[2], 0.05, 0.1, 0.5, 1, 5);
+    counter.stop();
+    printf("%-40s %12s %14s %12s %14s\n", "step", "allocations", "bytes", "alloc/pose", "bytes/pose");
+    printAllocations("constructor (meshes loading)", counter, 1, 0);
+
+    // First call : normals, plane model, distance field and passes are generated
+    counter.start();
+    if (!bezier.generateTrajectory(way_points_vector, color_vector, index_vector))
+    {
+        printf("Path generation failed\n");
+        return -1;
+    }
+    counter.stop();
+    const size_t number_of_poses = way_points_vector.size();
+    printAllocations("first call (passes generated)", counter, 1, number_of_poses);
+
+    // Next calls : passes are shared, output vectors are reused (capacity kept)
+    counter.start();
+    for (int r = 0; r < repetitions; r++)
+        bezier.generateTrajectory(way_points_vector, color_vector, index_vector);
+    counter.stop();
+    printAllocations("next calls (output vectors reused)", counter, repetitions, number_of_poses);
+
+    // Next calls : passes are shared, new output vectors
+    counter.start();
+    for (int r = 0; r < repetitions; r++)
+    {
+        std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > poses;
+        std::vector<bool> colors;
+        std::vector<int> indices;
+        bezier.generateTrajectory(poses, colors, indices);
+    }
+    counter.stop();
+    printAllocations("next calls (new output vectors)", counter, repetitions, number_of_poses);
+    printf("%lu poses, %lu passes\n", (unsigned long)number_of_poses, (unsigned long)(index_vector.size() - 1));
+    return 0;
+}
@@ -0,0 +1,263 @@
+#include "bezier_library/bezier_iso_surface.hpp"
+#include "bezier_library/bezier_mesh_view.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+// PCL headers
+#include <pcl/common/time.h>
+
+// VTK headers
+#include <vtkCellLocator.h>
+#include <vtkImplicitModeller.h>
+#include <vtkKdTreePointLocator.h>
+#include <vtkMarchingCubes.h>
+#include <vtkMath.h>
+#include <vtkPLYReader.h>
+
+/**
+ * @file iso_surface_benchmark.cpp
+ * @brief Compare vtkMarchingCubes and BezierIsoSurface (speed and output) on the distance fields of PLY meshes.
+ * Usage : iso_surface_benchmark mesh_1.ply [mesh_2.ply ...]
+ * Fields are sampled as in path generation (bezier_application parameters : 0.05 m grind depth) and iso-surfaces
+ * are extracted at each pass depth, as dilation does.
+ * Dilations of the shared field (BezierResolution::shared_field : one field deep enough for every pass) are compared with
+ * per-depth dilations (one 50x50x50 field per pass, the default) : the symmetric surface deviation must not exceed
+ * one sample spacing of the per-depth field.
+ * BezierIsoSurface vertices (opt-in, see BezierResolution::block_iso_surface) are compared with vtkMarchingCubes vertices
+ * (the default) on the same field : both interpolate the same cut edges, so every vertex of one surface must have a vertex
+ * of the other within a thousandth of the field sample spacing (float rounding). Triangles only differ in ambiguous cells (case tables differ) : triangle counts and areas are reported.
+ * Exit status is 0 only if every surface is within tolerance.
+ */
+
+///@brief Number of repetitions of each extraction (timings are averaged)
+static const int REPETITIONS = 10;
+///@brief Grind depth (in meters) : iso values are multiples of grind depth
+static const double GRIND_DEPTH = 0.05;
+///@brief Number of passes : field depth and number of iso values
+static const int PASSES = 5;
+
+/**@brief Area of a triangle mesh
+ * @param[in] mesh triangle mesh
+ * @return sum of triangle areas
+ */
+static double meshArea(vtkSmartPointer<vtkPolyData> mesh)
+{
+    BezierMeshView view(mesh);
+    double area = 0;
+    for (vtkIdType index_triangle = 0; index_triangle < view.numberOfTriangles(); index_triangle++)
+    {
+        const vtkIdType *ids = view.triangle(index_triangle);
+        const float *a = view.point(ids[0]), *b = view.point(ids[1]), *c = view.point(ids[2]);
+        double u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        double v[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+        double n[3] = {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+        area += 0.5 * std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    }
+    return area;
+}
+
+/**@brief Maximal distance from the points of a mesh to the closest point of another mesh
+ * @param[in] from mesh whose points are measured
+ * @param[in] to mesh whose points are the reference
+ * @return maximal distance (0 if a mesh has no point)
+ */
+static double maximalVertexDeviation(vtkSmartPointer<vtkPolyData> from, vtkSmartPointer<vtkPolyData> to)
+{
+    if (from->GetNumberOfPoints() == 0 || to->GetNumberOfPoints() == 0)
+        return 0;
+    vtkSmartPointer<vtkKdTreePointLocator> locator = vtkSmartPointer<vtkKdTreePointLocator>::New();
+    locator->SetDataSet(to);
+    locator->BuildLocator();
+    double max_distance2 = 0;
+    for (vtkIdType index_point = 0; index_point < from->GetNumberOfPoints(); index_point++)
+    {
+        double point[3], closest[3];
+        from->GetPoint(index_point, point);
+        to->GetPoint(locator->FindClosestPoint(point), closest);
+        max_distance2 = std::max(max_distance2, vtkMath::Distance2BetweenPoints(point, closest));
+    }
+    return std::sqrt(max_distance2);
+}
+
+/**@brief Maximal distance from the points of a mesh to the surface of another mesh
+ * @param[in] from mesh whose points are measured
+ * @param[in] to mesh whose triangles are the reference surface
+ * @return maximal distance (0 if a mesh is empty)
+ */
+static double maximalDeviation(vtkSmartPointer<vtkPolyData> from, vtkSmartPointer<vtkPolyData> to)
+{
+    if (from->GetNumberOfPoints() == 0 || to->GetNumberOfCells() == 0)
+        return 0;
+    vtkSmartPointer<vtkCellLocator> locator = vtkSmartPointer<vtkCellLocator>::New();
+    locator->SetDataSet(to);
+    locator->BuildLocator();
+    double max_distance2 = 0;
+    for (vtkIdType index_point = 0; index_point < from->GetNumberOfPoints(); index_point++)
+    {
+        double point[3], closest[3], distance2;
+        vtkIdType cell_id;
+        int sub_id;
+        from->GetPoint(index_point, point);
+        locator->FindClosestPoint(point, closest, cell_id, sub_id, distance2);
+        max_distance2 = std::max(max_distance2, distance2);
+    }
+    return std::sqrt(max_distance2);
+}
+
+/**@brief Dilation computed for one depth only (field of 50x50x50 samples fitted to the depth), as BezierImpl::depthField
+ * @param[in] mesh input mesh
+ * @param[in] depth dilation depth
+ * @param[out] spacing largest sample spacing of the field
+ * @return iso-surface at depth
+ */
+static vtkSmartPointer<vtkPolyData> perDepthDilation(vtkSmartPointer<vtkPolyData> mesh, double depth, double &spacing)
+{
+    double bounds[6];
+    mesh->GetBounds(bounds);
+    double max_side_length = std::max(bounds[1] - bounds[0], std::max(bounds[3] - bounds[2], bounds[5] - bounds[4]));
+    double threshold = depth / max_side_length;
+    vtkSmartPointer<vtkImplicitModeller> implicitModeller = vtkSmartPointer<vtkImplicitModeller>::New();
+    implicitModeller->SetProcessModeToPerVoxel();
+    implicitModeller->SetSampleDimensions(50, 50, 50);
+    implicitModeller->SetInputData(mesh);
+    implicitModeller->AdjustBoundsOn();
+    implicitModeller->SetAdjustDistance(threshold);
+    implicitModeller->SetMaximumDistance(std::min(1.0, 2 * threshold));
+    implicitModeller->ComputeModelBounds(mesh);
+    implicitModeller->Update();
+    double field_spacing[3];
+    implicitModeller->GetOutput()->GetSpacing(field_spacing);
+    spacing = std::max(field_spacing[0], std::max(field_spacing[1], field_spacing[2]));
+
+    vtkSmartPointer<vtkMarchingCubes> marching_cubes = vtkSmartPointer<vtkMarchingCubes>::New();
+    marching_cubes->SetInputConnection(implicitModeller->GetOutputPort());
+    marching_cubes->ComputeNormalsOff();
+    marching_cubes->ComputeScalarsOff();
+    marching_cubes->SetValue(0, depth);
+    marching_cubes->Update();
+    return marching_cubes->GetOutput();
+}
+
+/**@brief Shared distance field of a mesh, sampled as in path generation (see BezierImpl::fieldSampling)
+ * @param[in] mesh input mesh
+ * @param[in] depth maximal depth of iso-surfaces
+ * @return distance field
+ */
+static vtkSmartPointer<vtkImageData> distanceField(vtkSmartPointer<vtkPolyData> mesh, double depth)
+{
+    double bounds[6], model_bounds[6];
+    int dimensions[3];
+    mesh->GetBounds(bounds);
+    double max_side_length = 0, max_model_side_length = 0;
+    for (int k = 0; k < 3; k++)
+    {
+        double side = bounds[2 * k + 1] - bounds[2 * k];
+        double spacing = (side + 2 * GRIND_DEPTH) / 49;
+        dimensions[k] = std::min(100, (int)std::ceil((side + 2 * depth) / spacing) + 1);
+        model_bounds[2 * k] = bounds[2 * k] - depth;
+        model_bounds[2 * k + 1] = bounds[2 * k + 1] + depth;
+        max_side_length = std::max(max_side_length, side);
+        max_model_side_length = std::max(max_model_side_length, model_bounds[2 * k + 1] - model_bounds[2 * k]);
+    }
+    vtkSmartPointer<vtkImplicitModeller> implicitModeller = vtkSmartPointer<vtkImplicitModeller>::New();
+    implicitModeller->SetProcessModeToPerVoxel();
+    implicitModeller->SetSampleDimensions(dimensions);
+    implicitModeller->SetInputData(mesh);
+    implicitModeller->AdjustBoundsOff();
+    implicitModeller->SetModelBounds(model_bounds);
+    implicitModeller->SetMaximumDistance(std::min(1.0, std::min(max_side_length, 2 * depth) / max_model_side_length));
+    implicitModeller->Update();
+    return implicitModeller->GetOutput();
+}
+
+/** @brief The main function
+ * @param[in] argc
+ * @param[in] argv list of PLY files
+ * @return Exit status */
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printf("Usage : %s mesh_1.ply [mesh_2.ply ...]\n", argv[0]);
+        return -1;
+    }
+    printf("%-32s %6s | %10s %10s %8s | %10s %10s %10s %11s | %9s %10s | %13s %13s\n", "mesh", "depth", "vtk(ms)", "bezier(ms)",
+           "speedup", "vtk_tri", "bezier_tri", "area_diff", "vertex(um)", "blocks", "active", "per_depth(mm)", "tolerance(mm)");
+    int failures = 0;
+    for (int index_file = 1; index_file < argc; index_file++)
+    {
+        vtkSmartPointer<vtkPLYReader> reader = vtkSmartPointer<vtkPLYReader>::New();
+        reader->SetFileName(argv[index_file]);
+        reader->Update();
+        vtkSmartPointer<vtkPolyData> mesh = reader->GetOutput();
+        if (mesh->GetNumberOfCells() == 0)
+        {
+            printf("Can't load %s\n", argv[index_file]);
+            failures++;
+            continue;
+        }
+        vtkSmartPointer<vtkImageData> field = distanceField(mesh, PASSES * GRIND_DEPTH);
+        double field_spacing[3];
+        field->GetSpacing(field_spacing);
+        const double vertex_tolerance = 0.001 * std::min(field_spacing[0], std::min(field_spacing[1], field_spacing[2]));
+        std::string name(argv[index_file]);
+        name = name.substr(name.find_last_of('/') + 1);
+
+        double total_vtk(0), total_bezier(0);
+        for (int passe = 1; passe <= PASSES; passe++)
+        {
+            const double value = passe * GRIND_DEPTH;
+            pcl::StopWatch watch;
+            // Current filter
+            vtkSmartPointer<vtkPolyData> vtk_surface;
+            watch.reset();
+            for (int r = 0; r < REPETITIONS; r++)
+            {
+                vtkSmartPointer<vtkMarchingCubes> marching_cubes = vtkSmartPointer<vtkMarchingCubes>::New();
+                marching_cubes->SetInputData(field);
+                marching_cubes->ComputeNormalsOff();
+                marching_cubes->ComputeScalarsOff();
+                marching_cubes->SetValue(0, value);
+                marching_cubes->Update();
+                vtk_surface = marching_cubes->GetOutput();
+            }
+            const double vtk_time = watch.getTime() / REPETITIONS;
+            // Block-parallel extraction
+            vtkSmartPointer<vtkPolyData> bezier_surface;
+            BezierIsoSurface iso_surface;
+            watch.reset();
+            for (int r = 0; r < REPETITIONS; r++)
+                bezier_surface = iso_surface.extract(field, value);
+            const double bezier_time = watch.getTime() / REPETITIONS;
+            total_vtk += vtk_time;
+            total_bezier += bezier_time;
+
+            const double vtk_area = meshArea(vtk_surface);
+            const double area_difference = vtk_area > 0 ? (meshArea(bezier_surface) - vtk_area) / vtk_area : 0;
+            // Same cut edges : same vertices up to float rounding (triangles of ambiguous cells may differ)
+            const double vertex_deviation = std::max(maximalVertexDeviation(bezier_surface, vtk_surface),
+                                                     maximalVertexDeviation(vtk_surface, bezier_surface));
+            const bool same_vertices = vertex_deviation <= vertex_tolerance;
+            // Shared field dilation against a field fitted to this depth only (symmetric surface deviation)
+            double per_depth_spacing;
+            vtkSmartPointer<vtkPolyData> per_depth_surface = perDepthDilation(mesh, value, per_depth_spacing);
+            const double per_depth_deviation = std::max(maximalDeviation(bezier_surface, per_depth_surface),
+                                                        maximalDeviation(per_depth_surface, bezier_surface));
+            const bool within_tolerance = same_vertices && per_depth_surface->GetNumberOfCells() > 0 && per_depth_deviation <= per_depth_spacing;
+            if (!within_tolerance)
+                failures++;
+            printf("%-32s %6.3f | %10.3f %10.3f %8.2f | %10ld %10ld %9.4f%% %11.4f | %9ld %10ld | %13.3f %13.3f%s\n", name.c_str(), value,
+                   vtk_time, bezier_time, bezier_time > 0 ? vtk_time / bezier_time : 0.0, (long)vtk_surface->GetNumberOfCells(),
+                   (long)bezier_surface->GetNumberOfCells(), 100 * area_difference, vertex_deviation * 1e6, iso_surface.numberOfBlocks(),
+                   iso_surface.numberOfActiveBlocks(), per_depth_deviation * 1000, per_depth_spacing * 1000,
+                   within_tolerance ? "" : " FAILED");
+        }
+        printf("%-32s %6s | %10.3f %10.3f %8.2f |\n", name.c_str(), "total", total_vtk, total_bezier,
+               total_bezier > 0 ? total_vtk / total_bezier : 0.0);
+    }
+    printf("%d iso-surfaces out of tolerance\n", failures);
+    return failures == 0 ? 0 : 1;
+}
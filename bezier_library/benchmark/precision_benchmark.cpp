@@ -0,0 +1,195 @@
+#include "bezier_library/bezier_geometry.hpp"
+#include "bezier_library/bezier_mesh_view.hpp"
+
+#include <cstdio>
+#include <string>
+
+// PCL headers
+#include <pcl/common/time.h>
+
+// VTK headers
+#include <vtkCellArray.h>
+#include <vtkCutter.h>
+#include <vtkPlane.h>
+#include <vtkPLYReader.h>
+#include <vtkPointData.h>
+#include <vtkPolyDataNormals.h>
+#include <vtkStripper.h>
+
+/**
+ * @file precision_benchmark.cpp
+ * @brief Compare float and double geometry kernels (speed and accuracy) on PLY meshes.
+ * Usage : precision_benchmark mesh_1.ply [mesh_2.ply ...]
+ */
+
+///@brief Number of repetitions of each kernel (timings are averaged)
+static const int REPETITIONS = 20;
+
+///@brief Timings (in milliseconds) and generated poses of one precision
+struct KernelResult
+{
+    double projection_time;
+    double filter_time;
+    double closest_time;
+    double pose_time;
+    long closest_checksum; //sum of nearest point indices, differs if float and double disagree on nearest points
+    std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > poses;
+};
+
+/**@brief Convert slices (stripper output) into lines at the requested precision */
+template <typename Scalar>
+typename BezierGeometry<Scalar>::Lines stripperToLines(vtkPolyData *slices)
+{
+    typedef BezierGeometry<Scalar> Geometry;
+    typename Geometry::Lines lines;
+    vtkDataArray *normals = slices->GetPointData()->GetNormals();
+    vtkCellArray *cells = slices->GetLines();
+    vtkIdType *indices;
+    vtkIdType numberOfPoints;
+    for (cells->InitTraversal(); cells->GetNextCell(numberOfPoints, indices);)
+    {
+        typename Geometry::Line line;
+        line.reserve(numberOfPoints);
+        for (vtkIdType i = 0; i < numberOfPoints; i++)
+        {
+            double point[3], normal[3];
+            slices->GetPoint(indices[i], point);
+            normals->GetTuple(indices[i], normal);
+            line.push_back(std::make_pair(typename Geometry::Vector3(point[0], point[1], point[2]),
+                                          typename Geometry::Vector3(normal[0], normal[1], normal[2])));
+        }
+        lines.push_back(typename Geometry::Line());
+        lines.back().swap(line);
+    }
+    return lines;
+}
+
+/**@brief Run projection, filter, nearest point and pose batch kernels */
+template <typename Scalar>
+KernelResult runKernels(const BezierMeshView &view, vtkPolyData *slices, const Eigen::Vector3d &direction)
+{
+    typedef BezierGeometry<Scalar> Geometry;
+    KernelResult result;
+    pcl::StopWatch watch;
+
+    // Slicing range
+    Scalar min_value(0), max_value(0);
+    watch.reset();
+    for (int r = 0; r < REPETITIONS; r++)
+        Geometry::projectionRange(view.points(), view.numberOfPoints(), direction.cast<Scalar>(), min_value, max_value);
+    result.projection_time = watch.getTime() / REPETITIONS;
+
+    // Filtering
+    typename Geometry::Lines reference_lines = stripperToLines<Scalar>(slices);
+    typename Geometry::Lines lines;
+    watch.reset();
+    for (int r = 0; r < REPETITIONS; r++)
+    {
+        lines = reference_lines;
+        Geometry::removeNearNeighborPoints(lines, Scalar(0.001));
+    }
+    result.filter_time = watch.getTime() / REPETITIONS;
+
+    // Nearest point : each point of each line against its neighbour line
+    long checksum = 0;
+    watch.reset();
+    for (int r = 0; r < REPETITIONS; r++)
+    {
+        for (size_t index_line = 0; index_line + 1 < lines.size(); index_line++)
+            for (size_t index_point = 0; index_point < lines[index_line].size(); index_point++)
+                checksum += Geometry::seekClosestPoint(lines[index_line][index_point].first, lines[index_line + 1]);
+    }
+    result.closest_time = watch.getTime() / REPETITIONS;
+
+    // Pose batch
+    watch.reset();
+    for (int r = 0; r < REPETITIONS; r++)
+    {
+        result.poses.clear();
+        for (size_t index_line = 0; index_line < lines.size(); index_line++)
+        {
+            for (size_t index_point = 0; index_point + 1 < lines[index_line].size(); index_point++)
+            {
+                Eigen::Affine3d pose(Eigen::Affine3d::Identity());
+                Geometry::generateRobotPose(lines[index_line][index_point].first, lines[index_line][index_point + 1].first,
+                                            lines[index_line][index_point].second, pose);
+                result.poses.push_back(pose);
+            }
+        }
+    }
+    result.pose_time = watch.getTime() / REPETITIONS;
+    result.closest_checksum = checksum / REPETITIONS;
+    return result;
+}
+
+/** @brief The main function
+ * @param[in] argc
+ * @param[in] argv list of PLY files
+ * @return Exit status */
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printf("Usage : %s mesh_1.ply [mesh_2.ply ...]\n", argv[0]);
+        return -1;
+    }
+    printf("%-40s %8s | %10s %10s %10s %10s | %12s %12s %12s\n", "mesh", "scalar", "range(ms)", "filter(ms)",
+           "closest(ms)", "poses(ms)", "checksum", "max_dist(m)", "max_angle(rad)");
+    for (int index_file = 1; index_file < argc; index_file++)
+    {
+        // Load mesh and compute normals
+        vtkSmartPointer<vtkPLYReader> reader = vtkSmartPointer<vtkPLYReader>::New();
+        reader->SetFileName(argv[index_file]);
+        vtkSmartPointer<vtkPolyDataNormals> normals = vtkSmartPointer<vtkPolyDataNormals>::New();
+        normals->SetInputConnection(reader->GetOutputPort());
+        normals->ComputePointNormalsOn();
+        normals->SplittingOff();
+        normals->Update();
+        vtkSmartPointer<vtkPolyData> mesh = normals->GetOutput();
+        BezierMeshView view(mesh);
+
+        // Cut along the largest side of the bounding box
+        double bounds[6];
+        mesh->GetBounds(bounds);
+        Eigen::Vector3d direction(bounds[1] - bounds[0], bounds[3] - bounds[2], bounds[5] - bounds[4]);
+        int axis;
+        direction.maxCoeff(&axis);
+        direction = Eigen::Vector3d::Unit(axis);
+        vtkSmartPointer<vtkPlane> plane = vtkSmartPointer<vtkPlane>::New();
+        plane->SetOrigin(mesh->GetCenter());
+        plane->SetNormal(direction[0], direction[1], direction[2]);
+        vtkSmartPointer<vtkCutter> cutter = vtkSmartPointer<vtkCutter>::New();
+        cutter->SetCutFunction(plane);
+        cutter->SetInputData(mesh);
+        double half_length = 0.5 * (bounds[2 * axis + 1] - bounds[2 * axis]);
+        cutter->GenerateValues(50, -half_length, half_length);
+        vtkSmartPointer<vtkStripper> stripper = vtkSmartPointer<vtkStripper>::New();
+        stripper->SetInputConnection(cutter->GetOutputPort());
+        stripper->Update();
+
+        KernelResult result_double = runKernels<double>(view, stripper->GetOutput(), direction);
+        KernelResult result_float = runKernels<float>(view, stripper->GetOutput(), direction);
+
+        // Accuracy of float poses against double poses
+        double max_distance(0), max_angle(0);
+        size_t number_of_poses = std::min(result_double.poses.size(), result_float.poses.size());
+        for (size_t i = 0; i < number_of_poses; i++)
+        {
+            max_distance = std::max(max_distance, (result_double.poses[i].translation() - result_float.poses[i].translation()).norm());
+            Eigen::AngleAxisd rotation(result_double.poses[i].linear().transpose() * result_float.poses[i].linear());
+            max_angle = std::max(max_angle, std::abs(rotation.angle()));
+        }
+
+        std::string name(argv[index_file]);
+        name = name.substr(name.find_last_of('/') + 1);
+        printf("%-40s %8s | %10.3f %10.3f %10.3f %10.3f | %12ld %12s %12s\n", name.c_str(), "double", result_double.projection_time,
+               result_double.filter_time, result_double.closest_time, result_double.pose_time, result_double.closest_checksum, "-", "-");
+        printf("%-40s %8s | %10.3f %10.3f %10.3f %10.3f | %12ld %12.3e %12.3e\n", name.c_str(), "float", result_float.projection_time,
+               result_float.filter_time, result_float.closest_time, result_float.pose_time, result_float.closest_checksum, max_distance,
+               max_angle);
+        if (result_double.poses.size() != result_float.poses.size())
+            printf("  warning : %lu double poses, %lu float poses (filtering differs near threshold)\n",
+                   (unsigned long)result_double.poses.size(), (unsigned long)result_float.poses.size());
+    }
+    return 0;
+}
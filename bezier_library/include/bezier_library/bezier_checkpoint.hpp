@@ -0,0 +1,101 @@
+#ifndef BEZIER_CHECKPOINT_HPP
+#define BEZIER_CHECKPOINT_HPP
+
+#include <string>
+#include <vector>
+
+// Eigen headers
+#include <Eigen/StdVector>
+#include <Eigen/Geometry>
+
+/**
+ * @file bezier_checkpoint.hpp
+ * @brief Trajectory cache and execution checkpoints (resume a grinding job after a stop).
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+/** @brief Execution progress of a trajectory, saved after each executed passe */
+struct BezierCheckpointState
+{
+    ///@brief Default state : nothing executed
+    BezierCheckpointState();
+
+    /** @brief identifier of the executed trajectory (see BezierCheckpoint::trajectoryId) */
+    std::string trajectory_id;
+    /** @brief number of completed passes : index of the next passe to execute */
+    int passe;
+    /** @brief index of the last pose of the last completed passe (-1 if no passe completed) */
+    int pose;
+};
+
+/** @brief BezierCheckpoint saves generated trajectories and execution checkpoints to text files.
+ *
+ * A trajectory file holds the poses, colors, passe indices and reachability of a generated trajectory,
+ * tagged with the trajectory identifier. A checkpoint file holds the progress of its execution.
+ * After a stop (e-stop, fault, restart of the node), the executor loads the cached trajectory
+ * instead of generating it again, and resumes at the first passe that was not completed.
+ * Files are written to a temporary file then renamed : a stop while writing never leaves a truncated file.
+ * Loaded files are not trusted : pose and passe counts are checked against the file length before allocation.
+ */
+class BezierCheckpoint
+{
+  public:
+    /**@brief Build a trajectory identifier from the file format, the files and the settings used to generate it
+     * @param[in] filenames files used to generate the trajectory (meshes) : name, size and modification time are used
+     * @param[in] parameters every setting that changes the trajectory (see Bezier::get_settings, engine version included)
+     * @return trajectory identifier (empty if a file does not exist)
+     */
+    static std::string trajectoryId(const std::vector<std::string> &filenames, const std::string &parameters);
+
+    /**@brief Save a generated trajectory
+     * @param[in] filename trajectory file
+     * @param[in] trajectory_id trajectory identifier
+     * @param[in] way_points_vector robot poses
+     * @param[in] color_vector true for grind poses, false for extrication poses
+     * @param[in] index_vector index of last pose of each passe (first value -1)
+     * @param[in] reachable_vector reachability of each pose (empty if not checked)
+     * @return boolean flag reflects the function proceedings.
+     */
+    static bool saveTrajectory(const std::string &filename, const std::string &trajectory_id,
+                               const std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector,
+                               const std::vector<bool> &color_vector, const std::vector<int> &index_vector,
+                               const std::vector<bool> &reachable_vector);
+
+    /**@brief Load a saved trajectory
+     * @param[in] filename trajectory file
+     * @param[in] trajectory_id expected trajectory identifier
+     * @param[out] way_points_vector robot poses
+     * @param[out] color_vector true for grind poses, false for extrication poses
+     * @param[out] index_vector index of last pose of each passe (first value -1)
+     * @param[out] reachable_vector reachability of each pose (empty if not checked)
+     * @return boolean flag reflects the function proceedings (false if file is missing, invalid or of another trajectory).
+     */
+    static bool loadTrajectory(const std::string &filename, const std::string &trajectory_id,
+                               std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector,
+                               std::vector<bool> &color_vector, std::vector<int> &index_vector, std::vector<bool> &reachable_vector);
+
+    /**@brief Save an execution checkpoint
+     * @param[in] filename checkpoint file
+     * @param[in] state execution progress
+     * @return boolean flag reflects the function proceedings.
+     */
+    static bool saveState(const std::string &filename, const BezierCheckpointState &state);
+
+    /**@brief Load an execution checkpoint
+     * @param[in] filename checkpoint file
+     * @param[out] state execution progress
+     * @return boolean flag reflects the function proceedings (false if file is missing or invalid).
+     */
+    static bool loadState(const std::string &filename, BezierCheckpointState &state);
+
+  private:
+    /**@brief Write a file atomically (temporary file renamed over the file)
+     * @param[in] filename file
+     * @param[in] content file content
+     * @return boolean flag reflects the function proceedings.
+     */
+    static bool writeFile(const std::string &filename, const std::string &content);
+};
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef BEZIER_COMPARISON_HPP
+#define BEZIER_COMPARISON_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Eigen headers
+#include <Eigen/StdVector>
+#include <Eigen/Geometry>
+
+/**
+ * @file bezier_comparison.hpp
+ * @brief Comparison of generated trajectories with reference outputs, within geometric tolerances.
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+/** @brief Tolerances used to decide if two trajectories are equivalent */
+struct BezierComparisonTolerances
+{
+    ///@brief Default tolerances (1 mm on grind lines, 5 mm on extrications, 1 degree on frames)
+    BezierComparisonTolerances();
+
+    /** @brief maximal Hausdorff distance between grind lines (m) */
+    double distance;
+    /** @brief maximal Hausdorff distance between whole passes, extrications included (m) */
+    double extrication_distance;
+    /** @brief maximal angle between frames of grind poses (rad) */
+    double angle;
+};
+
+/** @brief Result of a trajectory comparison */
+struct BezierComparisonReport
+{
+    ///@brief Default Constructor (empty report)
+    BezierComparisonReport();
+
+    /** @brief true if trajectories are equivalent within tolerances */
+    bool equivalent;
+    /** @brief number of passes of the reference trajectory */
+    int reference_passes;
+    /** @brief number of passes of the compared trajectory */
+    int passes;
+    /** @brief first passe out of tolerances (-1 if none) */
+    int failed_passe;
+    /** @brief maximal Hausdorff distance between grind lines (m) */
+    double max_distance;
+    /** @brief maximal Hausdorff distance between whole passes (m) */
+    double max_extrication_distance;
+    /** @brief maximal angle between frames of grind poses (rad) */
+    double max_angle;
+    /** @brief reason of the first difference (empty if equivalent) */
+    std::string message;
+};
+
+/** @brief BezierComparison checks that a trajectory is equivalent to a reference trajectory.
+ *
+ * Trajectories are outputs of Bezier::generateTrajectory (poses, colors and passe indices).
+ * They are equivalent if they have the same number of passes and, in each passe :
+ * - the same number of grind lines (runs of grind poses)
+ * - grind lines within a Hausdorff distance tolerance of their reference lines
+ * - whole passes (grind lines and extrications) within a looser distance tolerance
+ * - frames of grind poses within an angular tolerance of the reference frames (interpolated at the closest point)
+ *
+ * Pose counts may differ (resampling, other slicing engines) : distances are measured between polylines.
+ */
+class BezierComparison
+{
+  public:
+    ///@brief Vector of robot poses
+    typedef std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > Poses;
+
+    /**@brief Compare a trajectory with a reference trajectory
+     * @param[in] reference_poses poses of reference trajectory
+     * @param[in] reference_colors colors of reference trajectory (true for grind poses)
+     * @param[in] reference_indices passe indices of reference trajectory
+     * @param[in] poses poses of compared trajectory
+     * @param[in] colors colors of compared trajectory
+     * @param[in] indices passe indices of compared trajectory
+     * @param[in] tolerances comparison tolerances
+     * @param[out] report comparison result (maximal errors over all passes)
+     * @return boolean flag reflects the function proceedings (true if trajectories are equivalent).
+     */
+    static bool compare(const Poses &reference_poses, const std::vector<bool> &reference_colors, const std::vector<int> &reference_indices,
+                        const Poses &poses, const std::vector<bool> &colors, const std::vector<int> &indices,
+                        const BezierComparisonTolerances &tolerances, BezierComparisonReport &report);
+
+    /**@brief Hausdorff distance between two polylines (positions of poses) : largest distance from a vertex of a polyline to the other one
+     * @param[in] polyline_a first polyline
+     * @param[in] polyline_b second polyline
+     * @return Hausdorff distance (0 if both are empty, infinity if only one is empty)
+     */
+    static double hausdorffDistance(const Poses &polyline_a, const Poses &polyline_b);
+
+    /**@brief Largest angle between frames of poses and reference frames interpolated (slerp) at their closest point on reference polyline
+     * @param[in] reference reference polyline
+     * @param[in] poses compared poses
+     * @return largest angle (rad), 0 if a polyline is empty
+     */
+    static double maxFrameAngle(const Poses &reference, const Poses &poses);
+
+  private:
+    /**@brief Closest point of a polyline
+     * @param[in] polyline first vertex of polyline
+     * @param[in] size number of vertices (not 0)
+     * @param[in] point point
+     * @param[out] segment index of first vertex of closest segment
+     * @param[out] t position of closest point on segment (between 0 and 1)
+     * @return distance between point and polyline
+     */
+    static double closestPoint(const Eigen::Affine3d *polyline, size_t size, const Eigen::Vector3d &point, size_t &segment, double &t);
+
+    /**@brief Hausdorff distance between two polylines read in place (see hausdorffDistance)
+     * @param[in] polyline_a first vertex of first polyline
+     * @param[in] size_a number of vertices of first polyline
+     * @param[in] polyline_b first vertex of second polyline
+     * @param[in] size_b number of vertices of second polyline
+     * @return Hausdorff distance
+     */
+    static double hausdorffDistance(const Eigen::Affine3d *polyline_a, size_t size_a, const Eigen::Affine3d *polyline_b, size_t size_b);
+
+    /**@brief Largest frame angle of poses read in place (see maxFrameAngle)
+     * @param[in] reference first vertex of reference polyline
+     * @param[in] reference_size number of vertices of reference polyline
+     * @param[in] poses first compared pose
+     * @param[in] size number of compared poses
+     * @return largest angle (rad)
+     */
+    static double maxFrameAngle(const Eigen::Affine3d *reference, size_t reference_size, const Eigen::Affine3d *poses, size_t size);
+
+    /**@brief Split a passe in grind lines (runs of grind poses)
+     * @param[in] colors colors of trajectory
+     * @param[in] first index of first pose of passe
+     * @param[in] last index of last pose of passe
+     * @param[out] lines index of first and last pose of each grind line
+     */
+    static void grindLines(const std::vector<bool> &colors, int first, int last, std::vector<std::pair<int, int> > &lines);
+};
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef BEZIER_DISPLAY_HPP
+#define BEZIER_DISPLAY_HPP
+
+#include <deque>
+#include <string>
+#include <vector>
+
+// Eigen headers
+#include <Eigen/StdVector>
+#include <Eigen/Geometry>
+
+#include "bezier_library/bezier_pass_view.hpp"
+
+// ROS headers
+#include <ros/ros.h>
+#include <visualization_msgs/Marker.h>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+/**
+ * @file bezier_display.hpp
+ * @brief Non-blocking RVIZ display of meshes, trajectories and normals.
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+/** @brief BezierDisplay builds RVIZ markers and publishes them from a background thread.
+ *
+ * Display functions never wait for subscribers : publishers should be latched (ros::NodeHandle::advertise(topic, 1, true))
+ * so that RVIZ receives the last marker whenever it connects.
+ * Markers waiting to be published on the same topic are replaced by the newest one.
+ * Big trajectories are decimated for display (see @ref max_display_points_).
+ */
+class BezierDisplay
+{
+  public:
+
+    /**@brief Constructor : starts publishing thread
+     * @param[in] max_display_points maximal number of points in a trajectory marker (and of arrows in a normal marker)
+     */
+    explicit BezierDisplay(size_t max_display_points = 5000);
+
+    ///@brief Destructor : publishes pending markers and stops publishing thread
+    ~BezierDisplay();
+
+    /**@brief Display normals (Z axis of poses) of grind poses as a single LINE_LIST marker
+     * @param[in] way_points_vector vector containing robot poses
+     * @param[in] points_color_viz it's a bool vector using to distinguish real path and extrication path
+     * @param[in] normal_publisher publisher of visualization_msgs::Marker used to display normals in RVIZ
+     * @note Boolean vector and trajectory vector need to have same sizes.
+     */
+    void displayNormal(const std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector,
+                       const std::vector<bool> &points_color_viz, const ros::Publisher &normal_publisher);
+
+    /**@brief Display a trajectory as a LINE_STRIP marker (green : grind path, red : extrication path)
+     * @param[in] way_points_vector 3D trajectory vector (containing poses)
+     * @param[in] points_color_viz it's a bool vector using to distinguish real path and extrication path
+     * @param[in] trajectory_publisher publisher of visualization_msgs::Marker used to display trajectory marker
+     * @note Boolean vector and trajectory vector need to have same sizes.
+     */
+    void displayTrajectory(const std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector,
+                           const std::vector<bool> &points_color_viz, const ros::Publisher &trajectory_publisher);
+
+    /**@brief Display normals (Z axis of poses) of grind poses of a passe, read in place
+     * @param[in] passe poses and colors of a passe (or of a whole trajectory)
+     * @param[in] normal_publisher publisher of visualization_msgs::Marker used to display normals in RVIZ
+     */
+    void displayNormal(const BezierPassView &passe, const ros::Publisher &normal_publisher);
+
+    /**@brief Display a passe as a LINE_STRIP marker (green : grind path, red : extrication path), read in place
+     * @param[in] passe poses and colors of a passe (or of a whole trajectory)
+     * @param[in] trajectory_publisher publisher of visualization_msgs::Marker used to display trajectory marker
+     */
+    void displayTrajectory(const BezierPassView &passe, const ros::Publisher &trajectory_publisher);
+
+    /**@brief Display a mesh (MESH_RESOURCE marker)
+     * @param[in] mesh_publisher publisher of visualization_msgs::Marker used to display the mesh in RVIZ
+     * @param[in] mesh_path path of mesh (ROS resource : package://...)
+     */
+    void displayMesh(const ros::Publisher &mesh_publisher, const std::string &mesh_path);
+
+    ///@brief Block until all pending markers have been published
+    void flush();
+
+  private:
+    /** @brief Marker waiting to be published */
+    struct PendingMarker
+    {
+        /** @brief publisher used to publish marker */
+        ros::Publisher publisher;
+        /** @brief marker to publish */
+        visualization_msgs::MarkerConstPtr marker;
+    };
+
+    /**@brief Add a marker to the publishing queue (replace pending marker of the same topic)
+     * @param[in] publisher publisher used to publish marker
+     * @param[in] marker marker to publish
+     */
+    void enqueue(const ros::Publisher &publisher, const visualization_msgs::MarkerConstPtr &marker);
+
+    ///@brief Publishing thread loop
+    void publishLoop();
+
+    /**@brief Get display step so that a marker has at most @ref max_display_points_ points
+     * @param[in] number_of_points number of points to display
+     * @return step between two displayed points
+     */
+    size_t decimationStep(size_t number_of_points) const;
+
+    /** @brief maximal number of points in a marker */
+    size_t max_display_points_;
+    /** @brief markers waiting to be published */
+    std::deque<PendingMarker> queue_;
+    /** @brief true while a marker is being published */
+    bool publishing_;
+    /** @brief true when publishing thread must stop */
+    bool stop_;
+    /** @brief mutex protecting queue_, publishing_ and stop_ */
+    boost::mutex mutex_;
+    /** @brief condition used to wake publishing thread and flush() */
+    boost::condition_variable condition_;
+    /** @brief publishing thread */
+    boost::thread thread_;
+};
+
+#endif
@@ -0,0 +1,541 @@
+#ifndef BEZIER_GEOMETRY_HPP
+#define BEZIER_GEOMETRY_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Eigen headers
+#include <Eigen/StdVector>
+#include <Eigen/Dense>
+
+/**
+ * @file bezier_geometry.hpp
+ * @brief Geometry kernels (slicing, filtering, nearest point and pose batch) templated on scalar type.
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+/**@brief BezierScalar is the scalar type used to store intermediate geometry buffers (lines, slices...)
+ * It is set at compile time with the CMake option bezier_library_USE_FLOAT (BEZIER_USE_FLOAT definition).
+ * Final robot poses are always computed in double precision.
+ */
+#ifdef BEZIER_USE_FLOAT
+typedef float BezierScalar;
+#else
+typedef double BezierScalar;
+#endif
+
+/** @brief BezierGeometry gathers geometry kernels used by the path generation.
+ * @note Scalar is float or double. Functions are static : BezierGeometry is only a template namespace.
+ */
+template <typename Scalar>
+struct BezierGeometry
+{
+    ///@brief 3D vector
+    typedef Eigen::Matrix<Scalar, 3, 1> Vector3;
+    ///@brief Pair (point position, point normal)
+    typedef std::pair<Vector3, Vector3> PointNormal;
+    ///@brief Line is a vector of pairs (first point position, second z normal)
+    typedef std::vector<PointNormal> Line;
+    ///@brief Vector containing several lines
+    typedef std::vector<Line> Lines;
+    ///@brief Vector of robot poses (double precision)
+    typedef std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > Poses;
+
+    /**@brief Get min and max of scalar products between a direction and a point array (slicing range)
+     * @param[in] points contiguous point coordinates (x0,y0,z0,x1...)
+     * @param[in] number_of_points number of points in array
+     * @param[in] direction cut direction
+     * @param[out] min_value minimal scalar product
+     * @param[out] max_value maximal scalar product
+     * @return false if there is no point
+     */
+    template <typename PointScalar>
+    static bool projectionRange(const PointScalar *points, long number_of_points, const Vector3 &direction,
+                                Scalar &min_value, Scalar &max_value)
+    {
+        min_value = std::numeric_limits<Scalar>::max();
+        max_value = -std::numeric_limits<Scalar>::max();
+        const Scalar dx = direction[0], dy = direction[1], dz = direction[2];
+        for (long i = 0; i < number_of_points; i++)
+        {
+            const PointScalar *p = points + 3 * i;
+            Scalar value = dx * p[0] + dy * p[1] + dz * p[2];
+            min_value = std::min(min_value, value);
+            max_value = std::max(max_value, value);
+        }
+        return number_of_points > 0;
+    }
+
+    /**@brief Count distinct slice positions : values closer than threshold are merged.
+     * @param[in] values scalar products between slice points and cut direction (sorted in place)
+     * @param[in] threshold minimal distance between two slices
+     * @return number of distinct slices
+     */
+    static unsigned int countDistinctValues(std::vector<Scalar> &values, Scalar threshold)
+    {
+        if (values.empty())
+            return 0;
+        std::sort(values.begin(), values.end());
+        unsigned int count = 1;
+        Scalar reference = values[0];
+        for (size_t i = 1; i < values.size(); i++)
+        {
+            if (std::abs(values[i] - reference) >= threshold)
+            {
+                count++;
+                reference = values[i];
+            }
+        }
+        return count;
+    }
+
+    /**@brief Remove too close points in lines. Each point is compared to the next point : if they are too close, the next point
+     * is removed and comparison resumes after it, unless it is the end of the line (then the point is removed instead).
+     * Lines are compacted in place, with the same result as erasing points one by one.
+     * @param[in, out] lines lines to filter
+     * @param[in] min_distance minimal distance between two consecutive points
+     */
+    static void removeNearNeighborPoints(Lines &lines, Scalar min_distance)
+    {
+        for (size_t index_line = 0; index_line < lines.size(); index_line++)
+        {
+            Line &line = lines[index_line];
+            const size_t size = line.size();
+            size_t kept = 0; //number of kept points
+            size_t index_point = 0;
+            while (index_point + 1 < size)
+            {
+                bool too_close = std::sqrt((line[index_point].first - line[index_point + 1].first).squaredNorm()) < min_distance;
+                if (!too_close)
+                    line[kept++] = line[index_point++];
+                else if (index_point + 2 < size)
+                {
+                    line[kept++] = line[index_point]; //next point is removed
+                    index_point += 2;
+                }
+                else
+                {
+                    index_point++; //keep end of line
+                    break;
+                }
+            }
+            if (index_point < size)
+                line[kept++] = line[index_point++];
+            line.resize(kept);
+        }
+    }
+
+    /** @brief Result of a line simplification */
+    struct SimplificationReport
+    {
+        ///@brief Default Constructor (empty report)
+        SimplificationReport() :
+                input_points(0), output_points(0), max_chordal_deviation(0), max_angular_deviation(0)
+        {
+        }
+        /** @brief number of points before simplification */
+        long input_points;
+        /** @brief number of points after simplification */
+        long output_points;
+        /** @brief maximal distance between a removed point and the simplified line */
+        Scalar max_chordal_deviation;
+        /** @brief maximal angle (rad) between the normal of a removed point and the interpolated normal */
+        Scalar max_angular_deviation;
+
+        ///@brief Add results of another simplification
+        void add(const SimplificationReport &report)
+        {
+            input_points += report.input_points;
+            output_points += report.output_points;
+            max_chordal_deviation = std::max(max_chordal_deviation, report.max_chordal_deviation);
+            max_angular_deviation = std::max(max_angular_deviation, report.max_angular_deviation);
+        }
+    };
+
+    /**@brief Deviation of a point from the segment [first, last] of a line
+     * @param[in] line line containing the segment
+     * @param[in] first index of first point of segment
+     * @param[in] last index of last point of segment
+     * @param[in] k index of point (between first and last)
+     * @param[out] chordal_deviation distance between point and segment
+     * @param[out] angular_deviation angle (rad) between point normal and normal interpolated on segment
+     */
+    static void segmentDeviation(const Line &line, size_t first, size_t last, size_t k, Scalar &chordal_deviation, Scalar &angular_deviation)
+    {
+        const Vector3 &a = line[first].first;
+        const Vector3 chord = line[last].first - a;
+        const Scalar length2 = chord.squaredNorm();
+        Scalar t = (length2 > 0) ? (line[k].first - a).dot(chord) / length2 : 0;
+        t = std::min(Scalar(1), std::max(Scalar(0), t));
+        chordal_deviation = (line[k].first - (a + t * chord)).norm();
+        Vector3 normal = (1 - t) * line[first].second + t * line[last].second;
+        Scalar cos_angle = normal.normalized().dot(line[k].second.normalized());
+        angular_deviation = std::acos(std::min(Scalar(1), std::max(Scalar(-1), cos_angle)));
+    }
+
+    /**@brief Simplify lines under a tolerance (Douglas-Peucker on positions and normals).
+     * A point is removed if its distance to the simplified segment (chordal deviation) and the angle between its normal
+     * and the normal interpolated on the segment (angular deviation) are within tolerances. So, points stay dense on curved
+     * features and become sparse on flat ones. First and last points of a line are always kept.
+     * @param[in, out] lines lines to simplify
+     * @param[in] chordal_tolerance maximal chordal deviation (in meters)
+     * @param[in] angular_tolerance maximal angular deviation of normals (in radians)
+     * @return simplification report (points removed and maximal deviations)
+     */
+    static SimplificationReport simplifyLines(Lines &lines, Scalar chordal_tolerance, Scalar angular_tolerance)
+    {
+        SimplificationReport report;
+        std::vector<unsigned char> keep;
+        std::vector<std::pair<size_t, size_t> > segments;
+        for (size_t index_line = 0; index_line < lines.size(); index_line++)
+        {
+            Line &line = lines[index_line];
+            report.input_points += line.size();
+            if (line.size() > 2)
+            {
+                keep.assign(line.size(), 0);
+                keep.front() = keep.back() = 1;
+                segments.clear();
+                segments.push_back(std::make_pair(size_t(0), line.size() - 1));
+                while (!segments.empty())
+                {
+                    size_t first = segments.back().first, last = segments.back().second;
+                    segments.pop_back();
+                    if (last - first < 2)
+                        continue;
+                    const Scalar length2 = (line[last].first - line[first].first).squaredNorm();
+                    // Worst point of the segment (normalized by tolerances)
+                    size_t worst = (first + last) / 2;
+                    Scalar worst_error = (length2 > 0) ? 0 : std::numeric_limits<Scalar>::max(); //closed line : split
+                    for (size_t k = first + 1; k < last; k++)
+                    {
+                        Scalar chordal_deviation, angular_deviation;
+                        segmentDeviation(line, first, last, k, chordal_deviation, angular_deviation);
+                        Scalar error = std::max(chordal_deviation / chordal_tolerance, angular_deviation / angular_tolerance);
+                        if (!(error <= worst_error)) //NAN normals are never removed
+                        {
+                            worst_error = error;
+                            worst = k;
+                        }
+                    }
+                    if (!(worst_error <= 1))
+                    {
+                        keep[worst] = 1;
+                        segments.push_back(std::make_pair(first, worst));
+                        segments.push_back(std::make_pair(worst, last));
+                        continue;
+                    }
+                    // Segment accepted : record deviations of removed points
+                    for (size_t k = first + 1; k < last; k++)
+                    {
+                        Scalar chordal_deviation, angular_deviation;
+                        segmentDeviation(line, first, last, k, chordal_deviation, angular_deviation);
+                        report.max_chordal_deviation = std::max(report.max_chordal_deviation, chordal_deviation);
+                        report.max_angular_deviation = std::max(report.max_angular_deviation, angular_deviation);
+                    }
+                }
+                size_t last_kept = 0;
+                for (size_t k = 0; k < line.size(); k++)
+                    if (keep[k])
+                        line[last_kept++] = line[k];
+                line.resize(last_kept);
+            }
+            report.output_points += line.size();
+        }
+        return report;
+    }
+
+    /** @brief Result of a normal smoothing */
+    struct SmoothingReport
+    {
+        ///@brief Default Constructor (empty report)
+        SmoothingReport() :
+                input_points(0), max_deviation(0), limited_points(0)
+        {
+        }
+        /** @brief number of points of smoothed lines */
+        long input_points;
+        /** @brief maximal angle (rad) between a smoothed normal and its raw normal */
+        Scalar max_deviation;
+        /** @brief number of smoothed normals limited by the maximal deviation */
+        long limited_points;
+
+        ///@brief Add results of another smoothing
+        void add(const SmoothingReport &report)
+        {
+            input_points += report.input_points;
+            max_deviation = std::max(max_deviation, report.max_deviation);
+            limited_points += report.limited_points;
+        }
+    };
+
+    /**@brief Smooth normals of lines (windowed average along the line).
+     * Each normal is replaced by the average of the normals within window_length / 2 (arc length) around its point,
+     * weighted by a triangular window, so jittery normals (scanned or noisy meshes) give continuous tool orientations.
+     * A smoothed normal never deviates more than max_deviation from its raw normal : it is rotated back towards the raw normal,
+     * so real features of the surface (edges, small radii) are still followed. Positions are not modified.
+     * @param[in, out] lines lines to smooth
+     * @param[in] window_length length (in meters) of the averaging window, 0 disables smoothing
+     * @param[in] max_deviation maximal angle (in radians) between a smoothed normal and its raw normal
+     * @return smoothing report (maximal deviation)
+     */
+    static SmoothingReport smoothNormals(Lines &lines, Scalar window_length, Scalar max_deviation)
+    {
+        SmoothingReport report;
+        if (!(window_length > 0))
+            return report;
+        const Scalar half_window = window_length / 2;
+        std::vector<Scalar> arc_length;
+        std::vector<Vector3, Eigen::aligned_allocator<Vector3> > normals;
+        for (size_t index_line = 0; index_line < lines.size(); index_line++)
+        {
+            Line &line = lines[index_line];
+            report.input_points += line.size();
+            if (line.size() < 3)
+                continue;
+            arc_length.resize(line.size());
+            arc_length[0] = 0;
+            for (size_t k = 1; k < line.size(); k++)
+                arc_length[k] = arc_length[k - 1] + (line[k].first - line[k - 1].first).norm();
+            normals.resize(line.size());
+            size_t begin = 0, end = 0; //window [begin, end)
+            for (size_t k = 0; k < line.size(); k++)
+            {
+                while (arc_length[k] - arc_length[begin] > half_window)
+                    begin++;
+                while (end < line.size() && arc_length[end] - arc_length[k] <= half_window)
+                    end++;
+                Vector3 sum(Vector3::Zero());
+                for (size_t j = begin; j < end; j++)
+                {
+                    if (!line[j].second.allFinite() || line[j].second == Vector3::Zero())
+                        continue;
+                    sum += (1 - std::abs(arc_length[j] - arc_length[k]) / half_window) * line[j].second.normalized();
+                }
+                normals[k] = line[k].second;
+                if (!line[k].second.allFinite() || line[k].second == Vector3::Zero() || !(sum.squaredNorm() > 0))
+                    continue; //NAN normals are kept (poses are rejected later)
+                const Vector3 raw = line[k].second.normalized();
+                Vector3 smoothed = sum.normalized();
+                Scalar deviation = std::acos(std::min(Scalar(1), std::max(Scalar(-1), raw.dot(smoothed))));
+                if (deviation > max_deviation)
+                {
+                    // Rotate raw normal towards smoothed normal by max_deviation
+                    Vector3 axis = raw.cross(smoothed);
+                    smoothed = (axis.squaredNorm() > 0) ? Vector3(Eigen::AngleAxis<Scalar>(max_deviation, axis.normalized()) * raw) : raw;
+                    deviation = (axis.squaredNorm() > 0) ? max_deviation : 0;
+                    report.limited_points++;
+                }
+                normals[k] = smoothed;
+                report.max_deviation = std::max(report.max_deviation, deviation);
+            }
+            for (size_t k = 0; k < line.size(); k++)
+                line[k].second = normals[k];
+        }
+        return report;
+    }
+
+    /**@brief Peak angular rate of the tool along a line : largest rotation between frames of consecutive points
+     * (frames of generateRobotPose, X axis made orthogonal to the normal) divided by the distance between points.
+     * Multiplied by the feed rate, it gives the angular velocity the controller has to follow.
+     * @param[in] line line (positions and normals)
+     * @return peak angular rate (rad/m), 0 if the line has less than 3 points
+     */
+    static Scalar peakAngularRate(const Line &line)
+    {
+        Scalar peak_rate = 0;
+        Eigen::Matrix<Scalar, 3, 3> frame, previous_frame;
+        bool previous_valid = false;
+        for (size_t k = 0; k + 1 < line.size(); k++)
+        {
+            const Vector3 normal_z = line[k].second.normalized();
+            Vector3 normal_y = normal_z.cross(line[k + 1].first - line[k].first);
+            bool valid = normal_y.squaredNorm() > 0 && normal_y.allFinite(); //false for duplicate points or NAN normals
+            if (valid)
+            {
+                normal_y.normalize();
+                frame.col(0) = normal_y.cross(normal_z);
+                frame.col(1) = normal_y;
+                frame.col(2) = normal_z;
+                if (previous_valid)
+                {
+                    // Rotation angle between frames : trace(R) = 1 + 2 cos(angle)
+                    const Scalar cos_angle = ((previous_frame.transpose() * frame).trace() - 1) / 2;
+                    const Scalar angle = std::acos(std::min(Scalar(1), std::max(Scalar(-1), cos_angle)));
+                    peak_rate = std::max(peak_rate, angle / (line[k].first - line[k - 1].first).norm());
+                }
+                previous_frame = frame;
+            }
+            previous_valid = valid;
+        }
+        return peak_rate;
+    }
+
+    /**@brief Stitch line fragments of the same cutting plane (a slice is broken in several fragments by mesh holes).
+     * Fragments are oriented along line_direction, grouped by plane (scalar product of their middle point with
+     * plane_normal, as in slice counting) and ordered along line_direction. Consecutive fragments of a plane are joined
+     * when the gap between the end of one and the start of the next is not greater than max_gap.
+     * @param[in, out] lines fragments to stitch (replaced by stitched lines, grouped by plane)
+     * @param[in] plane_normal cut direction (normal of cutting planes)
+     * @param[in] line_direction direction in which lines are oriented
+     * @param[in] plane_threshold fragments whose plane positions differ by less than plane_threshold belong to the same plane
+     * @param[in] max_gap maximal gap bridged between two fragments (0 only joins touching fragments)
+     * @return number of gaps bridged
+     */
+    static unsigned int stitchLines(Lines &lines, const Vector3 &plane_normal, const Vector3 &line_direction,
+                                    Scalar plane_threshold, Scalar max_gap)
+    {
+        // Orient fragments and get their plane position
+        std::vector<std::pair<Scalar, size_t> > planes;
+        planes.reserve(lines.size());
+        for (size_t index_line = 0; index_line < lines.size(); index_line++)
+        {
+            Line &line = lines[index_line];
+            if (line.empty())
+                continue;
+            if (line_direction.dot(line.back().first - line.front().first) < 0)
+                std::reverse(line.begin(), line.end());
+            planes.push_back(std::make_pair(plane_normal.dot(line[line.size() / 2].first), index_line));
+        }
+        std::sort(planes.begin(), planes.end());
+
+        const Scalar max_gap2 = max_gap * max_gap;
+        unsigned int bridged_gaps = 0;
+        Lines stitched_lines;
+        stitched_lines.reserve(planes.size());
+        for (size_t begin = 0; begin < planes.size();)
+        {
+            // Fragments of this plane, ordered along line direction
+            size_t end = begin + 1;
+            while (end < planes.size() && std::abs(planes[end].first - planes[begin].first) < plane_threshold)
+                end++;
+            std::vector<std::pair<Scalar, size_t> > fragments;
+            fragments.reserve(end - begin);
+            for (size_t i = begin; i < end; i++)
+                fragments.push_back(std::make_pair(line_direction.dot(lines[planes[i].second].front().first), planes[i].second));
+            std::sort(fragments.begin(), fragments.end());
+
+            // Join consecutive fragments separated by a small gap
+            stitched_lines.push_back(Line());
+            stitched_lines.back().swap(lines[fragments[0].second]);
+            for (size_t i = 1; i < fragments.size(); i++)
+            {
+                Line &fragment = lines[fragments[i].second];
+                Line &current = stitched_lines.back();
+                if ((fragment.front().first - current.back().first).squaredNorm() <= max_gap2)
+                {
+                    current.insert(current.end(), fragment.begin(), fragment.end());
+                    bridged_gaps++;
+                }
+                else
+                {
+                    stitched_lines.push_back(Line());
+                    stitched_lines.back().swap(fragment);
+                }
+            }
+            begin = end;
+        }
+        lines.swap(stitched_lines);
+        return bridged_gaps;
+    }
+
+    /**@brief Find index of the closest point in a line
+     * @param[in] point point position
+     * @param[in] line line to search in
+     * @return index of closest point (0 if line is empty)
+     */
+    static int seekClosestPoint(const Vector3 &point, const Line &line)
+    {
+        int index(0);
+        Scalar distance(std::numeric_limits<Scalar>::max());
+        for (size_t index_point = 0; index_point < line.size(); index_point++)
+        {
+            Scalar d = (line[index_point].first - point).squaredNorm();
+            if (d < distance)
+            {
+                distance = d;
+                index = index_point;
+            }
+        }
+        return index;
+    }
+
+    /**@brief Find index of the line whose last point is the closest to a point
+     * @param[in] point point position
+     * @param[in] lines lines to search in
+     * @return index of closest line (0 if lines is empty)
+     */
+    static int seekClosestLine(const Vector3 &point, const Lines &lines)
+    {
+        int index(0);
+        Scalar distance(std::numeric_limits<Scalar>::max());
+        for (size_t index_line = 0; index_line < lines.size(); index_line++)
+        {
+            if (lines[index_line].empty())
+                continue;
+            Scalar d = (lines[index_line].back().first - point).squaredNorm();
+            if (d < distance)
+            {
+                distance = d;
+                index = index_line;
+            }
+        }
+        return index;
+    }
+
+    /**@brief Find index of the closest pose in a pose vector (translation only)
+     * @param[in] point point position
+     * @param[in] poses poses to search in
+     * @return index of closest pose (0 if poses is empty)
+     */
+    static int seekClosestPose(const Vector3 &point, const Poses &poses)
+    {
+        int index(0);
+        Scalar distance(std::numeric_limits<Scalar>::max());
+        for (size_t index_point = 0; index_point < poses.size(); index_point++)
+        {
+            Scalar d = (poses[index_point].translation().template cast<Scalar>() - point).squaredNorm();
+            if (d < distance)
+            {
+                distance = d;
+                index = index_point;
+            }
+        }
+        return index;
+    }
+
+    /**@brief Generate a robot pose from a point, the next point of the line and the point normal.
+     * X axis follows the line, Z axis is the normal and Y axis completes the frame.
+     * Intermediate vectors are computed with Scalar, the final pose is double.
+     * @param[in] point point position
+     * @param[in] point_next next point position
+     * @param[in] normal point normal (z normal)
+     * @param[out] pose robot pose
+     * @return false if X axis is null (duplicate points) or if pose has NAN values
+     */
+    static bool generateRobotPose(const Vector3 &point, const Vector3 &point_next, const Vector3 &normal, Eigen::Affine3d &pose)
+    {
+        Vector3 normal_x = point_next - point; //next point direction
+        if (normal_x == Vector3::Zero())
+            return false;
+        Vector3 normal_y = normal.cross(normal_x); //determined using others normal vectors
+        Vector3 normal_z = normal;
+        normal_x.normalize();
+        normal_y.normalize();
+        normal_z.normalize();
+        // Check if pose has NAN values
+        if (!normal_y.allFinite())
+            return false;
+        pose.translation() = point.template cast<double>();
+        pose.linear().col(0) = normal_x.template cast<double>();
+        pose.linear().col(1) = normal_y.template cast<double>();
+        pose.linear().col(2) = normal_z.template cast<double>();
+        return true;
+    }
+};
+
+#endif
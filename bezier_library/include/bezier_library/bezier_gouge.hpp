@@ -0,0 +1,122 @@
+#ifndef BEZIER_GOUGE_HPP
+#define BEZIER_GOUGE_HPP
+
+#include <vector>
+
+// Eigen headers
+#include <Eigen/StdVector>
+#include <Eigen/Geometry>
+
+class BezierMeshView;
+
+/**
+ * @file bezier_gouge.hpp
+ * @brief Tool gouge check : grinding disk at each pose against a triangle BVH of the part.
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+/** @brief Tool model used by the gouge check.
+ *
+ * The tool is a cylinder (grinding disk and holder) whose axis is the Z axis of the pose : Z points towards the part,
+ * the disk face is the plane Z = 0 of the pose and the tool body goes from Z = -tolerance to Z = -length.
+ * Part material inside this volume is cut by the tool (gouge). The tolerance lets the disk face touch the surface.
+ */
+struct BezierTool
+{
+    ///@brief Default Constructor : disk of 2 cm (diameter), 2 cm long, 0.5 mm tolerance
+    BezierTool();
+
+    /** @brief tool radius (in meters) */
+    double radius;
+    /** @brief tool length along Z axis (in meters) */
+    double length;
+    /** @brief distance between disk face and checked volume (in meters) */
+    double tolerance;
+};
+
+/** @brief BezierGougeCheck tests the tool at robot poses against the triangles of a part.
+ *
+ * Triangles are stored in a bounding volume hierarchy (axis aligned boxes, median split) built once per part.
+ * Each pose only tests triangles whose boxes overlap the box of the tool, with an exact triangle/cylinder test
+ * (triangle clipped between tool planes, then distance to tool axis).
+ * Batch functions are parallel (OpenMP).
+ */
+class BezierGougeCheck
+{
+  public:
+    ///@brief Vector of robot poses
+    typedef std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > Poses;
+
+    /**@brief Constructor : build BVH of the part
+     * @param[in] part flat view of part mesh
+     * @param[in] tool tool model
+     */
+    BezierGougeCheck(const BezierMeshView &part, const BezierTool &tool);
+
+    /**@brief Check if tool cuts the part at a pose
+     * @param[in] pose robot pose
+     * @return true if a triangle of the part intersects the tool volume
+     */
+    bool gouges(const Eigen::Affine3d &pose) const;
+
+    /**@brief Check all poses (parallel)
+     * @param[in] poses robot poses
+     * @param[out] gouge_flags 1 if tool cuts the part at pose, 0 otherwise
+     * @return number of gouging poses
+     */
+    long check(const Poses &poses, std::vector<unsigned char> &gouge_flags) const;
+
+    /**@brief Avoid gouges (parallel) : the tool of a gouging pose is tilted around X and Y axes of the pose
+     * (step, -step, 2 step... up to max_tilt), then lifted along -Z (up to max_lift). First pose without gouge is kept.
+     * @param[in, out] poses robot poses
+     * @param[in, out] gouge_flags gouges of poses (from check), updated
+     * @param[in] max_tilt maximal tilt angle (in radians), 0 disables tilting
+     * @param[in] tilt_step tilt step (in radians)
+     * @param[in] max_lift maximal lift (in meters), 0 disables lifting
+     * @param[in] lift_step lift step (in meters)
+     * @return number of poses still gouging
+     */
+    long avoid(Poses &poses, std::vector<unsigned char> &gouge_flags, double max_tilt, double tilt_step,
+               double max_lift, double lift_step) const;
+
+    /**@brief Number of BVH nodes
+     * @return number of nodes (0 if part is empty)
+     */
+    size_t numberOfNodes() const { return nodes_.size(); }
+
+  private:
+    /** @brief BVH node : leaf if count > 0 */
+    struct Node
+    {
+        /** @brief bounding box (min x, y, z then max x, y, z) */
+        float bounds[6];
+        /** @brief leaf : first triangle, inner node : index of second child (first child follows node) */
+        int index;
+        /** @brief number of triangles of leaf, 0 for inner nodes */
+        int count;
+    };
+
+    /**@brief Build BVH node of triangles [begin, end[ (recursive)
+     * @param[in] begin first triangle
+     * @param[in] end last triangle (excluded)
+     * @param[in] centroids triangle centroids
+     * @param[in, out] order triangle order
+     */
+    void build(int begin, int end, const std::vector<float> &centroids, std::vector<int> &order);
+
+    /**@brief Exact triangle / tool test in tool frame
+     * @param[in] vertices triangle vertices in tool frame
+     * @return true if triangle intersects tool volume
+     */
+    bool intersects(const Eigen::Vector3d vertices[3]) const;
+
+    /** @brief tool model */
+    BezierTool tool_;
+    /** @brief triangle vertices in BVH order (9 floats per triangle) */
+    std::vector<float> triangles_;
+    /** @brief BVH nodes (depth first order, root is first) */
+    std::vector<Node> nodes_;
+};
+
+#endif
@@ -0,0 +1,680 @@
+#ifndef BEZIER_IMPL_HPP
+#define BEZIER_IMPL_HPP
+
+#include <string>
+#include <vector>
+
+// PCL headers
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+
+// Eigen headers
+#include <Eigen/StdVector>
+#include <Eigen/Dense>
+
+// VTK headers
+#include <vtkSmartPointer.h>
+#include <vtkImageData.h>
+#include <vtkPolyData.h>
+#include <vtkStripper.h>
+
+#include <boost/scoped_ptr.hpp>
+
+#include "bezier_library/bezier_geometry.hpp"
+#include "bezier_library/bezier_gouge.hpp"
+#include "bezier_library/bezier_reachability.hpp"
+#include "bezier_library/bezier_normals.hpp"
+#include "bezier_library/bezier_point_cloud.hpp"
+#include "bezier_library/bezier_preview.hpp"
+#include "bezier_library/bezier_progress.hpp"
+
+/**
+ * @file bezier_impl.hpp
+ * @brief Implementation of the Bezier path generation (hidden behind bezier_library.hpp).
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ * @note This header is not included by bezier_library.hpp : only library sources (and tools needing internals) use it.
+ */
+
+class BezierMeshView;
+class BezierTiling;
+
+///@brief PointT is a pcl::PointXYZRGBA
+typedef pcl::PointXYZRGBA PointT;
+///@brief PointCloudT is a PointT cloud
+typedef pcl::PointCloud<PointT> PointCloudT;
+
+/** @brief BezierImpl holds the geometry pipeline of @ref Bezier (meshes, dilation, slicing and pose generation) */
+class BezierImpl
+{
+  public:
+
+    ///@brief Geometry kernels and line types at the compile-time precision (BezierScalar)
+    typedef BezierGeometry<BezierScalar> Geometry;
+
+    ///@brief Default Constructor
+    BezierImpl();
+
+    /**@brief Initialized constructor
+     * @param[in] filename_inputMesh filename of input poly data (input mesh)
+     * @param[in] filename_defaultMesh filename of default poly data (default mesh)
+     * @param[in] grind_depth grinding depth (in meters)
+     * @param[in] effector_diameter diameter of effector (in meters)
+     * @param[in] covering Percentage of covering (decimal value)
+     * @param[in] extrication_coefficiant extrication depth equal of how many grind_depth (coefficiant)
+     * @param[in] extrication_frequency new extrication mesh generated each 1/extrication_frequency times.
+     * @param[in] weld_tolerance welding distance (in meters) of mesh cleaning (see cleanMesh), 0 disables welding
+     */
+    BezierImpl(std::string filename_inputMesh, std::string filename_defaultMesh, double grind_depth, double effector_diameter, double covering, int extrication_coefficiant,int extrication_frequency,
+               double weld_tolerance = 0.00001);
+
+    /**@brief Sharing constructor : parameter independent work of source is reused (see @ref share)
+     * @param[in] source object whose meshes, normals, plane model, cut direction, distance field and passes are shared
+     * @param[in] grind_depth grinding depth (in meters)
+     * @param[in] effector_diameter diameter of effector (in meters)
+     * @param[in] covering Percentage of covering (decimal value)
+     * @param[in] extrication_coefficiant extrication depth equal of how many grind_depth (coefficiant)
+     * @param[in] extrication_frequency new extrication mesh generated each 1/extrication_frequency times.
+     */
+    BezierImpl(const BezierImpl &source, double grind_depth, double effector_diameter, double covering, int extrication_coefficiant, int extrication_frequency);
+
+    /**@brief Point cloud constructor : paths are generated on points, without meshing (see BezierPointCloud)
+     * @param[in] input_cloud input point cloud with outward normals
+     * @param[in] default_cloud default point cloud with outward normals
+     * @param[in] grind_depth grinding depth (in meters)
+     * @param[in] effector_diameter diameter of effector (in meters)
+     * @param[in] covering Percentage of covering (decimal value)
+     * @param[in] extrication_coefficiant extrication depth equal of how many grind_depth (coefficiant)
+     * @param[in] extrication_frequency new extrication mesh generated each 1/extrication_frequency times.
+     */
+    BezierImpl(const PointNormalCloudT &input_cloud, const PointNormalCloudT &default_cloud, double grind_depth, double effector_diameter,
+               double covering, int extrication_coefficiant, int extrication_frequency);
+
+    ~BezierImpl();
+
+    /**@brief generateTrajectory is the most important function of this library. This public function contains the process of 3D path generation.
+     * @param[out] way_points_vector in order to save robot poses.
+     * @param[out] color_vector in order to know if pose is an extrication pose or not (Use to display path)
+     * @param[out] index_vector in order to know index of start and end pose in each passe (Use to display path)
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool generateTrajectory(std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector, std::vector<bool> &color_vector, std::vector<int> &index_vector);
+
+    /**@brief public function used to save all dilated polydatas.
+     * @param[in] path it's the path of folder where we want saved polydatas.
+     * @return boolean flag reflects the function proceedings.
+     **/
+    bool saveDilatedMeshes (std::string path);
+
+    /**@brief public function used to get the private parameters @ref vector_dir_
+     * @return @ref vector_dir_
+     **/
+    Eigen::Vector3d get_vector_direction();
+
+    /**@brief public function used to set grinding parameters (see constructor).
+     * Passes are generated again by generateTrajectory only if grind depth changes.
+     * @param[in] grind_depth grinding depth (in meters)
+     * @param[in] effector_diameter diameter of effector (in meters)
+     * @param[in] covering Percentage of covering (decimal value)
+     * @param[in] extrication_coefficiant extrication depth equal of how many grind_depth (coefficiant)
+     * @param[in] extrication_frequency new extrication mesh generated each 1/extrication_frequency times.
+     **/
+    void set_parameters(double grind_depth, double effector_diameter, double covering, int extrication_coefficiant, int extrication_frequency);
+
+    /**@brief public function used to set the private parameters @ref stitch_gap_
+     * @param[in] gap maximal gap (in meters) bridged between fragments of a slice, 0 only joins touching fragments
+     **/
+    void set_stitch_gap(double gap);
+
+    /**@brief public function used to set the private parameters @ref tile_memory_budget_ and @ref parallel_tiles_.
+     * Distance fields and passes are generated again by the next generateTrajectory call.
+     * @param[in] memory_budget memory (in megabytes) available for tiles processed at once, 0 disables tiling
+     * @param[in] parallel_tiles number of tiles processed at once (1 : tiles are processed in sequence)
+     **/
+    void set_tiling(double memory_budget, int parallel_tiles);
+
+    /**@brief public function used to set the private parameters @ref cloud_band_width_ and @ref cloud_bin_length_
+     * @param[in] band_width width (in meters) of the band around each cutting plane, 0 : a tenth of the virtual effector diameter
+     * @param[in] bin_length length (in meters) of the bins along a slice, 0 : band width
+     **/
+    void set_point_cloud_slicing(double band_width, double bin_length);
+
+    /**@brief public function used to set the private parameters @ref resampling_chordal_tolerance_ and @ref resampling_angular_tolerance_
+     * @param[in] chordal_tolerance maximal chordal deviation (in meters), 0 (default) disables resampling
+     * @param[in] angular_tolerance maximal angular deviation of normals (in radians)
+     **/
+    void set_resampling_tolerances(double chordal_tolerance, double angular_tolerance);
+
+    /**@brief public function used to set the private parameters @ref smoothing_window_ and @ref smoothing_max_deviation_
+     * @param[in] window_length length (in meters) of the averaging window of normals, 0 disables smoothing
+     * @param[in] max_deviation maximal angle (in radians) between a smoothed normal and its raw normal
+     **/
+    void set_normal_smoothing(double window_length, double max_deviation);
+
+    /**@brief public function used to get peak angular rates of grind lines generated by the last generateTrajectory call
+     * @param[out] angular_rates peak angular rate (rad/m) of each grind line, in trajectory order
+     **/
+    void get_angular_rates(std::vector<double> &angular_rates);
+
+    /**@brief public function used to set the private parameters @ref resolution_. Distance fields and passes are generated again
+     * by the next generateTrajectory call (meshes are decimated first if needed, see prepare).
+     * @param[in] resolution quality level of path generation
+     **/
+    void set_resolution(const BezierResolution &resolution);
+
+    /**@brief Create an object planning the same part with the same parameters at another resolution (see sharing constructor) :
+     * meshes are shared until they are decimated. Robot model and gouge check are not carried.
+     * @param[in] resolution quality level of the new object
+     * @return new object (owned by caller)
+     */
+    BezierImpl *createPreview(const BezierResolution &resolution) const;
+
+    /**@brief public function used to enable the reachability stage (see @ref reachability_)
+     * @param[in] model kinematic model of robot
+     * @param[in] max_reorientation maximal rotation (in radians) around Z axis of unreachable poses, 0 only flags them
+     **/
+    void set_robot_model(const BezierRobotModel &model, double max_reorientation);
+
+    /**@brief public function used to get reachability of poses generated by the last generateTrajectory call
+     * @param[out] reachable_vector true if pose is reachable (same size as way_points_vector), empty if stage is disabled
+     **/
+    void get_reachability(std::vector<bool> &reachable_vector);
+
+    /**@brief public function used to enable the gouge check stage (see @ref gouge_check_)
+     * @param[in] enable true to check poses against input mesh
+     * @param[in] tolerance distance (in meters) between disk face and checked tool volume
+     * @param[in] max_tilt maximal tilt (in radians) of gouging poses, 0 disables tilting
+     * @param[in] max_lift maximal lift (in meters) of gouging poses, 0 disables lifting
+     **/
+    void set_gouge_check(bool enable, double tolerance, double max_tilt, double max_lift);
+
+    /**@brief public function used to get gouging poses of the last generateTrajectory call
+     * @param[out] gouge_indices for each passe, indices (in way_points_vector) of poses where tool cuts input mesh
+     **/
+    void get_gouges(std::vector<std::vector<int> > &gouge_indices);
+
+    /**@brief public function used to set the progress callback of generateTrajectory
+     * @param[in] callback progress callback (not owned, must outlive generateTrajectory calls), NULL disables progress report
+     **/
+    void set_progress_callback(BezierProgressCallback *callback);
+
+    /**@brief public function used to set the cancellation token of generateTrajectory
+     * @param[in] token cancellation token (not owned, must outlive generateTrajectory calls), NULL disables cancellation
+     **/
+    void set_cancellation_token(const BezierCancellationToken *token);
+
+    /**@brief public function used to set the deadline of generateTrajectory
+     * @param[in] deadline maximal duration (in seconds) of generateTrajectory, 0 disables deadline
+     **/
+    void set_deadline(double deadline);
+
+    /**@brief public function used to get the status of the last generateTrajectory call
+     * @return BEZIER_SUCCEEDED, BEZIER_FAILED, BEZIER_CANCELLED or BEZIER_DEADLINE_EXCEEDED
+     **/
+    BezierStatus get_status();
+
+    /**@brief public function used to get every setting that changes generated trajectories (see Bezier::get_settings)
+     * @return settings (one line of text)
+     **/
+    std::string get_settings();
+
+    /**@brief Compute point normals of meshes, mesh normal (RANSAC) and cut direction. These results only depend on meshes :
+     * they are computed once, by the first call. Meshes are decimated before when @ref resolution_ asks for it.
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool prepare();
+
+    /**@brief Generate passes (dilated meshes intersecting default mesh), from upper pass to input mesh.
+     * Passes only depend on meshes and grind depth : they are kept until grind depth changes.
+     * The distance field is extended to the deepest extrication mesh of these passes.
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool generatePasses();
+
+    /**@brief Estimate number of dilated passes (used to report progress of dilation) : largest distance between
+     * default mesh points and input mesh points, divided by grind depth.
+     * @return estimated number of dilated passes (input mesh excluded), 1 at least
+     */
+    int estimateNumberOfPasses();
+
+    /**@brief Load and clean a mesh (see loadPLYPolydata and cleanMesh)
+     * @param[in] filename string name of file. filename contains path and name of file
+     * @param[out] poly_data mesh loaded
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool loadMesh(std::string filename, vtkSmartPointer<vtkPolyData> &poly_data);
+
+    /**@brief Split default mesh into its connected components (one per defect region)
+     * @param[out] regions meshes of connected components (with 10 cells at least), point data are carried across
+     * @return false if default mesh has no region
+     */
+    bool splitDefaultMesh(std::vector<vtkSmartPointer<vtkPolyData> > &regions);
+
+    /**@brief Replace default mesh (input mesh work is kept). Point normals of the new default mesh are computed,
+     * passes are generated again by the next generateTrajectory call.
+     * @param[in] default_poly_data new default mesh
+     */
+    void set_default_mesh(vtkSmartPointer<vtkPolyData> default_poly_data);
+
+    /**@brief Compute dilated input meshes (before default intersection) for depths 1 to number_of_depths times grind depth,
+     * on a distance field deep enough for all of them. Dilations are kept (see @ref dilation_cache_) and can be shared
+     * (see shareDilations). Nothing is cached when dilation is tiled (memory budget).
+     * @param[in] number_of_depths number of dilation depths
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool cacheDilations(int number_of_depths);
+
+    /**@brief Use dilated input meshes and distance field of source (same input mesh and grind depth), see cacheDilations
+     * @param[in] source object whose dilations are shared
+     */
+    void shareDilations(const BezierImpl &source);
+
+  private:
+    /** @brief input mesh (points and normals only in point cloud mode) */
+    vtkSmartPointer<vtkPolyData> inputPolyData_;
+    /** @brief  default mesh */
+    vtkSmartPointer<vtkPolyData> defaultPolyData_;
+    /** @brief vector containing several dilated meshes */
+    std::vector<vtkSmartPointer<vtkPolyData> > dilationPolyDataVector_;
+    /** @brief grinding depth (in meters) */
+    double grind_depth_;
+    /** @brief extrication depth equal of how many grind_depth (coefficiant) */
+    int extrication_coefficiant_;
+    /** @brief new extrication mesh generated each 1/extrication_frequency times */
+    int extrication_frequency_;
+    /** @brief diameter of effector (in meters) */
+    double effector_diameter_;
+    /** @brief Percentage of covering (decimal value) */
+    double covering_;
+    /** @brief welding distance (in meters) of mesh cleaning, 0 disables welding */
+    double weld_tolerance_;
+    /** @brief maximal gap (in meters) bridged between fragments of a slice (see generateStripperOnSurface), 0 by default */
+    double stitch_gap_;
+    /** @brief maximal chordal deviation (in meters) of line resampling, 0 disables resampling */
+    double resampling_chordal_tolerance_;
+    /** @brief maximal angular deviation of normals (in radians) of line resampling, 0 disables resampling */
+    double resampling_angular_tolerance_;
+    /** @brief resampling results of the last generateTrajectory call */
+    Geometry::SimplificationReport resampling_report_;
+    /** @brief length (in meters) of the averaging window of normals, 0 disables smoothing */
+    double smoothing_window_;
+    /** @brief maximal angle (in radians) between a smoothed normal and its raw normal */
+    double smoothing_max_deviation_;
+    /** @brief smoothing results of the last generateTrajectory call */
+    Geometry::SmoothingReport smoothing_report_;
+    /** @brief peak angular rate (rad/m) of each grind line generated by the last generateTrajectory call */
+    std::vector<double> angular_rates_;
+    /** @brief quality level of path generation : mesh decimation, distance field samples and slice spacing */
+    BezierResolution resolution_;
+    /** @brief true once meshes are decimated (decimation is not undone) */
+    bool decimated_;
+    /** @brief reachability stage (closed-form inverse kinematics), null if disabled */
+    boost::scoped_ptr<BezierReachability> reachability_;
+    /** @brief maximal rotation (in radians) around Z axis used to re-orient unreachable poses */
+    double max_reorientation_;
+    /** @brief reachability of poses generated by the last generateTrajectory call */
+    std::vector<unsigned char> reachable_flags_;
+    /** @brief true if poses are checked against input mesh (tool cylinder : effector diameter, effector diameter long) */
+    bool gouge_check_;
+    /** @brief tool model of gouge check (radius and length set from @ref effector_diameter_) */
+    BezierTool gouge_tool_;
+    /** @brief maximal tilt (in radians) of gouging poses */
+    double gouge_max_tilt_;
+    /** @brief maximal lift (in meters) of gouging poses */
+    double gouge_max_lift_;
+    /** @brief for each passe, gouging poses of the last generateTrajectory call */
+    std::vector<std::vector<int> > gouge_indices_;
+    /** @brief true once point normals, mesh normal and cut direction are computed (see prepare) */
+    bool prepared_;
+    /** @brief grind depth of passes in @ref dilationPolyDataVector_ (0 if passes are not generated) */
+    double passes_depth_;
+    /** @brief distance to input mesh sampled on a grid, shared by all dilations when BezierResolution::shared_field is set (see distanceField) */
+    vtkSmartPointer<vtkImageData> distance_field_;
+    /** @brief maximal dilation depth (in meters) available in @ref distance_field_ */
+    double distance_field_depth_;
+    /** @brief grind depth used to choose the sample spacing of @ref distance_field_ */
+    double distance_field_grind_depth_;
+    /** @brief memory (in megabytes) available for tiles processed at once, 0 disables tiling (see set_tiling) */
+    double tile_memory_budget_;
+    /** @brief number of tiles processed at once */
+    int parallel_tiles_;
+    /** @brief distance fields of input mesh tiles (tiled dilation), used instead of @ref distance_field_ (same depth and spacing) */
+    std::vector<vtkSmartPointer<vtkImageData> > tile_fields_;
+    /** @brief dilated input meshes before default intersection : index k is depth (k + 1) * grind depth, null if not computed.
+     * Passes and extrication meshes use the same depths (see dilatation) */
+    std::vector<vtkSmartPointer<vtkPolyData> > dilation_cache_;
+    /** @brief grind depth of @ref dilation_cache_ */
+    double dilation_cache_grind_depth_;
+    /** @brief true if meshes are point clouds (no cells) : passes are offset clouds and slices are point bands */
+    bool point_cloud_;
+    /** @brief width (in meters) of the band around each cutting plane in point cloud mode, 0 : a tenth of the virtual effector diameter */
+    double cloud_band_width_;
+    /** @brief length (in meters) of the bins along a slice in point cloud mode, 0 : band width */
+    double cloud_bin_length_;
+    /** @brief normal mesh */
+    Eigen::Vector3d mesh_normal_vector_;
+    /** @brief Vector direction for slicing */
+    Eigen::Vector3d vector_dir_;
+    /** @brief point normals service (computes normals once per mesh version) */
+    BezierNormals normals_;
+    /** @brief progress report, cancellation and deadline of generateTrajectory */
+    BezierProgressTracker progress_;
+
+    ///@brief Function used to display some bezier library's parameters (effector diameter, grind depth and covering)
+    void printSelf();
+
+    /**@brief Share parameter independent work of source : meshes (with their normals), mesh normal and cut direction,
+     * distance field and passes (only if grind depths are the same). Meshes are shallow copies : VTK arrays are shared
+     * but each object owns its data objects, so that objects sharing a source can run their filters in parallel.
+     * @param[in] source object to share with (source should be prepared, see prepare)
+     */
+    void share(const BezierImpl &source);
+
+    /**@brief Path generation stages of generateTrajectory (passes, poses, gouge check and reachability).
+     * Stops as soon as progress_ requests it (cancellation or deadline).
+     * @param[out] way_points_vector robot poses
+     * @param[out] color_vector extrication flags of poses
+     * @param[out] index_vector index of last pose of each passe
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool generatePath(std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector, std::vector<bool> &color_vector, std::vector<int> &index_vector);
+
+    /** @brief Sampling grid of a distance field */
+    struct FieldSampling
+    {
+        /** @brief maximal dilation depth (in meters) */
+        double depth;
+        /** @brief model bounds : input mesh bounds enlarged by depth */
+        double bounds[6];
+        /** @brief number of samples along each axis */
+        int dimensions[3];
+        /** @brief distance between two samples along each axis (in meters) */
+        double spacing[3];
+        /** @brief distances are capped at this value (in meters) */
+        double maximum_distance;
+    };
+
+    /**@brief Get sampling grid of the distance field of input mesh, deep enough for a dilation depth (same policy as distanceField :
+     * cached depth is kept when it is deep enough, or at least doubled)
+     * @param[in] depth dilation depth (in meters)
+     * @param[out] sampling sampling grid
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool fieldSampling(double depth, FieldSampling &sampling);
+
+    /**@brief Restrict a sampling grid to the samples covering a box (tile fields sample the grid of the whole field)
+     * @param[in] sampling sampling grid of the whole field
+     * @param[in] box bounds (xmin, xmax, ymin, ymax, zmin, zmax) to cover
+     * @param[out] tile_sampling samples of the grid covering box
+     * @return false if box does not cover two samples along each axis
+     */
+    static bool tileSampling(const FieldSampling &sampling, const double box[6], FieldSampling &tile_sampling);
+
+    /**@brief Compute the distance field of input mesh for one dilation depth (resolution_.field_samples per axis, model bounds
+     * enlarged by depth, distances capped at twice the depth), when fields are not shared (see BezierResolution::shared_field)
+     * @param[in] depth dilation depth (in meters)
+     * @param[out] field distance to input mesh
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool depthField(double depth, vtkSmartPointer<vtkImageData> &field);
+
+    /**@brief Compute a distance field (vtkImplicitModeller) on a sampling grid
+     * @param[in] poly_data mesh
+     * @param[in] sampling sampling grid
+     * @return distance to mesh sampled on the grid
+     */
+    vtkSmartPointer<vtkImageData> computeField(vtkSmartPointer<vtkPolyData> poly_data, const FieldSampling &sampling);
+
+    /**@brief Get number of tiles of a mesh (see @ref set_tiling)
+     * @param[in] number_of_cells number of cells of mesh
+     * @return number of tiles, 1 if mesh is processed at once
+     */
+    int numberOfTiles(vtkIdType number_of_cells);
+
+    /**@brief Get tiling axis : slice line direction, so that tile borders cut every slice and fragments are stitched
+     * @return normalized tiling axis
+     */
+    Eigen::Vector3d tilingAxis();
+
+    /**@brief Select cells of an iso-surface of the distance field lying on the outer side of the mesh : the closest mesh point
+     * normal points towards the cell (morphological dilation is usually used on volume, not on surface).
+     * @param[in] input mesh (with point normals) whose distance field was sampled : input mesh or a tile of it
+     * @param[in] surface_view iso-surface of the distance field
+     * @param[in] tiling tiling of input mesh, NULL if input is the whole input mesh
+     * @param[in] tile index of tile (only cells of the tile core are kept)
+     * @param[out] keep_cells one flag per iso-surface triangle (non zero : triangle is kept)
+     * @param[out] outward_cells number of kept cells whose triangle ordering gives an outward normal
+     * @return false if mesh has no normals, or path generation has to stop (only checked without tiling)
+     */
+    bool selectOuterCells(vtkSmartPointer<vtkPolyData> input, const BezierMeshView &surface_view, const BezierTiling *tiling, int tile,
+                          std::vector<unsigned char> &keep_cells, long &outward_cells);
+
+    /**@brief Tiled dilation of input mesh (see dilatation) : each tile samples its part of the distance field grid with a margin
+     * wide enough for distances and closest points of its core to be the same as on the whole mesh. Iso-surfaces of tile cores
+     * are appended and welded. Tiles are processed @ref parallel_tiles_ at a time.
+     * @param[in] depth dilation depth (in meters)
+     * @param[out] dilate_poly_data dilated mesh
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool tiledDilatation(double depth, vtkSmartPointer<vtkPolyData> &dilate_poly_data);
+
+    /**@brief Get distance field of input mesh, deep enough for a dilation depth. The field is only computed again
+     * (twice deeper at least) when depth exceeds it, or when grind depth changes (sample spacing follows grind depth).
+     * @param[in] depth dilation depth (in meters)
+     * @param[out] field distance to input mesh sampled on a grid (vtkImplicitModeller)
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool distanceField(double depth, vtkSmartPointer<vtkImageData> &field);
+
+    /**@brief Dilation of input mesh (see computeDilatation). Dilations at multiples of grind depth are kept in @ref dilation_cache_
+     * (except tiled dilations) : a cached dilation is returned as a shallow copy.
+     * @param[in] depth depth for grind process (passe depth)
+     * @param[in] poly_data not used : input mesh (this->inputPolyData) is always dilated
+     * @param[out] dilate_poly_data dilate_poly_data is the result of input_poly_data (this->inputPolyData) dilation.
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool dilatation(double depth, vtkSmartPointer<vtkPolyData> poly_data, vtkSmartPointer<vtkPolyData> &dilate_poly_data);
+
+    /**@brief This function used vtkImplicitModeller in order to dilate inputpolydata surface (iso-surface of the field of this depth,
+     * see depthField, or of the shared distance field, see distanceField and BezierResolution::shared_field).
+     * When input mesh does not fit in memory budget (see @ref set_tiling), dilation is tiled (see tiledDilatation).
+     * @param[in] depth depth for grind process (passe depth)
+     * @param[out] dilate_poly_data dilate_poly_data is the result of input_poly_data (this->inputPolyData) dilation.
+     * @return boolean flag reflects the function proceedings.
+     * @bug dilation problem detected when depth is to high, dilated mesh has unexpected holes
+     * These holes are problematic. In fact, when cutting process is called on dilated mesh, slices are divided in some parts due to these holes
+     * and this affects the path generation, especially for extrical trajectory. We have to find a solution, perhaps find best parameters
+     * in order to resolve this problem.
+     */
+    bool computeDilatation(double depth, vtkSmartPointer<vtkPolyData> &dilate_poly_data);
+
+    /**@brief This function allows to optimize path generation. When passes are generated (dilation), we make an intersection between
+     * dilated mesh and default in order to only save useful part of mesh (for useful poses).
+     * @param[in, out] poly_data mesh generated after dilation and before intersection
+     * @return boolean flag reflects the function proceedings.
+     * @bug :Sometimes, unexpected part of mesh are save.
+     */
+    bool defaultIntersectionOptimisation(vtkSmartPointer<vtkPolyData> &poly_data);
+
+    /**@brief Convert a point cloud into a polydata without cells (points and normalized point normals)
+     * @param[in] cloud point cloud with normals (points with non finite position or normal are ignored)
+     * @return polydata of points and normals
+     */
+    static vtkSmartPointer<vtkPolyData> cloudToPolyData(const PointNormalCloudT &cloud);
+
+    /**@brief Dilation in point cloud mode : input cloud points are offset along their normals.
+     * Normals of offset cloud are reversed (oriented towards input cloud, like dilated meshes).
+     * @param[in] depth offset (in meters)
+     * @param[out] offset_poly_data offset cloud (points and normals)
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool offsetCloud(double depth, vtkSmartPointer<vtkPolyData> &offset_poly_data);
+
+    /**@brief Default intersection in point cloud mode (see defaultIntersectionOptimisation) : only points inside default cloud are kept
+     * @param[in, out] poly_data offset cloud
+     * @return true if some points are inside default cloud
+     */
+    bool defaultIntersectionCloud(vtkSmartPointer<vtkPolyData> &poly_data);
+
+    /**@brief Slicing in point cloud mode : points closer than half band width to a cutting plane are gathered, ordered along the
+     * slice direction (cut direction x mesh normal) and averaged in bins. Bins are projected on their plane, and a slice is broken
+     * in several polylines where bins are missing (holes in cloud).
+     * @param[in] poly_data cloud (points and normals)
+     * @param[in] origin origin of cutting planes
+     * @param[in] cut_dir normal of cutting planes (normalized)
+     * @param[in] number_of_slices number of cutting planes
+     * @param[in] min_value signed distance to origin of the first plane
+     * @param[in] max_value signed distance to origin of the last plane
+     * @return polylines with point normals (same layout as stripper output)
+     */
+    vtkSmartPointer<vtkPolyData> sliceCloud(vtkSmartPointer<vtkPolyData> poly_data, const double origin[3], const Eigen::Vector3d &cut_dir,
+                                            int number_of_slices, double min_value, double max_value);
+
+    /**@brief generateCellNormals function determines normal of cells in a mesh
+     * @param[in, out] &poly_data polydata in which normals are detected
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool generateCellNormals(vtkSmartPointer<vtkPolyData> &poly_data);
+
+    /**@brief generatePointNormals function determines normal of points in a mesh (area-weighted normals, see BezierNormals).
+     * Normals are only computed once per mesh version : calling this function again on an unmodified mesh costs nothing.
+     * @param[in, out] &poly_data polydata in which normals are detected
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool generatePointNormals(vtkSmartPointer<vtkPolyData> &poly_data);
+
+    /**@brief Function allows to load a Polydata from a PLY file
+     * @param[in] filename string name of file. filename contains path and name of file
+     * @param[out] poly_Data polydata loaded.
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool loadPLYPolydata(std::string filename, vtkSmartPointer<vtkPolyData> &poly_Data);
+
+    /**@brief Function used to clean a loaded mesh before normals and RANSAC : points closer than @ref weld_tolerance_ are welded,
+     * degenerate triangles and unused points are removed (see BezierMeshCleaner). A cleaning report is printed.
+     * @param[in, out] poly_data mesh to clean
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool cleanMesh(vtkSmartPointer<vtkPolyData> &poly_data);
+
+    /**@brief Function used to decimate a mesh (vtkQuadricDecimation) by the reduction of @ref resolution_. Small meshes are kept.
+     * @param[in, out] poly_data mesh to decimate
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool decimateMesh(vtkSmartPointer<vtkPolyData> &poly_data);
+
+    /**@brief Function allows to save a Polydata from a PLY file
+     * @param[in] filename string name of file. filename contains path and name of file
+     * @param[in] poly_data polydata we have to save.
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool savePLYPolyData(std::string filename, vtkSmartPointer<vtkPolyData> poly_data);
+
+    /**@brief This function is an application of Random Sample consensus theorem
+     * Goal is to find a plan model of our inputpolydata
+     * @note Threshold = max of inputpolydata dimensions in order to have a model of all point of inputpolydata
+     * Using inputPolyData as mesh reference and determines mesh_normal_vector, global normal of our mesh reference.
+     */
+    void ransac();
+
+    /** @brief Goal of generateDirection is to find a cut direction.
+     * This direction is automatically determined using mesh normal (ransac plan model equation).
+     * In fact, in this process we would like a cut direction orthogonal to the mesh normal (for grind reason).
+     * So, cut direction is a vector belong ransac plan model.
+     */
+    void generateDirection();
+
+    /**@brief calculate scalar product between cut direction and all points of polydata pointcloud,
+     * to get length to cut and to determine line_number expected. (difference between max & min results)
+     * @param[in] poly_data To get all points of mesh
+     * @param[in] vector_dir cut direction
+     * @return line_number expected to cut mesh with covering expected
+     */
+    unsigned int determineSliceNumberExpected(vtkSmartPointer<vtkPolyData> poly_data, Eigen::Vector3d vector_dir);
+
+    /**Intern cutMesh function used to return real line number, using scalar product between each
+     * line.point[0] and cut direction. In fact, if there are holes in polydata, line number returned by VTK is wrong.
+     * @param slices slice cut without organization
+     * @param vector_dir cut direction
+     * @return Real line number
+     */
+    unsigned int getRealSliceNumber(vtkSmartPointer<vtkPolyData> slices, Eigen::Vector3d vector_dir);
+
+    /**@brief The CutMesh function goal is to cut several slices in a VTKPolyData (Mesh type on VTK)
+     *        Planes are added until line_number_expected slices are found (holes merge or hide slices) :
+     *        cutting fails when planes are doubled or when path generation is cancelled.
+     * @param[in] PolyData This VtkPolyData represents the mesh we have to cut
+     * @param[in] line_number_expected Number of slices expected
+     * @param[in] cut_dir Eigen vector containing plan cut direction (x,y,z)
+     * @param[out] slices polylines (stripper output) of cutter results.
+     * @param[in] tiled if true, a mesh bigger than the memory budget is cut tile by tile (see @ref set_tiling) :
+     *            slices are broken at tile borders and fragments have to be stitched.
+     * @return boolean flag reflects the function proceedings.
+    */
+    bool cutMesh(vtkSmartPointer<vtkPolyData> PolyData, Eigen::Vector3d cut_dir, unsigned int line_number_expected, vtkSmartPointer<vtkPolyData> &slices, bool tiled);
+
+    /**@brief This function checks orientation of lines and compares them with a reference vector (cut_direction.dot(mesh_normal))
+     * So, all lines have the same direction.
+     * @param[in, out] lines lines is a vector containing several lines. Each line is a vector of pairs (first point position, second z normal)
+     * @return boolean flag reflects the function proceedings.
+    */
+    bool checkOrientation(Geometry::Lines &lines);
+
+    /**@brief removeNearNeighborPoints function is used to remove too close points in a point clouds.
+     * In fact, too close points could generate errors in vector spaces generation (vector normalization
+     * and division by 0). In order, to remove potential problems in trajectory generation (orientation
+     * of flange) removeNearNeighborPoints function reads point cloud and remove too close points.
+     * @param[in, out] &lines lines is a vector containing several lines. Each line is a vector of pairs (first point position, second z normal)
+    */
+    void removeNearNeighborPoints(Geometry::Lines &lines);
+
+    /**@brief Helped with z normals and point cloud, this function determines x and y normals
+     *        in order to generate the vector shape(robot pose).
+     * @param[in] point Eigen vector of point position
+     * @param[in] point_next Eigen vector of next point position
+     * @param[in] normal Eigen vector of point normal (z normal)
+     * @param[out] &pose Eigen affine matrix contains x,y,z normals and point position (robot pose)
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool generateRobotPoses(const Geometry::Vector3 &point, const Geometry::Vector3 &point_next, const Geometry::Vector3 &normal, Eigen::Affine3d &pose);
+
+    /**@brief The generateStripperClouds function is an important function in this path generation process.
+     *        It generates 3D trajectories on a mesh(vtkPolyData) with help of other functions.
+     *        So, it generates stripper clouds on a surface.
+     *        Process Mesh -> Cut mesh -> generate z normals and get point positions-> stitch fragments of a same plane
+     *        -> reorganized lines (order and orientations)-> remove too close points -> smooth normals -> resample lines
+     *        Normals are averaged along lines when @ref smoothing_window_ is set (see BezierGeometry::smoothNormals).
+     *        Lines are resampled under tolerances (see BezierGeometry::simplifyLines) : points stay dense on curved features only.
+     *        Holes in mesh break a slice in several fragments : fragments separated by less than @ref stitch_gap_ are joined,
+     *        so that each plane gives one line (and one extrication) instead of one per fragment.
+     * @param[in] PolyData This VtkPolyData represents the mesh we have to cut
+     * @param[out] lines lines is a vector containing several lines. Each line is a vector of pairs (first point position, second z normal)
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool generateStripperOnSurface(vtkSmartPointer<vtkPolyData> PolyData, Geometry::Lines &lines);
+
+    /**@brief Function used for extrication path. Extrication between two lines. It allows to find the closest extrication line of a point.
+     * @param[in] point_vector Eigen vector of point position
+     * @param[in] extrication_lines lines is a vector containing several lines. Each line is a vector of pairs (first point position, second z normal)
+     *                                  extrication_lines are lines generated on dilated (extrication) mesh.
+     * @return int value equal to index of closest line in extrication_lines vector.
+     */
+    int seekClosestLine(const Geometry::Vector3 &point_vector, const Geometry::Lines &extrication_lines);
+
+    /**@brief Function used for extrication path. Extrication between two lines. It allows to find the closest extrication point of a point in a line.
+     * @param[in] point_vector Eigen vector of point position
+     * @param[in] extrication_line Line is a vector of pairs (first point position, second z normal)
+     *                                  extrication_line are the closest line on the dilated (extrication) mesh.
+     * @return int value equal to index of closest point in extrication_line vector.
+     */
+    int seekClosestPoint(const Geometry::Vector3 &point_vector, const Geometry::Line &extrication_line);
+
+    /**@brief Function used for extrication path. Extrication between two passes. It allows to find the closest extrication point of a point in the last extrication line.
+     * @param[in] point_vector Eigen vector of point position
+     * @param[in] extrication_poses extrication poses is a vector containing all poses generated in the stripper between a passe i and a passe i+1.
+     * @return int value equal to index of closest point in extrication_poses vector.
+     */
+    int seekClosestExtricationPassPoint(const Geometry::Vector3 &point_vector, const Geometry::Poses &extrication_poses);
+};
+
+#endif
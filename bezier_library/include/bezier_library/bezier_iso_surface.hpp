@@ -0,0 +1,99 @@
+#ifndef BEZIER_ISO_SURFACE_HPP
+#define BEZIER_ISO_SURFACE_HPP
+
+#include <vector>
+
+// VTK headers
+#include <vtkSmartPointer.h>
+#include <vtkImageData.h>
+#include <vtkPolyData.h>
+
+/**
+ * @file bezier_iso_surface.hpp
+ * @brief Block-parallel iso-surface extraction (marching cubes) of distance fields.
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+/** @brief BezierIsoSurface extracts the iso-surface of a scalar field sampled on a regular grid (marching cubes).
+ *
+ * The grid is split in blocks of block_size^3 points. Blocks whose scalar range does not contain the iso value
+ * (most of a distance field) are skipped after one min/max pass. Active blocks are processed in parallel (OpenMP) :
+ * - cut grid edges are counted per block, block offsets give each surface vertex a unique index (vertices are shared
+ *   by the cells around their edge, no point merging is needed)
+ * - vertices are interpolated on cut edges, with normals from field gradient (optional)
+ * - triangles of each cell are emitted from the case table, per block, then concatenated in block order
+ * Output is a compact indexed triangle mesh. It does not depend on the number of threads.
+ *
+ * The case table is built from face rules : on each cube face, each crossing entering the iso-surface (scalar >= value)
+ * is joined with the next crossing leaving it, counterclockwise. Neighbour cells resolve ambiguous faces the same way,
+ * so the surface is closed (except on grid borders) and consistently oriented. Triangles are counterclockwise seen
+ * from decreasing scalars, like gradient normals (normal = -gradient).
+ */
+class BezierIsoSurface
+{
+  public:
+
+    /**@brief Constructor
+     * @param[in] block_size number of points along each side of a block (at least 2)
+     */
+    explicit BezierIsoSurface(int block_size = 8);
+
+    /**@brief public function used to enable point normals (normalized opposite of field gradient)
+     * @param[in] compute_normals true to compute normals, default is false
+     */
+    void set_compute_normals(bool compute_normals) { compute_normals_ = compute_normals; }
+
+    /**@brief Extract an iso-surface of a field
+     * @param[in] field scalar field (first component of point scalars)
+     * @param[in] value iso value
+     * @return compact triangle mesh (float points, normals in point data if enabled), empty if field has no scalars
+     */
+    vtkSmartPointer<vtkPolyData> extract(vtkSmartPointer<vtkImageData> field, double value);
+
+    /**@brief Extract an iso-surface of a field given as a contiguous array (x fastest, then y, then z)
+     * @param[in] scalars field values (dimensions[0] * dimensions[1] * dimensions[2] values)
+     * @param[in] dimensions number of points along each axis
+     * @param[in] origin position of first point
+     * @param[in] spacing distance between two points along each axis
+     * @param[in] value iso value
+     * @return boolean flag reflects the function proceedings (false if grid has less than 2 points along an axis).
+     * Results are read with points(), normals() and triangles().
+     */
+    bool extract(const float *scalars, const int dimensions[3], const double origin[3], const double spacing[3], float value);
+
+    ///@brief Point coordinates of last extraction (x0,y0,z0,x1...)
+    const std::vector<float> &points() const { return points_; }
+
+    ///@brief Point normals of last extraction (empty if normals are disabled)
+    const std::vector<float> &normals() const { return normals_; }
+
+    ///@brief Triangle point ids of last extraction (3 ids per triangle)
+    const std::vector<long> &triangles() const { return triangles_; }
+
+    ///@brief Number of blocks of last extraction
+    long numberOfBlocks() const { return number_of_blocks_; }
+
+    ///@brief Number of blocks containing the iso-surface in last extraction (others were skipped)
+    long numberOfActiveBlocks() const { return number_of_active_blocks_; }
+
+  private:
+    /** @brief number of points along each side of a block */
+    int block_size_;
+    /** @brief true if point normals are computed */
+    bool compute_normals_;
+    /** @brief point coordinates of last extraction */
+    std::vector<float> points_;
+    /** @brief point normals of last extraction */
+    std::vector<float> normals_;
+    /** @brief triangle point ids of last extraction */
+    std::vector<long> triangles_;
+    /** @brief surface vertex of each cut grid edge (3 edges per grid point : +x, +y, +z), only valid on cut edges */
+    std::vector<long> edge_vertices_;
+    /** @brief number of blocks of last extraction */
+    long number_of_blocks_;
+    /** @brief number of blocks containing the iso-surface in last extraction */
+    long number_of_active_blocks_;
+};
+
+#endif
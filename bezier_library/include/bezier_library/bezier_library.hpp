@@ -1,75 +1,16 @@
 #ifndef BEZIER_LIBRARY_HPP
 #define BEZIER_LIBRARY_HPP
 
-#include <iostream>
-#include <string.h>
-#include <limits>
-
-// PCL headers
-#include <pcl/common/common.h>
-#include <pcl/console/parse.h>
-#include <pcl/filters/filter.h> //removeNan
-#include <pcl/io/ply_io.h>
-#include <pcl/io/vtk_lib_io.h>
-#include <pcl/kdtree/kdtree_flann.h> //Kdtree
-#include <pcl/PCLPointCloud2.h>
-#include <pcl/PolygonMesh.h>
-#include <pcl/visualization/pcl_visualizer.h>
-#include <pcl_conversions/pcl_conversions.h>
-#include <pcl/point_types.h>
-#include <pcl/console/print.h>
-#include <pcl/io/vtk_lib_io.h>
-#include <pcl/ModelCoefficients.h>
-#include <pcl/sample_consensus/method_types.h>
-#include <pcl/sample_consensus/model_types.h>
-#include <pcl/segmentation/sac_segmentation.h>
-#include <pcl/sample_consensus/ransac.h>
-#include <pcl/sample_consensus/sac_model_plane.h>
-
-#include <pcl/surface/vtk_smoothing/vtk_utils.h>
+#include <string>
+#include <vector>
 
 // Eigen headers
-#include <eigen_conversions/eigen_msg.h>
 #include <Eigen/StdVector>
-#include <Eigen/Dense>
-
-// VTK headers
-#include <vtkVersion.h>
-#include <vtkSmartPointer.h>
-#include <vtkPLYReader.h>
-#include <vtkPolyDataMapper.h>
-#include <vtkPolyData.h>
-#include <vtkPlane.h>
-#include <vtkCutter.h>
-#include <vtkProperty.h>
-#include <vtkMath.h>
-#include <vtkInteractorStyleRubberBandPick.h>
-#include <vtkTriangleFilter.h>
-#include <vtkStripper.h>
-#include <vtkCellData.h>
-#include <vtkPoints.h>
-#include <vtkCellArray.h>
-#include <vtkGlyph3D.h>
-#include <vtkArrowSource.h>
-#include <vtkImplicitModeller.h>
-#include <vtkMarchingCubes.h>
-#include <vtkKdTreePointLocator.h>
-#include <vtkIdList.h>
-#include <vtkPLYWriter.h>
-#include <vtkPolyDataNormals.h>
-#include <vtkSortDataArray.h>
-#include <vtkDoubleArray.h>
-#include <vtkCellArray.h>
-
-// ROS headers
-#include <ros/ros.h>
-#include <ros/package.h>
-#include <visualization_msgs/Marker.h>
-#include <tf/transform_listener.h>
-#include <tf_conversions/tf_eigen.h>
-#include <visualization_msgs/MarkerArray.h>
-
-#include <boost/lexical_cast.hpp>
+#include <Eigen/Geometry>
+
+#include <boost/scoped_ptr.hpp>
+
+#include "bezier_library/bezier_progress.hpp"
 
 /**
  * @file bezier_library.hpp
@@ -98,14 +39,38 @@
  * For each dilated mesh, we use the VTK function VtkCutter to cut several slices in mesh.
  * Then, we get all point normals on these slices (polylines) in order generate vector spaces and to set flange orientation.
  * Last, we execute trajectory with ROS and display some markers in RVIZ.
+ *
+ * The library is split in two targets :
+ * - bezier_library : path generation core (VTK, PCL, Eigen), no ROS dependency. Public header is bezier_library.hpp,
+ *   implementation is hidden behind a pointer (see BezierImpl in bezier_impl.hpp).
+ * - bezier_library_ros : ROS adapter used to display meshes, trajectories and normals in RVIZ (see bezier_display.hpp).
+ *
+ * Several parameter sets of one part can be compared with BezierSweep (bezier_sweep.hpp) : meshes, normals, plane model,
+ * distance field and passes are shared between sets.
+ *
+ * Parts with several separate defects are planned in one job with BezierRegions (bezier_regions.hpp) : input mesh work
+ * and dilations are shared, regions run in parallel and come out in travel order.
+ *
+ * Scanned parts can be planned without meshing with BezierPointCloud (bezier_point_cloud.hpp) : slices are gathered
+ * from points close to each cutting plane and passes are offsets of the input cloud along its normals.
+ *
+ * Generated trajectories and execution progress can be saved with BezierCheckpoint (bezier_checkpoint.hpp) :
+ * after a stop, execution resumes at the first passe not completed, without generating paths again.
+ *
+ * Noisy normals can be averaged along lines (Bezier::set_normal_smoothing) within a maximal deviation, and the peak
+ * angular rate of each grind line is reported (Bezier::get_angular_rates) to choose feed rates.
+ *
+ * Operators get a quick preview with BezierPreview (bezier_preview.hpp) : a coarse trajectory (decimated meshes, coarse distance field,
+ * fewer slices) is generated within a time budget, then replaced by the full quality trajectory refined in background.
  */
 
-///@brief PointT is a pcl::PointXYZRGBA
-typedef pcl::PointXYZRGBA PointT;
-///@brief PointCloudT is a PointT cloud
-typedef pcl::PointCloud<PointT> PointCloudT;
+class BezierImpl;
+struct BezierResolution;
+struct BezierRobotModel;
 
-/** @brief Bezier */
+/** @brief Bezier generates grinding paths (robot poses) from an input mesh and a default mesh.
+ * @note Only Eigen, Boost and standard headers are needed to use this class : VTK and PCL stay in the library sources.
+ */
 class Bezier
 {
   public:
@@ -121,18 +86,21 @@ class Bezier
      * @param[in] covering Percentage of covering (decimal value)
      * @param[in] extrication_coefficiant extrication depth equal of how many grind_depth (coefficiant)
      * @param[in] extrication_frequency new extrication mesh generated each 1/extrication_frequency times.
+     * @param[in] weld_tolerance points of loaded meshes closer than this distance (in meters) are welded, default is 0.01 mm.
+     * 0 disables welding (degenerate triangles and unused points are still removed)
      */
-    Bezier(std::string filename_inputMesh, std::string filename_defaultMesh, double grind_depth, double effector_diameter, double covering, int extrication_coefficiant,int extrication_frequency);
-    //Bezier(polydatapointer, polydatapointer, double grind_depth, double effector_diameter, double covering);
-    //Bezier(polygonMesh, polygonMesh, double grind_depth, double effector_diameter, double covering);
+    Bezier(std::string filename_inputMesh, std::string filename_defaultMesh, double grind_depth, double effector_diameter, double covering, int extrication_coefficiant,int extrication_frequency,
+           double weld_tolerance = 0.00001);
 
-    ~Bezier();
+    ///@brief Destructor (virtual : derived objects such as BezierPreview can be deleted through a Bezier pointer)
+    virtual ~Bezier();
 
     /**@brief generateTrajectory is the most important function of this library. This public function contains the process of 3D path generation.
      * @param[out] way_points_vector in order to save robot poses.
      * @param[out] color_vector in order to know if pose is an extrication pose or not (Use to display path)
      * @param[out] index_vector in order to know index of start and end pose in each passe (Use to display path)
-     * @return boolean flag reflects the function proceedings.
+     * @return boolean flag reflects the function proceedings. False if path generation was cancelled or exceeded its deadline
+     * (outputs are cleared, see get_status).
      */
     bool generateTrajectory(std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector, std::vector<bool> &color_vector, std::vector<int> &index_vector);
 
@@ -142,202 +110,148 @@ class Bezier
      **/
     bool saveDilatedMeshes (std::string path);
 
-    /**@brief public function used to get the private parameters @ref vector_dir_
-     * @return @ref vector_dir_
+    /**@brief public function used to get the slicing direction
+     * @return cut direction (determined by generateTrajectory)
      **/
     Eigen::Vector3d get_vector_direction();
 
-    /**@brief public function used to display normals in RVIZ
-     * @param[in] way_points_vector vector containing robot poses
-     * @param[in] points_color_viz it's a bool vector using to distinguish real path and extrication path
-     * @param[out] &normal_publisher publisher used to display normals in RVIZ
-     * @note Boolean vector and trajectory vector need to have same sizes.
+    /**@brief public function used to change grinding parameters of a loaded part (see constructor), so that the same object
+     * (meshes, normals, plane model) plans several parameter sets. Passes are only generated again if grind depth changes.
+     * @param[in] grind_depth grinding depth (in meters)
+     * @param[in] effector_diameter diameter of effector (in meters)
+     * @param[in] covering Percentage of covering (decimal value)
+     * @param[in] extrication_coefficiant extrication depth equal of how many grind_depth (coefficiant)
+     * @param[in] extrication_frequency new extrication mesh generated each 1/extrication_frequency times.
      **/
-    void displayNormal( std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > way_points_vector, std::vector<bool> points_color_viz, ros::Publisher &normal_publisher);
-
+    void set_parameters(double grind_depth, double effector_diameter, double covering, int extrication_coefficiant, int extrication_frequency);
 
-    /**@brief Generate a trajectory (LINE_STRIP) marker and publish it.
-     * @param[in] way_points_vector 3D trajectory vector (containing poses)
-     * @param[in] points_color_viz it's a bool vector using to distinguish real path and extrication path
-     * @param[out] &trajectory_publisher reference to a ros publisher used to display trajectory marker
-     * @note Boolean vector and trajectory vector need to have same sizes.
-     */
-    void displayTrajectory(std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > way_points_vector, std::vector<bool> points_color_viz, ros::Publisher &trajectory_publisher);
+    /**@brief public function used to set the maximal gap bridged between fragments of a slice
+     * (a slice broken by mesh holes is joined in one line when its gaps are small enough).
+     * @param[in] gap maximal gap (in meters), default is 0 : only touching fragments are joined.
+     * Wider gaps (e.g. the effector diameter) bridge holes : the tool then grinds across them
+     **/
+    void set_stitch_gap(double gap);
+
+    /**@brief public function used to plan parts bigger than available memory. Input mesh is split in tiles along slice lines :
+     * dilation and slicing work tile by tile (with overlap margins), then slice fragments are stitched across tile borders
+     * (ends closer than 1e-6 m are joined, even if the stitch gap is 0). Paths match in-core paths within regression
+     * tolerances (see regression_check --tiling), not bit for bit.
+     * @param[in] memory_budget memory (in megabytes) available for tiles processed at once, default is 0 (tiling disabled)
+     * @param[in] parallel_tiles number of tiles processed at once (OpenMP threads), default is 1
+     **/
+    void set_tiling(double memory_budget, int parallel_tiles);
+
+    /**@brief public function used to set slicing of point clouds (see BezierPointCloud in bezier_point_cloud.hpp) :
+     * points closer than half band width to a cutting plane belong to its slice, and are averaged in bins along the slice.
+     * Ignored when planning on meshes.
+     * @param[in] band_width width (in meters) of the band around each cutting plane, 0 (default) is a tenth of the virtual effector
+     * diameter (effector diameter without covering)
+     * @param[in] bin_length length (in meters) of the bins along a slice (distance between line points), 0 (default) is band width
+     **/
+    void set_point_cloud_slicing(double band_width, double bin_length);
 
-    /**@brief public function used to display mesh in RVIZ
-     * @param[in] mesh_path path of mesh
-     * @param[out] &mesh_publisher publisher used to display the mesh in RVIZ
+    /**@brief public function used to set resampling tolerances. Lines are simplified after slicing : points are removed while
+     * the line (and its normals) stays within tolerances, so flat regions carry few poses and curved features keep dense poses.
+     * Resampling is disabled by default (both tolerances are 0) : lines keep every slicing point.
+     * @param[in] chordal_tolerance maximal chordal deviation (in meters), e.g. 0.2 mm. 0 disables resampling
+     * @param[in] angular_tolerance maximal angular deviation of normals (in radians), e.g. 2 degrees. 0 disables resampling
      **/
-    void displayMesh(ros::Publisher &mesh_publisher, std::string mesh_path);
+    void set_resampling_tolerances(double chordal_tolerance, double angular_tolerance);
 
-  private:
-    /** @brief input mesh */
-    vtkSmartPointer<vtkPolyData> inputPolyData_;
-    /** @brief  default mesh */
-    vtkSmartPointer<vtkPolyData> defaultPolyData_;
-    /** @brief vector containing several dilated meshes */
-    std::vector<vtkSmartPointer<vtkPolyData> > dilationPolyDataVector_;
-    /** @brief grinding depth (in meters) */
-    double grind_depth_;
-    /** @brief extrication depth equal of how many grind_depth (coefficiant) */
-    int extrication_coefficiant_;
-    /** @brief new extrication mesh generated each 1/extrication_frequency times */
-    int extrication_frequency_;
-    /** @brief diameter of effector (in meters) */
-    double effector_diameter_;
-    /** @brief Percentage of covering (decimal value) */
-    double covering_;
-    /** @brief normal mesh */
-    Eigen::Vector3d mesh_normal_vector_;
-    /** @brief Vector direction for slicing */
-    Eigen::Vector3d vector_dir_;
-
-    ///@brief Function used to display some bezier library's parameters (effector diameter, grind depth and covering)
-    void printSelf();
-
-    /**@brief This function used vtkImplicitModeller in order to dilate inputpolydata surface.
-     * @param[in] depth depth for grind process (passe depth)
-     * @param[in] polydata Polydata we would like to dilate
-     * @param[out] dilate_poly_data dilate_poly_data is the result of input_poly_data (this->inputPolyData) dilation.
-     * @return boolean flag reflects the function proceedings.
-     * @bug dilation problem detected when depth is to high, dilated mesh has unexpected holes
-     * These holes are problematic. In fact, when cutting process is called on dilated mesh, slices are divided in some parts due to these holes
-     * and this affects the path generation, especially for extrical trajectory. We have to find a solution, perhaps find best parameters
-     * in order to resolve this problem.
-     */
-    bool dilatation(double depth, vtkSmartPointer<vtkPolyData> poly_data,vtkSmartPointer<vtkPolyData> &dilate_poly_data);
+    /**@brief public function used to enable the reachability stage : generated poses are checked with the closed-form inverse
+     * kinematics of the robot (see BezierReachability in bezier_reachability.hpp) and unreachable poses are re-oriented around
+     * their Z axis (tool axis) when possible. Disabled by default.
+     * @param[in] model kinematic model of robot (joint limits, tool)
+     * @param[in] max_reorientation maximal rotation (in radians) around Z axis of unreachable poses, 0 only flags them
+     **/
+    void set_robot_model(const BezierRobotModel &model, double max_reorientation);
 
-    /**@brief This function allows to optimize path generation. When passes are generated (dilation), we make an intersection between
-     * dilated mesh and default in order to only save useful part of mesh (for useful poses).
-     * @param[in, out] poly_data mesh generated after dilation and before intersection
-     * @return boolean flag reflects the function proceedings.
-     * @bug :Sometimes, unexpected part of mesh are save.
-     */
-    bool defaultIntersectionOptimisation(vtkSmartPointer<vtkPolyData> &poly_data);
+    /**@brief public function used to get reachability of poses generated by the last generateTrajectory call
+     * @param[out] reachable_vector true if pose is reachable (same size as way_points_vector), empty if stage is disabled
+     **/
+    void get_reachability(std::vector<bool> &reachable_vector);
+
+    /**@brief public function used to enable the gouge check stage : the tool (cylinder of effector diameter) is tested at every
+     * pose against the input mesh (see BezierGougeCheck in bezier_gouge.hpp). Gouging poses can be tilted or lifted. Disabled by default.
+     * @param[in] enable true to check poses
+     * @param[in] tolerance distance (in meters) between disk face and checked tool volume (contact allowance)
+     * @param[in] max_tilt maximal tilt (in radians) of gouging poses, 0 only reports them
+     * @param[in] max_lift maximal lift (in meters) of gouging poses, 0 only reports them
+     **/
+    void set_gouge_check(bool enable, double tolerance = 0.0005, double max_tilt = 0, double max_lift = 0);
 
-    /**@brief generateCellNormals function determines normal of cells in a mesh
-     * @param[in, out] &poly_data polydata in which normals are detected
-     * @return boolean flag reflects the function proceedings.
-     */
-    bool generateCellNormals(vtkSmartPointer<vtkPolyData> &poly_data);
+    /**@brief public function used to get gouging poses of the last generateTrajectory call
+     * @param[out] gouge_indices for each passe, indices (in way_points_vector) of poses where the tool still cuts the input mesh
+     **/
+    void get_gouges(std::vector<std::vector<int> > &gouge_indices);
 
-    /**@brief generatePointNormals function determines normal of points in a mesh
-     * @param[in, out] &poly_data polydata in which normals are detected
-     * @return boolean flag reflects the function proceedings.
-     */
-    bool generatePointNormals(vtkSmartPointer<vtkPolyData> &poly_data);
+    /**@brief public function used to enable normal smoothing. Normals of scanned or noisy meshes give jittery tool orientations :
+     * each normal is averaged with the normals of its line within a window (arc length), and stays within max_deviation of its raw normal.
+     * @param[in] window_length length (in meters) of the averaging window, default is 0 (smoothing disabled)
+     * @param[in] max_deviation maximal angle (in radians) between a smoothed normal and its raw normal
+     **/
+    void set_normal_smoothing(double window_length, double max_deviation);
 
-    /**@brief Function allows to load a Polydata from a PLY file
-     * @param[in] filename string name of file. filename contains path and name of file
-     * @param[out] poly_Data polydata loaded.
-     * @return boolean flag reflects the function proceedings.
-     */
-    bool loadPLYPolydata(std::string filename, vtkSmartPointer<vtkPolyData> &poly_Data);
+    /**@brief public function used to get peak angular rates of grind lines generated by the last generateTrajectory call.
+     * A rate multiplied by the feed rate gives the angular velocity required along the line : feed rate can be raised up to
+     * the angular velocity limit of the controller divided by the peak rate.
+     * @param[out] angular_rates peak angular rate (rad/m) of each grind line, in trajectory order
+     **/
+    void get_angular_rates(std::vector<double> &angular_rates);
 
-    /**@brief Function allows to save a Polydata from a PLY file
-     * @param[in] filename string name of file. filename contains path and name of file
-     * @param[in] poly_data polydata we have to save.
-     * @return boolean flag reflects the function proceedings.
-     */
-    bool savePLYPolyData(std::string filename, vtkSmartPointer<vtkPolyData> poly_data);
+    /**@brief public function used to set the quality level of path generation (see BezierResolution in bezier_preview.hpp) :
+     * mesh decimation, distance field samples and slice spacing. Passes are generated again by the next generateTrajectory call.
+     * Meshes are decimated once (point clouds are not) : a lower reduction set afterwards does not restore them.
+     * @param[in] resolution quality level, default is full quality
+     **/
+    void set_resolution(const BezierResolution &resolution);
 
-    /**@brief This function is an application of Random Sample consensus theorem
-     * Goal is to find a plan model of our inputpolydata
-     * @note Threshold = max of inputpolydata dimensions in order to have a model of all point of inputpolydata
-     * Using inputPolyData as mesh reference and determines mesh_normal_vector, global normal of our mesh reference.
-     */
-    void ransac();
+    /**@brief public function used to follow generateTrajectory : the callback receives stage, current passe, estimated
+     * fraction done and remaining time (see BezierProgress in bezier_progress.hpp). It is called in the calling thread.
+     * @param[in] callback progress callback (not owned, must outlive generateTrajectory calls), NULL disables progress report
+     **/
+    void set_progress_callback(BezierProgressCallback *callback);
 
-    /** @brief Goal of generateDirection is to find a cut direction.
-     * This direction is automatically determined using mesh normal (ransac plan model equation).
-     * In fact, in this process we would like a cut direction orthogonal to the mesh normal (for grind reason).
-     * So, cut direction is a vector belong ransac plan model.
-     */
-    void generateDirection();
+    /**@brief public function used to stop generateTrajectory from another thread : generateTrajectory checks the token
+     * in its inner loops and returns false soon after cancel() is called.
+     * @param[in] token cancellation token (not owned, must outlive generateTrajectory calls), NULL disables cancellation
+     **/
+    virtual void set_cancellation_token(const BezierCancellationToken *token);
 
-    /**@brief calculate scalar product between cut direction and all points of polydata pointcloud,
-     * to get length to cut and to determine line_number expected. (difference between max & min results)
-     * @param[in] poly_data To get all points of mesh
-     * @param[in] vector_dir cut direction
-     * @return line_number expected to cut mesh with covering expected
-     */
-    unsigned int determineSliceNumberExpected(vtkSmartPointer<vtkPolyData> poly_data, Eigen::Vector3d vector_dir);
+    /**@brief public function used to bound the duration of generateTrajectory
+     * @param[in] deadline maximal duration (in seconds) of generateTrajectory, 0 (default) disables deadline
+     **/
+    void set_deadline(double deadline);
 
-    /**Intern cutMesh function used to return real line number, using scalar product between each
-     * line.point[0] and cut direction. In fact, if there are holes in polydata, line number returned by VTK is wrong.
-     * @param stripper slice cut without organization
-     * @param vector_dir cut direction
-     * @return Real line number
-     */
-    unsigned int getRealSliceNumber(vtkSmartPointer<vtkStripper> stripper, Eigen::Vector3d vector_dir);
+    /**@brief public function used to get the status of the last generateTrajectory call
+     * @return BEZIER_SUCCEEDED, BEZIER_FAILED, BEZIER_CANCELLED or BEZIER_DEADLINE_EXCEEDED
+     **/
+    BezierStatus get_status();
 
-    /**@brief The CutMesh function goal is to cut several slices in a VTKPolyData (Mesh type on VTK)
-     * @param[in] PolyData This VtkPolyData represents the mesh we have to cut
-     * @param[in] line_number_expected Number of slices expected
-     * @param[in] cut_dir Eigen vector containing plan cut direction (x,y,z)
-     * @param[out] stripper Reference on a vtkstripper smartPointer used to get cutter results.
-     * @return boolean flag reflects the function proceedings.
-    */
-    bool cutMesh(vtkSmartPointer<vtkPolyData> PolyData, Eigen::Vector3d cut_dir, unsigned int line_number_expected, vtkSmartPointer<vtkStripper> &stripper);
+    /**@brief public function used to get every setting that changes generated trajectories : engine version, grinding parameters,
+     * welding, stitching, resampling, smoothing, resolution (distance field sampling, decimation, slice spacing), tiling,
+     * point cloud slicing, gouge check and reachability (robot model included).
+     * Cached trajectories are identified with these settings (see BezierCheckpoint::trajectoryId).
+     * @return settings (one line of text)
+     **/
+    std::string get_settings();
 
-    /**@brief This function checks orientation of lines and compares them with a reference vector (cut_direction.dot(mesh_normal))
-     * So, all lines have the same direction.
-     * @param[in, out] lines lines is a vector containing several lines. Each line is a vector of pairs (first point position, second z normal)
-     * @return boolean flag reflects the function proceedings.
-    */
-    bool checkOrientation(std::vector<std::vector<std::pair<Eigen::Vector3d, Eigen::Vector3d> > > &lines);
-
-    /**@brief removeNearNeighborPoints function is used to remove too close points in a point clouds.
-     * In fact, too close points could generate errors in vector spaces generation (vector normalization
-     * and division by 0). In order, to remove potential problems in trajectory generation (orientation
-     * of flange) removeNearNeighborPoints function reads point cloud and remove too close points.
-     * @param[in, out] &lines lines is a vector containing several lines. Each line is a vector of pairs (first point position, second z normal)
-    */
-    void removeNearNeighborPoints(std::vector<std::vector<std::pair<Eigen::Vector3d, Eigen::Vector3d> > > &lines);
-
-    /**@brief Helped with z normals and point cloud, this function determines x and y normals
-     *        in order to generate the vector shape(robot pose).
-     * @param[in] point Eigen vector of point position
-     * @param[in] point_next Eigen vector of next point position
-     * @param[in] normal Eigen vector of point normal (z normal)
-     * @param[out] &pose Eigen affine matrix contains x,y,z normals and point position (robot pose)
-     * @return boolean flag reflects the function proceedings.
+  protected:
+    /**@brief Constructor used by specialized front ends (see BezierPointCloud)
+     * @param[in] impl path generation implementation (owned)
      */
-    bool generateRobotPoses(Eigen::Vector3d point, Eigen::Vector3d point_next, Eigen::Vector3d normal, Eigen::Affine3d &pose);
-
-    /**@brief The generateStripperClouds function is an important function in this path generation process.
-     *        It generates 3D trajectories on a mesh(vtkPolyData) with help of other functions.
-     *        So, it generates stripper clouds on a surface.
-     *        Process Mesh -> Cut mesh -> generate z normals and get point positions-> reorganized lines (order and orientations)-> remove too close points
-     * @param[in] PolyData This VtkPolyData represents the mesh we have to cut
-     * @param[out] lines lines is a vector containing several lines. Each line is a vector of pairs (first point position, second z normal)
-     * @return boolean flag reflects the function proceedings.
-     */
-    bool generateStripperOnSurface(vtkSmartPointer<vtkPolyData> PolyData, std::vector<std::vector<std::pair<Eigen::Vector3d, Eigen::Vector3d> > > &lines);
+    explicit Bezier(BezierImpl *impl);
 
-    /**@brief Function used for extrication path. Extrication between two lines. It allows to find the closest extrication line of a point.
-     * @param[in] point_vector Eigen vector of point position
-     * @param[in] extrication_lines lines is a vector containing several lines. Each line is a vector of pairs (first point position, second z normal)
-     *                                  extrication_lines are lines generated on dilated (extrication) mesh.
-     * @return int value equal to index of closest line in extrication_lines vector.
-     */
-    int seekClosestLine(Eigen::Vector3d point_vector, std::vector<std::vector<std::pair<Eigen::Vector3d, Eigen::Vector3d> > > extrication_lines);
+    ///@brief Path generation implementation, used by specialized front ends (see BezierPreview)
+    BezierImpl &get_impl() { return *impl_; }
 
-    /**@brief Function used for extrication path. Extrication between two lines. It allows to find the closest extrication point of a point in a line.
-     * @param[in] point_vector Eigen vector of point position
-     * @param[in] extrication_line Line is a vector of pairs (first point position, second z normal)
-     *                                  extrication_line are the closest line on the dilated (extrication) mesh.
-     * @return int value equal to index of closest point in extrication_line vector.
-     */
-    int seekClosestPoint(Eigen::Vector3d point_vector, std::vector<std::pair<Eigen::Vector3d, Eigen::Vector3d> > extrication_line);
+  private:
+    // Non copyable
+    Bezier(const Bezier &);
+    Bezier &operator=(const Bezier &);
 
-    /**@brief Function used for extrication path. Extrication between two passes. It allows to find the closest extrication point of a point in the last extrication line.
-     * @param[in] point_vector Eigen vector of point position
-     * @param[in] extrication_poses extrication poses is a vector containing all poses generated in the stripper between a passe i and a passe i+1.
-     * @return int value equal to index of closest point in extrication_poses vector.
-     */
-    int seekClosestExtricationPassPoint(Eigen::Vector3d point_vector, std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > extrication_poses);
+    /** @brief path generation implementation */
+    boost::scoped_ptr<BezierImpl> impl_;
 };
 
 #endif
-
@@ -0,0 +1,76 @@
+#ifndef BEZIER_MESH_CLEANING_HPP
+#define BEZIER_MESH_CLEANING_HPP
+
+#include <vector>
+
+// VTK headers
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+/**
+ * @file bezier_mesh_cleaning.hpp
+ * @brief Mesh preprocessing : vertex welding (spatial hashing), degenerate triangles removal and compaction.
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+/** @brief Statistics of a mesh cleaning */
+struct BezierMeshCleaningReport
+{
+    ///@brief Default constructor (all counters set to 0)
+    BezierMeshCleaningReport();
+
+    ///@brief Print report on standard output
+    void print() const;
+
+    /** @brief number of points before cleaning */
+    long input_points;
+    /** @brief number of triangles before cleaning (polygons are fan-triangulated) */
+    long input_triangles;
+    /** @brief number of points merged with another point (duplicate or near-duplicate points) */
+    long merged_points;
+    /** @brief number of points dropped because no triangle references them anymore */
+    long unused_points;
+    /** @brief number of triangles removed (collapsed by welding or null area) */
+    long degenerate_triangles;
+    /** @brief number of points after cleaning */
+    long output_points;
+    /** @brief number of triangles after cleaning */
+    long output_triangles;
+    /** @brief cleaning duration (in milliseconds) */
+    double time;
+};
+
+/** @brief BezierMeshCleaner welds duplicate and near-duplicate vertices of scanned meshes and removes degenerate triangles.
+ *
+ * Points are hashed in a uniform grid whose cell size equals the welding tolerance, so each point is only compared
+ * with points of its 27 neighbor cells (near-linear time). Neighbor searches and triangle tests run in parallel (OpenMP).
+ * Close pairs are joined with a union-find : results do not depend on the number of threads, and a group of merged points
+ * is represented by its smallest point id.
+ */
+class BezierMeshCleaner
+{
+  public:
+
+    /**@brief Find a representative for each point : points closer than tolerance share the same representative.
+     * @param[in] points contiguous point coordinates (x0,y0,z0,x1...)
+     * @param[in] number_of_points number of points in array
+     * @param[in] tolerance welding distance (in meters)
+     * @param[out] representative one point id per point. representative[i] == i if point i is kept.
+     * @return number of merged points
+     * @note Merge is transitive (union-find over all pairs closer than tolerance) : a chain of points spaced less than tolerance
+     * is welded to a single point, even if its ends are further apart.
+     */
+    static long weldVertices(const float *points, long number_of_points, double tolerance, std::vector<long> &representative);
+
+    /**@brief Clean a mesh : weld vertices, remove degenerate triangles and drop unused points.
+     * Point data (normals...) of representatives are carried across. Output contains triangles only.
+     * @param[in, out] poly_data mesh to clean
+     * @param[in] tolerance welding distance (in meters)
+     * @param[out] report cleaning statistics
+     * @return boolean flag reflects the function proceedings.
+     */
+    static bool clean(vtkSmartPointer<vtkPolyData> &poly_data, double tolerance, BezierMeshCleaningReport &report);
+};
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef BEZIER_MESH_VIEW_HPP
+#define BEZIER_MESH_VIEW_HPP
+
+#include <vector>
+
+// VTK headers
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+/**
+ * @file bezier_mesh_view.hpp
+ * @brief Read-only flat view of a triangle mesh (vtkPolyData) used in hot loops.
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+/** @brief BezierMeshView exposes vertex coordinates, triangle indices and point normals of a vtkPolyData as contiguous arrays.
+ *
+ * The view is built once per polydata. When VTK arrays already have the expected layout (float points, float normals,
+ * polygons containing triangles only) no copy is made and the view points directly into VTK memory.
+ * Otherwise, data are converted once into buffers owned by the view.
+ * Accessors are inlined and do not go through VTK virtual dispatch (GetCell, GetPoint...).
+ * @note The view is read-only : the polydata must not be modified while the view is used.
+ */
+class BezierMeshView
+{
+  public:
+
+    /**@brief Build a view on a polydata
+     * @param[in] poly_data mesh to view. Only polygons are considered, they are fan-triangulated if needed.
+     */
+    explicit BezierMeshView(vtkSmartPointer<vtkPolyData> poly_data);
+
+    ///@brief Number of points (vertices) in the mesh
+    vtkIdType numberOfPoints() const { return number_of_points_; }
+
+    ///@brief Number of triangles in the mesh
+    vtkIdType numberOfTriangles() const { return number_of_triangles_; }
+
+    ///@brief Contiguous point coordinates (x0,y0,z0,x1,y1,z1...)
+    const float *points() const { return points_; }
+
+    ///@brief Coordinates (x,y,z) of a point
+    const float *point(vtkIdType point_id) const { return points_ + 3 * point_id; }
+
+    ///@brief Ids of the three points of a triangle
+    const vtkIdType *triangle(vtkIdType triangle_id) const { return triangles_ + triangle_stride_ * triangle_id + triangle_offset_; }
+
+    ///@brief Id (in polydata cell data) of the polygon a triangle comes from
+    vtkIdType cell(vtkIdType triangle_id) const
+    {
+        return first_polygon_cell_ + (triangle_cells_.empty() ? triangle_id : triangle_cells_[triangle_id]);
+    }
+
+    ///@brief True if the polydata has point normals
+    bool hasNormals() const { return normals_ != NULL; }
+
+    ///@brief Contiguous point normals (nx0,ny0,nz0...) or NULL
+    const float *normals() const { return normals_; }
+
+    ///@brief Normal (x,y,z) of a point
+    const float *normal(vtkIdType point_id) const { return normals_ + 3 * point_id; }
+
+    ///@brief True if no VTK array has been copied to build the view
+    bool isZeroCopy() const { return points_copy_.empty() && triangles_copy_.empty() && normals_copy_.empty(); }
+
+    ///@brief Viewed polydata
+    vtkSmartPointer<vtkPolyData> polyData() const { return poly_data_; }
+
+    /**@brief Build a new compact mesh with a subset of triangles.
+     * Points which are not referenced by a kept triangle are dropped, connectivity is remapped
+     * and point data (normals...) are carried across. Points keep the precision of the viewed polydata (float or double),
+     * and each kept triangle carries the cell data of the polygon it comes from.
+     * @param[in] keep one flag per triangle (non zero : triangle is kept)
+     * @return compact polydata
+     */
+    vtkSmartPointer<vtkPolyData> extractTriangles(const std::vector<unsigned char> &keep) const;
+
+    /**@brief Build a new compact mesh with a subset of triangles, after merging points.
+     * Each point id of a kept triangle is replaced by its representative (merged points share the same representative)
+     * so that the new mesh only contains representatives referenced by kept triangles. Point precision and cell data are
+     * carried as above.
+     * @param[in] keep one flag per triangle (non zero : triangle is kept)
+     * @param[in] representative one point id per point (representative of its group of merged points)
+     * @return compact polydata
+     */
+    vtkSmartPointer<vtkPolyData> extractTriangles(const std::vector<unsigned char> &keep, const std::vector<long> &representative) const;
+
+  private:
+    /** @brief viewed polydata (keeps VTK arrays alive) */
+    vtkSmartPointer<vtkPolyData> poly_data_;
+    /** @brief number of points */
+    vtkIdType number_of_points_;
+    /** @brief number of triangles */
+    vtkIdType number_of_triangles_;
+    /** @brief point coordinates (VTK memory or points_copy_) */
+    const float *points_;
+    /** @brief triangle connectivity (VTK memory or triangles_copy_) */
+    const vtkIdType *triangles_;
+    /** @brief distance between two triangles in triangles_ (4 in VTK cell array, 3 in triangles_copy_) */
+    int triangle_stride_;
+    /** @brief offset of first point id of a triangle in triangles_ (1 in VTK cell array : skip point count) */
+    int triangle_offset_;
+    /** @brief point normals (VTK memory or normals_copy_), NULL if no normals */
+    const float *normals_;
+    /** @brief converted point coordinates when VTK points are not float */
+    std::vector<float> points_copy_;
+    /** @brief triangulated connectivity when polygons are not all triangles */
+    std::vector<vtkIdType> triangles_copy_;
+    /** @brief converted normals when VTK normals are not float */
+    std::vector<float> normals_copy_;
+    /** @brief polygon index of each triangle when polygons are fan-triangulated (empty : triangle index is polygon index) */
+    std::vector<vtkIdType> triangle_cells_;
+    /** @brief cell id of the first polygon (vertices and lines come first in polydata cell ids) */
+    vtkIdType first_polygon_cell_;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef BEZIER_NORMALS_HPP
+#define BEZIER_NORMALS_HPP
+
+#include <vector>
+
+// VTK headers
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+#include <vtkPolyData.h>
+
+class BezierMeshView;
+
+/**
+ * @file bezier_normals.hpp
+ * @brief Cached, parallel point normals computation.
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+/** @brief BezierNormals computes area-weighted point normals from flat mesh arrays (BezierMeshView) and caches them.
+ *
+ * Each point normal is the normalized sum of the (non normalized) normals of its triangles, so that big triangles weigh more.
+ * Triangle normals and point normals are computed in parallel (OpenMP).
+ * Normals are stored in the polydata point data ("Normals" array), so slicing (vtkCutter) interpolates them on slices.
+ * A mesh is only processed once per version : as long as the polydata is not modified (VTK modification time),
+ * compute() returns immediately.
+ * Like vtkPolyDataNormals (consistency on), triangles are first consistently oriented : orientation is propagated
+ * across manifold edges so that neighbours traverse their shared edge in opposite directions.
+ * Each connected component keeps the orientation of the majority of its triangles ordering.
+ * @note Points are never split on sharp edges (unlike vtkPolyDataNormals splitting) : slicing needs one normal per point.
+ */
+class BezierNormals
+{
+  public:
+
+    ///@brief Default Constructor
+    BezierNormals();
+
+    /**@brief Compute point normals of a mesh if they are not already cached for this mesh version
+     * @param[in, out] poly_data mesh in which normals are computed
+     * @param[in] flip if true, normals are reversed (opposite of the majority triangle ordering orientation)
+     * @return boolean flag reflects the function proceedings.
+     */
+    bool compute(vtkSmartPointer<vtkPolyData> poly_data, bool flip = false);
+
+    /**@brief Compute area-weighted point normals (no cache)
+     * @param[in] view flat view of mesh
+     * @param[in] flip if true, normals are reversed
+     * @param[out] normals contiguous point normals (nx0,ny0,nz0...), null vector for isolated points
+     */
+    static void areaWeightedNormals(const BezierMeshView &view, bool flip, float *normals);
+
+    /**@brief Orient triangles consistently within each connected component (no cache)
+     * @param[in] view flat view of mesh
+     * @param[out] signs +1 if triangle ordering is kept, -1 if it is reversed
+     */
+    static void consistentOrientation(const BezierMeshView &view, std::vector<signed char> &signs);
+
+    ///@brief Forget all cached meshes
+    void clear();
+
+    ///@brief Number of normals passes done since construction (cached calls excluded)
+    unsigned long numberOfComputations() const { return number_of_computations_; }
+
+  private:
+    /** @brief Cached mesh version */
+    struct CacheEntry
+    {
+        /** @brief mesh (weak : cache does not keep meshes alive) */
+        vtkWeakPointer<vtkPolyData> poly_data;
+        /** @brief modification time of mesh after normals computation */
+        unsigned long mtime;
+        /** @brief orientation of normals */
+        bool flip;
+    };
+    /** @brief cached meshes */
+    std::vector<CacheEntry> cache_;
+    /** @brief number of normals passes */
+    unsigned long number_of_computations_;
+};
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef BEZIER_PASS_VIEW_HPP
+#define BEZIER_PASS_VIEW_HPP
+
+#include <algorithm>
+#include <vector>
+
+// Eigen headers
+#include <Eigen/StdVector>
+#include <Eigen/Geometry>
+
+/**
+ * @file bezier_pass_view.hpp
+ * @brief Read-only view of the poses of one passe (no copy of the trajectory).
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+/** @brief BezierPassView gives access to the poses and colors of one passe of a generated trajectory, in place.
+ *
+ * Poses of passe i are way_points_vector[index_vector[i] + 1] to way_points_vector[index_vector[i + 1]] (excluded, as passes
+ * have always been executed), with index_vector from Bezier::generateTrajectory. The view holds pointers to the trajectory
+ * vectors : they must outlive the view and must not be resized while it is used.
+ */
+class BezierPassView
+{
+  public:
+    ///@brief Vector of robot poses
+    typedef std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > Poses;
+    ///@brief Iterator on poses of the passe
+    typedef Poses::const_iterator const_iterator;
+
+    /**@brief Constructor : view of one passe
+     * @param[in] way_points_vector robot poses
+     * @param[in] color_vector true for grind poses, false for extrication poses
+     * @param[in] index_vector index of last pose of each passe (first value -1)
+     * @param[in] passe passe index (between 0 and numberOfPasses(index_vector) - 1)
+     */
+    BezierPassView(const Poses &way_points_vector, const std::vector<bool> &color_vector, const std::vector<int> &index_vector, int passe) :
+            poses_(&way_points_vector), colors_(&color_vector), begin_(index_vector[passe] + 1), end_(index_vector[passe + 1])
+    {
+    }
+
+    /**@brief Constructor : view of a whole trajectory
+     * @param[in] way_points_vector robot poses
+     * @param[in] color_vector true for grind poses, false for extrication poses
+     */
+    BezierPassView(const Poses &way_points_vector, const std::vector<bool> &color_vector) :
+            poses_(&way_points_vector), colors_(&color_vector), begin_(0), end_(way_points_vector.size())
+    {
+    }
+
+    /**@brief Get number of passes of a trajectory
+     * @param[in] index_vector index of last pose of each passe (first value -1)
+     * @return number of passes
+     */
+    static int numberOfPasses(const std::vector<int> &index_vector)
+    {
+        return index_vector.empty() ? 0 : (int)index_vector.size() - 1;
+    }
+
+    /** @brief number of poses in passe */
+    size_t size() const { return end_ - begin_; }
+    /** @brief true if passe has no pose */
+    bool empty() const { return end_ == begin_; }
+    /** @brief index of first pose of passe in the trajectory */
+    size_t offset() const { return begin_; }
+    /** @brief pose i of passe */
+    const Eigen::Affine3d &pose(size_t i) const { return (*poses_)[begin_ + i]; }
+    /** @brief color of pose i of passe (true for grind poses) */
+    bool color(size_t i) const { return (*colors_)[begin_ + i]; }
+    /** @brief first pose of passe */
+    const_iterator begin() const { return poses_->begin() + begin_; }
+    /** @brief end of passe */
+    const_iterator end() const { return poses_->begin() + end_; }
+
+    /**@brief Check reachability of the passe
+     * @param[in] reachable_vector reachability of each pose of the trajectory (empty if not checked)
+     * @return false if a pose of the passe is unreachable
+     */
+    bool reachable(const std::vector<bool> &reachable_vector) const
+    {
+        if (reachable_vector.empty())
+            return true;
+        return std::find(reachable_vector.begin() + begin_, reachable_vector.begin() + end_, false) == reachable_vector.begin() + end_;
+    }
+
+  private:
+    /** @brief poses of the trajectory */
+    const Poses *poses_;
+    /** @brief colors of the trajectory */
+    const std::vector<bool> *colors_;
+    /** @brief index of first pose of passe */
+    size_t begin_;
+    /** @brief index after last pose of passe */
+    size_t end_;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef BEZIER_POINT_CLOUD_HPP
+#define BEZIER_POINT_CLOUD_HPP
+
+// PCL headers
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+
+#include "bezier_library/bezier_library.hpp"
+
+/**
+ * @file bezier_point_cloud.hpp
+ * @brief Path generation directly on scanned point clouds (no meshing).
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+///@brief PointNormalT is a pcl::PointNormal (position and normal)
+typedef pcl::PointNormal PointNormalT;
+///@brief PointNormalCloudT is a PointNormalT cloud
+typedef pcl::PointCloud<PointNormalT> PointNormalCloudT;
+
+/** @brief BezierPointCloud generates grinding paths from an input point cloud and a default point cloud, without meshing.
+ *
+ * Process is the same as @ref Bezier, on points instead of triangles :
+ * - passes are the input cloud offset along its normals (by multiples of grind depth), restricted to points inside the default cloud
+ * - slices are the points within a band around each cutting plane, ordered along the slice and averaged in bins (polylines)
+ * - slice fragments are stitched like mesh slices broken by holes (see Bezier::set_stitch_gap)
+ *
+ * Slices are ordered by their projection on the slice direction : this mode is meant for near-planar parts.
+ * Normals of both clouds must point outwards (towards the scanner). Gouge check needs triangles : it is skipped in this mode.
+ * Band width and bin length are set with Bezier::set_point_cloud_slicing.
+ */
+class BezierPointCloud : public Bezier
+{
+  public:
+
+    /**@brief Initialized constructor (clouds are copied, points with non finite position or normal are ignored)
+     * @param[in] input_cloud input point cloud (surface to grind) with normals
+     * @param[in] default_cloud default point cloud (surface of the defect) with normals
+     * @param[in] grind_depth grinding depth (in meters)
+     * @param[in] effector_diameter diameter of effector (in meters)
+     * @param[in] covering Percentage of covering (decimal value)
+     * @param[in] extrication_coefficiant extrication depth equal of how many grind_depth (coefficiant)
+     * @param[in] extrication_frequency new extrication mesh generated each 1/extrication_frequency times.
+     */
+    BezierPointCloud(const PointNormalCloudT &input_cloud, const PointNormalCloudT &default_cloud, double grind_depth,
+                     double effector_diameter, double covering, int extrication_coefficiant, int extrication_frequency);
+};
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef BEZIER_PREVIEW_HPP
+#define BEZIER_PREVIEW_HPP
+
+#include <string>
+#include <vector>
+
+// Eigen headers
+#include <Eigen/StdVector>
+#include <Eigen/Geometry>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "bezier_library/bezier_library.hpp"
+
+/**
+ * @file bezier_preview.hpp
+ * @brief Coarse-to-fine path generation : quick preview trajectory, then full quality refinement in background.
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+/** @brief Quality level of path generation (see Bezier::set_resolution). Default values are full quality. */
+struct BezierResolution
+{
+    ///@brief Default Constructor : full quality (meshes are not decimated, one 50x50x50 field per dilation depth, vtkMarchingCubes,
+    /// slices at virtual effector diameter)
+    BezierResolution() : mesh_reduction(0), field_samples(50), max_field_samples(100), slice_spacing(1), shared_field(false),
+                         block_iso_surface(false) {}
+
+    /**@brief Preview quality : 80 % of triangles removed, one shared field with half the samples per side (an eighth of full
+     * quality samples), block-parallel iso-surfaces and twice the slice spacing
+     * @return preview resolution
+     */
+    static BezierResolution preview()
+    {
+        BezierResolution resolution;
+        resolution.mesh_reduction = 0.8;
+        resolution.field_samples = 25;
+        resolution.max_field_samples = 50;
+        resolution.slice_spacing = 2;
+        resolution.shared_field = true;
+        resolution.block_iso_surface = true;
+        return resolution;
+    }
+
+    /** @brief fraction of triangles removed from meshes (quadric decimation) before normals are computed, 0 keeps meshes */
+    double mesh_reduction;
+    /** @brief number of distance field samples along each axis of a dilation field. With @ref shared_field, number of samples
+     * along each side of the first pass box (input mesh bounds enlarged by grind depth) */
+    int field_samples;
+    /** @brief maximal number of samples along each axis of the shared field (deeper fields keep the spacing of the first pass) */
+    int max_field_samples;
+    /** @brief distance between slices, in virtual effector diameters (effector diameter without covering) */
+    double slice_spacing;
+    /** @brief false : every dilation depth gets its own field of field_samples per axis (as always).
+     * true : one field, at the sample spacing of the first pass, is reused by deeper passes. Deep passes are then sampled
+     * more coarsely (capped by max_field_samples) and dilated meshes differ. Tiled dilation always uses the shared field. */
+    bool shared_field;
+    /** @brief false : dilated meshes are extracted with vtkMarchingCubes (as always).
+     * true : they are extracted with BezierIsoSurface (block-parallel, empty blocks skipped). Vertices match vtkMarchingCubes
+     * within a thousandth of the sample spacing, triangles of ambiguous cells may differ (see iso_surface_benchmark). */
+    bool block_iso_surface;
+};
+
+/** @brief BezierPreview gives the operator an approximate trajectory within a time budget, then refines it at full quality.
+ *
+ * generatePreview runs path generation at preview resolution (see BezierResolution::preview) on shallow copies of the meshes,
+ * bounded by a deadline. Full quality path generation (this object, with all Bezier settings) then starts in a background thread :
+ * the preview is replaced when refinement is over (see waitRefinement and getRefinedTrajectory).
+ *
+ * While refinement runs, only refinement functions (waitRefinement, refinementFinished, getRefinedTrajectory, cancelRefinement
+ * and get_refinement_status) may be called. The progress callback (see Bezier::set_progress_callback) follows refinement and is
+ * called from the refinement thread. Refinement has its own cancellation token (see cancelRefinement) : set_cancellation_token
+ * is overridden and keeps it. Robot model and gouge check are only used by refinement.
+ */
+class BezierPreview : public Bezier
+{
+  public:
+
+    /**@brief Initialized constructor (see Bezier)
+     * @param[in] filename_inputMesh filename of input poly data (input mesh)
+     * @param[in] filename_defaultMesh filename of default poly data (default mesh)
+     * @param[in] grind_depth grinding depth (in meters)
+     * @param[in] effector_diameter diameter of effector (in meters)
+     * @param[in] covering Percentage of covering (decimal value)
+     * @param[in] extrication_coefficiant extrication depth equal of how many grind_depth (coefficiant)
+     * @param[in] extrication_frequency new extrication mesh generated each 1/extrication_frequency times.
+     * @param[in] weld_tolerance welding distance (in meters) of loaded meshes, 0 disables welding
+     */
+    BezierPreview(std::string filename_inputMesh, std::string filename_defaultMesh, double grind_depth, double effector_diameter,
+                  double covering, int extrication_coefficiant, int extrication_frequency, double weld_tolerance = 0.00001);
+
+    ///@brief Destructor : cancels refinement and waits for its thread
+    ~BezierPreview();
+
+    /**@brief Refinement keeps its own cancellation token : use cancelRefinement to stop it. Other tokens are ignored.
+     * @param[in] token cancellation token (ignored)
+     **/
+    void set_cancellation_token(const BezierCancellationToken *token);
+
+    /**@brief public function used to set the resolution of preview trajectories
+     * @param[in] resolution preview resolution, default is BezierResolution::preview()
+     **/
+    void set_preview_resolution(const BezierResolution &resolution);
+
+    /**@brief Generate a preview trajectory within a time budget, then start full quality refinement in background.
+     * A running refinement is cancelled first.
+     * @param[out] way_points_vector preview robot poses
+     * @param[out] color_vector extrication flags of preview poses
+     * @param[out] index_vector index of last pose of each preview passe
+     * @param[in] time_budget maximal duration (in seconds) of preview, 0 disables the budget
+     * @return false if preview failed or exceeded its budget (outputs are cleared) : refinement is started anyway.
+     */
+    bool generatePreview(std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector, std::vector<bool> &color_vector,
+                         std::vector<int> &index_vector, double time_budget);
+
+    /**@brief Wait for the end of refinement
+     * @param[in] timeout maximal wait (in seconds), negative waits until refinement is over
+     * @return true if refinement is over (or was never started), false on timeout
+     */
+    bool waitRefinement(double timeout);
+
+    /**@brief public function used to check the end of refinement without waiting
+     * @return true if refinement is over (or was never started)
+     */
+    bool refinementFinished();
+
+    /**@brief public function used to get the full quality trajectory
+     * @param[out] way_points_vector robot poses
+     * @param[out] color_vector extrication flags of poses
+     * @param[out] index_vector index of last pose of each passe
+     * @return false if refinement is running, failed or was cancelled (outputs are left unchanged)
+     */
+    bool getRefinedTrajectory(std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector,
+                              std::vector<bool> &color_vector, std::vector<int> &index_vector);
+
+    ///@brief Cancel refinement and wait for its thread (nothing is done if refinement is over)
+    void cancelRefinement();
+
+    /**@brief public function used to get the status of refinement
+     * @return BEZIER_RUNNING while refinement runs, then BEZIER_SUCCEEDED, BEZIER_FAILED, BEZIER_CANCELLED or BEZIER_DEADLINE_EXCEEDED
+     * (BEZIER_FAILED if refinement was never started)
+     **/
+    BezierStatus get_refinement_status();
+
+  private:
+    ///@brief Refinement thread : full quality path generation
+    void refine();
+
+    /** @brief resolution of preview trajectories */
+    BezierResolution preview_resolution_;
+    /** @brief cancellation token of refinement */
+    BezierCancellationToken refinement_token_;
+    /** @brief robot poses of refinement */
+    std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > refined_way_points_;
+    /** @brief extrication flags of refinement poses */
+    std::vector<bool> refined_colors_;
+    /** @brief index of last pose of each refinement passe */
+    std::vector<int> refined_indices_;
+    /** @brief status of refinement */
+    BezierStatus refinement_status_;
+    /** @brief true while refinement runs */
+    bool refining_;
+    /** @brief mutex protecting refinement results, refinement_status_ and refining_ */
+    boost::mutex mutex_;
+    /** @brief condition used to wake waitRefinement */
+    boost::condition_variable condition_;
+    /** @brief refinement thread */
+    boost::thread thread_;
+};
+
+#endif
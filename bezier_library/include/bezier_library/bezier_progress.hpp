@@ -0,0 +1,176 @@
+#ifndef BEZIER_PROGRESS_HPP
+#define BEZIER_PROGRESS_HPP
+
+#include <boost/atomic.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+/**
+ * @file bezier_progress.hpp
+ * @brief Progress report, cancellation and deadline of path generation.
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+/** @brief Stages of path generation (in order) */
+enum BezierStage
+{
+    BEZIER_STAGE_PREPARATION, ///< normals, plane model and cut direction
+    BEZIER_STAGE_DILATION, ///< passes generation (dilated meshes)
+    BEZIER_STAGE_PASSES, ///< slicing, poses and extrications of each passe
+    BEZIER_STAGE_GOUGE_CHECK, ///< tool against input mesh
+    BEZIER_STAGE_REACHABILITY, ///< inverse kinematics of poses
+    BEZIER_STAGE_DONE ///< path generation is over (see status)
+};
+
+/** @brief Status of path generation */
+enum BezierStatus
+{
+    BEZIER_RUNNING,
+    BEZIER_SUCCEEDED,
+    BEZIER_FAILED,
+    BEZIER_CANCELLED, ///< cancellation token was cancelled
+    BEZIER_DEADLINE_EXCEEDED ///< deadline was reached
+};
+
+/** @brief Progress of path generation, sent to @ref BezierProgressCallback */
+struct BezierProgress
+{
+    /** @brief current stage */
+    BezierStage stage;
+    /** @brief status (BEZIER_RUNNING until stage is BEZIER_STAGE_DONE) */
+    BezierStatus status;
+    /** @brief current passe (generated passes during dilation), -1 if stage does not work on passes */
+    int passe;
+    /** @brief number of passes (estimated during dilation) */
+    int number_of_passes;
+    /** @brief estimated fraction of work done (between 0 and 1) */
+    double fraction;
+    /** @brief elapsed time (in seconds) */
+    double elapsed_time;
+    /** @brief estimated remaining time (in seconds), negative if unknown */
+    double remaining_time;
+};
+
+/** @brief Progress callback interface : implement progress() to follow path generation (HMI progress bar...) */
+class BezierProgressCallback
+{
+  public:
+    virtual ~BezierProgressCallback() {}
+
+    /**@brief Called by path generation, in the calling thread, on stage changes and when progress moves by 0.5 % at least.
+     * The last call has stage BEZIER_STAGE_DONE and the final status. This function should return quickly.
+     * @param[in] progress current progress
+     */
+    virtual void progress(const BezierProgress &progress) = 0;
+};
+
+/** @brief Cooperative cancellation token : cancel() can be called from any thread, path generation stops at its next check
+ * and returns false (outputs are cleared). */
+class BezierCancellationToken
+{
+  public:
+    ///@brief Default Constructor : not cancelled
+    BezierCancellationToken() : cancelled_(false) {}
+
+    ///@brief Request cancellation (thread safe)
+    void cancel() { cancelled_.store(true, boost::memory_order_relaxed); }
+
+    ///@brief Clear cancellation request, before a new path generation
+    void reset() { cancelled_.store(false, boost::memory_order_relaxed); }
+
+    ///@brief Check cancellation request (thread safe)
+    bool cancelled() const { return cancelled_.load(boost::memory_order_relaxed); }
+
+  private:
+    // Non copyable
+    BezierCancellationToken(const BezierCancellationToken &);
+    BezierCancellationToken &operator=(const BezierCancellationToken &);
+
+    /** @brief cancellation request */
+    boost::atomic<bool> cancelled_;
+};
+
+/** @brief BezierProgressTracker is used by path generation to report progress and to check cancellation and deadline.
+ *
+ * Stages have fixed weights in the overall fraction. keepGoing() is cheap enough for inner loops :
+ * the token is read at each call, the clock once every 64 calls.
+ */
+class BezierProgressTracker
+{
+  public:
+    ///@brief Default Constructor : no callback, no token, no deadline
+    BezierProgressTracker();
+
+    /**@brief Set progress callback
+     * @param[in] callback progress callback (not owned), NULL disables progress report
+     */
+    void set_callback(BezierProgressCallback *callback) { callback_ = callback; }
+
+    /**@brief Set cancellation token
+     * @param[in] token cancellation token (not owned), NULL disables cancellation
+     */
+    void set_token(const BezierCancellationToken *token) { token_ = token; }
+
+    /**@brief Set deadline
+     * @param[in] deadline maximal duration (in seconds) of path generation, 0 disables deadline
+     */
+    void set_deadline(double deadline) { deadline_ = deadline > 0 ? deadline : 0; }
+
+    /**@brief Start a path generation : clock starts, status is BEZIER_RUNNING.
+     * Out of a path generation (before start or after finish), nothing is reported and keepGoing always returns true.
+     */
+    void start();
+
+    /**@brief Begin a stage (always reported)
+     * @param[in] stage new stage
+     * @param[in] number_of_passes number of passes (estimated during dilation)
+     * @return false if path generation has to stop (cancelled or deadline exceeded)
+     */
+    bool stage(BezierStage stage, int number_of_passes);
+
+    /**@brief Report progress in current stage (reported if it moved enough)
+     * @param[in] passe current passe, -1 if not relevant
+     * @param[in] stage_fraction fraction of current stage done (between 0 and 1)
+     * @return false if path generation has to stop (cancelled or deadline exceeded)
+     */
+    bool update(int passe, double stage_fraction);
+
+    /**@brief Check cancellation and deadline (cheap : use in inner loops)
+     * @return false if path generation has to stop (cancelled or deadline exceeded)
+     */
+    bool keepGoing();
+
+    /**@brief End of path generation (reports stage BEZIER_STAGE_DONE)
+     * @param[in] success false if path generation failed (ignored if cancelled or deadline exceeded)
+     * @return final status
+     */
+    BezierStatus finish(bool success);
+
+    ///@brief Status of path generation
+    BezierStatus status() const { return status_; }
+
+  private:
+    ///@brief Fill elapsed and remaining time, then call callback
+    void report();
+
+    /** @brief progress callback (not owned) */
+    BezierProgressCallback *callback_;
+    /** @brief cancellation token (not owned) */
+    const BezierCancellationToken *token_;
+    /** @brief maximal duration (in seconds), 0 disables deadline */
+    double deadline_;
+    /** @brief start of path generation */
+    boost::posix_time::ptime start_time_;
+    /** @brief true between start and finish */
+    bool running_;
+    /** @brief calls of keepGoing since last clock check */
+    unsigned int calls_;
+    /** @brief status of path generation */
+    BezierStatus status_;
+    /** @brief current progress */
+    BezierProgress progress_;
+    /** @brief fraction sent with the last report */
+    double reported_fraction_;
+};
+
+#endif
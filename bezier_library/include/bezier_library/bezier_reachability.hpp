@@ -0,0 +1,116 @@
+#ifndef BEZIER_REACHABILITY_HPP
+#define BEZIER_REACHABILITY_HPP
+
+#include <vector>
+
+// Eigen headers
+#include <Eigen/StdVector>
+#include <Eigen/Geometry>
+
+/**
+ * @file bezier_reachability.hpp
+ * @brief Reachability of robot poses with closed-form inverse kinematics (6 axis robots with spherical wrist).
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+/** @brief Kinematic model of a 6 axis robot with ortho-parallel base and spherical wrist (OPW parameters).
+ *
+ * Geometry (in meters) : c1 is the height of axis 2, a1 the offset between axis 1 and axis 2, c2 the length of the arm,
+ * a2 the offset between axis 3 and axis 4, c3 the length of the forearm, c4 the distance between wrist center and flange,
+ * b the lateral offset. Joint values are converted with offsets and sign corrections
+ * (joint = (model angle + offset) * sign correction).
+ */
+struct BezierRobotModel
+{
+    ///@brief Default Constructor : Fanuc M10iA (fanuc_m10ia_support geometry and joint limits)
+    BezierRobotModel();
+
+    /** @brief OPW geometry (in meters) */
+    double a1, a2, b, c1, c2, c3, c4;
+    /** @brief joint offsets (in radians) */
+    double offsets[6];
+    /** @brief joint sign corrections (1 or -1) */
+    int sign_corrections[6];
+    /** @brief joint lower limits (in radians) */
+    double joint_min[6];
+    /** @brief joint upper limits (in radians) */
+    double joint_max[6];
+    /** @brief tool frame in flange frame : poses are tool poses */
+    Eigen::Affine3d tool;
+};
+
+/** @brief BezierReachability checks robot poses against a closed-form inverse kinematics model (no MoveIt).
+ *
+ * A pose is reachable if one of the (up to 8) inverse kinematics solutions respects joint limits.
+ * Joint limits wider than 2 pi are handled (solutions +/- 2 pi are tested).
+ * Unreachable poses can be re-oriented around their Z axis (tool axis of the grinding disk) to find a reachable pose.
+ * Batch functions are parallel (OpenMP).
+ */
+class BezierReachability
+{
+  public:
+    ///@brief Vector of robot poses
+    typedef std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > Poses;
+
+    /**@brief Constructor
+     * @param[in] model kinematic model of robot
+     */
+    explicit BezierReachability(const BezierRobotModel &model = BezierRobotModel());
+
+    /**@brief Forward kinematics
+     * @param[in] joints joint values (in radians)
+     * @return tool pose
+     */
+    Eigen::Affine3d forward(const double joints[6]) const;
+
+    /**@brief Inverse kinematics (joint limits are not checked)
+     * @param[in] pose tool pose
+     * @param[out] solutions 8 solutions (joint values in radians), unreachable solutions contain NAN values
+     * @return number of finite solutions
+     */
+    int inverse(const Eigen::Affine3d &pose, double solutions[8][6]) const;
+
+    /**@brief Check if a pose is reachable
+     * @param[in] pose tool pose
+     * @param[out] joints if not null, joint values of the first solution within joint limits
+     * @return true if one inverse kinematics solution respects joint limits
+     */
+    bool reachable(const Eigen::Affine3d &pose, double *joints = NULL) const;
+
+    /**@brief Check reachability of all poses (parallel)
+     * @param[in] poses tool poses
+     * @param[out] reachable_flags 1 if pose is reachable, 0 otherwise
+     * @return number of unreachable poses
+     */
+    long check(const Poses &poses, std::vector<unsigned char> &reachable_flags) const;
+
+    /**@brief Re-orient unreachable poses around their Z axis (parallel). Rotations of step, -step, 2 step... up to max_angle
+     * are tried and the first reachable one replaces the pose.
+     * @param[in, out] poses tool poses
+     * @param[in, out] reachable_flags reachability of poses (from check), updated
+     * @param[in] max_angle maximal rotation around Z axis (in radians)
+     * @param[in] step rotation step (in radians)
+     * @return number of poses still unreachable
+     */
+    long reorient(Poses &poses, std::vector<unsigned char> &reachable_flags, double max_angle, double step) const;
+
+    /**@brief Get kinematic model
+     * @return kinematic model of robot
+     */
+    const BezierRobotModel &model() const { return model_; }
+
+  private:
+    /**@brief Check joint limits (solution is shifted by +/- 2 pi if needed)
+     * @param[in, out] joints joint values
+     * @return true if joint values respect joint limits
+     */
+    bool withinLimits(double joints[6]) const;
+
+    /** @brief kinematic model of robot */
+    BezierRobotModel model_;
+    /** @brief inverse of tool frame */
+    Eigen::Affine3d tool_inverse_;
+};
+
+#endif
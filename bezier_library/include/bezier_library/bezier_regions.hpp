@@ -0,0 +1,103 @@
+#ifndef BEZIER_REGIONS_HPP
+#define BEZIER_REGIONS_HPP
+
+#include <string>
+#include <vector>
+
+// Eigen headers
+#include <Eigen/StdVector>
+#include <Eigen/Geometry>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+
+class BezierImpl;
+
+/**
+ * @file bezier_regions.hpp
+ * @brief Path generation of several defect regions of one part in one job.
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+/** @brief BezierRegions generates one path for several defect regions of the same input mesh.
+ *
+ * Regions are a list of default meshes, or the connected components of one default mesh.
+ * Input mesh work is done once for all regions : loading, normals, plane model (RANSAC), cut direction,
+ * distance field and dilated meshes (passes and extrication meshes use the same dilations).
+ * Then each region (default intersection, slicing, poses and extrications) runs in parallel (OpenMP).
+ *
+ * Pass sets of regions are ordered to reduce travel between them (shortest chain from the end of a region to the start
+ * of the next one), with lifted transit poses between regions. The last pass of every region (input mesh itself)
+ * is the same for all regions : it is ground once, after all regions.
+ */
+class BezierRegions
+{
+  public:
+    /**@brief Constructor : regions are the connected components of the default mesh
+     * @param[in] filename_inputMesh filename of input poly data (input mesh)
+     * @param[in] filename_defaultMesh filename of default poly data (default mesh, one component per defect)
+     * @param[in] grind_depth grinding depth (in meters)
+     * @param[in] effector_diameter diameter of effector (in meters)
+     * @param[in] covering Percentage of covering (decimal value)
+     * @param[in] extrication_coefficiant extrication depth equal of how many grind_depth (coefficiant)
+     * @param[in] extrication_frequency new extrication mesh generated each 1/extrication_frequency times.
+     */
+    BezierRegions(std::string filename_inputMesh, std::string filename_defaultMesh, double grind_depth, double effector_diameter,
+                  double covering, int extrication_coefficiant, int extrication_frequency);
+
+    /**@brief Constructor : one region per default mesh
+     * @param[in] filename_inputMesh filename of input poly data (input mesh)
+     * @param[in] filename_defaultMeshes filenames of default poly data (one default mesh per defect)
+     * @param[in] grind_depth grinding depth (in meters)
+     * @param[in] effector_diameter diameter of effector (in meters)
+     * @param[in] covering Percentage of covering (decimal value)
+     * @param[in] extrication_coefficiant extrication depth equal of how many grind_depth (coefficiant)
+     * @param[in] extrication_frequency new extrication mesh generated each 1/extrication_frequency times.
+     */
+    BezierRegions(std::string filename_inputMesh, const std::vector<std::string> &filename_defaultMeshes, double grind_depth,
+                  double effector_diameter, double covering, int extrication_coefficiant, int extrication_frequency);
+
+    ~BezierRegions();
+
+    /**@brief Get number of defect regions
+     * @return number of regions (empty components are dropped)
+     */
+    int numberOfRegions() const { return (int)regions_.size(); }
+
+    /**@brief Generate the path of all regions
+     * @param[out] way_points_vector robot poses of all regions, in travel order
+     * @param[out] color_vector in order to know if pose is an extrication pose or not (Use to display path)
+     * @param[out] index_vector in order to know index of start and end pose in each passe (Use to display path)
+     * @param[out] region_vector region of each passe (index_vector.size() - 1 values), -1 for the final input mesh passe
+     * @return boolean flag reflects the function proceedings (false if a region failed).
+     */
+    bool generateTrajectory(std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector,
+                            std::vector<bool> &color_vector, std::vector<int> &index_vector, std::vector<int> &region_vector);
+
+  private:
+    // Non copyable
+    BezierRegions(const BezierRegions &);
+    BezierRegions &operator=(const BezierRegions &);
+
+    /**@brief Order regions so that travel between them is short (greedy chain, every region tried as first one)
+     * @param[in] starts first pose position of each region
+     * @param[in] ends last pose position of each region
+     * @param[in] final_start first pose position of the final input mesh passe
+     * @param[out] order regions in travel order
+     */
+    static void orderRegions(const std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> > &starts,
+                             const std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> > &ends,
+                             const Eigen::Vector3d &final_start, std::vector<int> &order);
+
+    /** @brief loaded input mesh, normals, plane model, cut direction and dilations shared by all regions */
+    boost::scoped_ptr<BezierImpl> impl_;
+    /** @brief one object per region (default mesh of region, shared input mesh work) */
+    std::vector<boost::shared_ptr<BezierImpl> > regions_;
+    /** @brief grinding depth (in meters) */
+    double grind_depth_;
+    /** @brief extrication depth equal of how many grind_depth (coefficiant) */
+    int extrication_coefficiant_;
+};
+
+#endif
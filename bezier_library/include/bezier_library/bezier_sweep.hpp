@@ -0,0 +1,140 @@
+#ifndef BEZIER_SWEEP_HPP
+#define BEZIER_SWEEP_HPP
+
+#include <string>
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
+
+#include "bezier_library/bezier_trajectory.hpp"
+
+class BezierImpl;
+
+/**
+ * @file bezier_sweep.hpp
+ * @brief Parameter sweep : path generation of one part for a grid of grinding parameters.
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+/** @brief Grinding parameters of a path generation (see @ref Bezier constructor) */
+struct BezierParameters
+{
+    ///@brief Default Constructor : bezier_application parameters
+    BezierParameters() :
+            grind_depth(0.05), effector_diameter(0.1), covering(0.5), extrication_coefficiant(1), extrication_frequency(5)
+    {
+    }
+
+    /**@brief Initialized constructor
+     * @param[in] grind_depth grinding depth (in meters)
+     * @param[in] effector_diameter diameter of effector (in meters)
+     * @param[in] covering Percentage of covering (decimal value)
+     * @param[in] extrication_coefficiant extrication depth equal of how many grind_depth (coefficiant)
+     * @param[in] extrication_frequency new extrication mesh generated each 1/extrication_frequency times.
+     */
+    BezierParameters(double grind_depth, double effector_diameter, double covering, int extrication_coefficiant, int extrication_frequency) :
+            grind_depth(grind_depth), effector_diameter(effector_diameter), covering(covering),
+            extrication_coefficiant(extrication_coefficiant), extrication_frequency(extrication_frequency)
+    {
+    }
+
+    /** @brief grinding depth (in meters) */
+    double grind_depth;
+    /** @brief diameter of effector (in meters) */
+    double effector_diameter;
+    /** @brief Percentage of covering (decimal value) */
+    double covering;
+    /** @brief extrication depth equal of how many grind_depth (coefficiant) */
+    int extrication_coefficiant;
+    /** @brief new extrication mesh generated each 1/extrication_frequency times */
+    int extrication_frequency;
+};
+
+/** @brief Result of a path generation in a sweep */
+struct BezierSweepResult
+{
+    /** @brief grinding parameters */
+    BezierParameters parameters;
+    /** @brief true if path generation succeeded */
+    bool success;
+    /** @brief number of passes */
+    int number_of_passes;
+    /** @brief number of robot poses (grinding and extrication) */
+    long number_of_poses;
+    /** @brief length of tool path (in meters) */
+    double path_length;
+    /** @brief compute time (in seconds) of this parameter set, shared work excluded */
+    double compute_time;
+    /** @brief estimated execution time, grind and air lengths, reversals (see BezierSweep::set_trajectory_limits) */
+    BezierCycleEstimate cycle;
+};
+
+/** @brief BezierSweep generates paths of one part for several parameter sets.
+ *
+ * Work that does not depend on a parameter is only done once :
+ * - meshes are loaded and cleaned, normals, plane model (RANSAC) and cut direction are computed once for all sets,
+ * - distance field and passes (dilated meshes) are computed once per grind depth.
+ *
+ * Then each parameter set (slicing, poses and extrications) runs in parallel (OpenMP).
+ * @note RANSAC is run once : all sets share the same cut direction.
+ */
+class BezierSweep
+{
+  public:
+    /**@brief Constructor : load and clean meshes
+     * @param[in] filename_inputMesh filename of input poly data (input mesh)
+     * @param[in] filename_defaultMesh filename of default poly data (default mesh)
+     */
+    BezierSweep(std::string filename_inputMesh, std::string filename_defaultMesh);
+
+    ~BezierSweep();
+
+    /**@brief Build all combinations of parameter values (grid)
+     * @param[in] grind_depths grinding depths (in meters)
+     * @param[in] effector_diameters diameters of effector (in meters)
+     * @param[in] coverings percentages of covering (decimal values)
+     * @param[in] extrication_coefficiants extrication coefficiants
+     * @param[in] extrication_frequencies extrication frequencies
+     * @param[out] parameters parameter sets (grind depth varies slowest)
+     */
+    static void grid(const std::vector<double> &grind_depths, const std::vector<double> &effector_diameters,
+                     const std::vector<double> &coverings, const std::vector<int> &extrication_coefficiants,
+                     const std::vector<int> &extrication_frequencies, std::vector<BezierParameters> &parameters);
+
+    /**@brief Generate paths of all parameter sets
+     * @param[in] parameters parameter sets
+     * @param[out] results one result per parameter set (same order)
+     * @return boolean flag reflects the function proceedings (false if a parameter set failed).
+     */
+    bool run(const std::vector<BezierParameters> &parameters, std::vector<BezierSweepResult> &results);
+
+    /**@brief Print results as a table (one row per parameter set)
+     * @param[in] results results of run
+     */
+    static void printTable(const std::vector<BezierSweepResult> &results);
+
+    /**@brief Set velocity and acceleration limits used to estimate cycle time of each parameter set
+     * @param[in] limits velocity and acceleration limits (default : BezierTrajectoryLimits())
+     */
+    void set_trajectory_limits(const BezierTrajectoryLimits &limits) { limits_ = limits; }
+
+    /**@brief Get compute time of shared work (normals, plane model, distance fields and passes) of the last run
+     * @return compute time (in seconds)
+     */
+    double get_shared_time() const { return shared_time_; }
+
+  private:
+    // Non copyable
+    BezierSweep(const BezierSweep &);
+    BezierSweep &operator=(const BezierSweep &);
+
+    /** @brief loaded meshes, normals, plane model and cut direction shared by all parameter sets */
+    boost::scoped_ptr<BezierImpl> impl_;
+    /** @brief compute time (in seconds) of shared work of the last run */
+    double shared_time_;
+    /** @brief velocity and acceleration limits used to estimate cycle times */
+    BezierTrajectoryLimits limits_;
+};
+
+#endif
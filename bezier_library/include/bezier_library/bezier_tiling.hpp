@@ -0,0 +1,87 @@
+#ifndef BEZIER_TILING_HPP
+#define BEZIER_TILING_HPP
+
+#include <vector>
+
+// Eigen headers
+#include <Eigen/Dense>
+
+// VTK headers
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+class BezierMeshView;
+
+/**
+ * @file bezier_tiling.hpp
+ * @brief Split of big meshes into overlapping tiles (dilation and slicing within a memory budget).
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+/** @brief BezierTiling splits a triangle mesh into tiles along an axis.
+ *
+ * Tiles are regularly spaced along the axis. Each triangle belongs to the core of exactly one tile
+ * (projection of its centroid on the axis). A tile is extracted with a margin : triangles of neighbour tiles
+ * closer than the margin are added, so that results computed in the core (distances, closest points) are the same
+ * as on the whole mesh.
+ * @note The viewed mesh must outlive the tiling.
+ */
+class BezierTiling
+{
+  public:
+
+    /**@brief Constructor : compute tile limits
+     * @param[in] view mesh to split
+     * @param[in] axis tiling axis (normalized)
+     * @param[in] number_of_tiles number of tiles (1 at least)
+     */
+    BezierTiling(const BezierMeshView &view, const Eigen::Vector3d &axis, int number_of_tiles);
+
+    ///@brief Number of tiles
+    int numberOfTiles() const { return (int)limits_.size() - 1; }
+
+    /**@brief Projection of a point on tiling axis
+     * @param[in] point coordinates (x,y,z)
+     * @return scalar product of point and axis
+     */
+    double project(const float *point) const { return axis_[0] * point[0] + axis_[1] * point[1] + axis_[2] * point[2]; }
+
+    /**@brief Check if a projection belongs to the core of a tile (first and last tiles are not bounded)
+     * @param[in] tile tile index
+     * @param[in] projection projection on tiling axis (see project)
+     * @return true if projection is in tile core
+     */
+    bool inCore(int tile, double projection) const
+    {
+        return (tile == 0 || projection >= limits_[tile]) && (tile + 1 == numberOfTiles() || projection < limits_[tile + 1]);
+    }
+
+    /**@brief Extract a tile : triangles whose centroid is in the tile core or closer than margin to it.
+     * Point data (normals...) are carried across.
+     * @param[in] tile tile index
+     * @param[in] margin margin (in meters) added on both sides of the core
+     * @return compact tile mesh
+     */
+    vtkSmartPointer<vtkPolyData> extract(int tile, double margin) const;
+
+    /**@brief Number of tiles so that parallel_tiles tiles processed at once fit in a memory budget
+     * @param[in] number_of_cells number of triangles of the whole mesh
+     * @param[in] memory_budget memory (in megabytes) available, 0 disables tiling
+     * @param[in] parallel_tiles number of tiles processed at once
+     * @return number of tiles, 1 if the whole mesh fits in budget
+     */
+    static int numberOfTiles(vtkIdType number_of_cells, double memory_budget, int parallel_tiles);
+
+  private:
+    /** @brief tiled mesh */
+    const BezierMeshView &view_;
+    /** @brief tiling axis */
+    Eigen::Vector3d axis_;
+    /** @brief tile limits along axis (number of tiles + 1 values) */
+    std::vector<double> limits_;
+    /** @brief projection of triangle centroids on axis */
+    std::vector<float> projections_;
+};
+
+#endif
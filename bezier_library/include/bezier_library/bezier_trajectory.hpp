@@ -0,0 +1,117 @@
+#ifndef BEZIER_TRAJECTORY_HPP
+#define BEZIER_TRAJECTORY_HPP
+
+#include <vector>
+
+// Eigen headers
+#include <Eigen/StdVector>
+#include <Eigen/Geometry>
+
+/**
+ * @file bezier_trajectory.hpp
+ * @brief Time parameterisation of generated poses (Cartesian trajectory with velocity and acceleration limits) and cycle time estimate.
+ * @author Francois Lasson _ Institut Maupertuis (France)
+ * @date Project started in February 2015
+ */
+
+/** @brief Velocity and acceleration limits used to time a trajectory */
+struct BezierTrajectoryLimits
+{
+    ///@brief Default limits (grind feed rate 0.02 m/s, extrication 0.1 m/s)
+    BezierTrajectoryLimits();
+
+    /** @brief linear velocity along grind lines : feed rate (m/s) */
+    double grind_velocity;
+    /** @brief linear velocity on extrication moves (m/s) */
+    double extrication_velocity;
+    /** @brief linear acceleration (m/s^2) */
+    double acceleration;
+    /** @brief angular velocity of the tool (rad/s) */
+    double angular_velocity;
+    /** @brief maximal deviation from a line join (m) : sets the velocity allowed through corners */
+    double junction_deviation;
+};
+
+/** @brief Cycle time estimate of a trajectory (see BezierTrajectory::estimateCycleTime) */
+struct BezierCycleEstimate
+{
+    ///@brief Default Constructor (empty trajectory)
+    BezierCycleEstimate();
+
+    /** @brief length of grind moves (m) : segments between two grind poses */
+    double grind_length;
+    /** @brief length of air moves (m) : extrication moves and moves between passes */
+    double air_length;
+    /** @brief number of direction reversals (angle between consecutive segments greater than 90 degrees) */
+    int reversals;
+    /** @brief number of tool stops : end of each run of moves (reversals, rotations in place, passe ends, trajectory end) */
+    int stops;
+    /** @brief estimated execution time (s) */
+    double time;
+};
+
+/** @brief Timed pose of a trajectory */
+struct BezierTrajectoryPoint
+{
+    /** @brief robot pose */
+    Eigen::Affine3d pose;
+    /** @brief linear velocity of the tool (m/s) */
+    Eigen::Vector3d velocity;
+    /** @brief time from start of trajectory (s) */
+    double time;
+    /** @brief true if point belongs to a grind line, false for extrication */
+    bool grind;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/** @brief BezierTrajectory converts poses generated by Bezier::generateTrajectory into a timed Cartesian trajectory.
+ *
+ * Each segment is limited by the feed rate (grind segments : both poses are grind poses) or by the extrication velocity,
+ * and by the angular velocity of the tool. Velocity through a line join is limited by the junction deviation
+ * (the sharper the corner, the slower), then forward and backward passes apply the acceleration limit.
+ * The trajectory starts and ends at rest. Duplicate poses are removed.
+ * Timed trajectories can be executed by a trajectory controller without calling a Cartesian planner.
+ */
+class BezierTrajectory
+{
+  public:
+    ///@brief Vector of timed poses
+    typedef std::vector<BezierTrajectoryPoint, Eigen::aligned_allocator<BezierTrajectoryPoint> > Points;
+
+    /**@brief Time parameterise poses
+     * @param[in] way_points_vector poses (from Bezier::generateTrajectory, or poses of a pass)
+     * @param[in] color_vector true for grind poses, false for extrication poses
+     * @param[in] limits velocity and acceleration limits
+     * @param[out] trajectory timed trajectory
+     * @return boolean flag reflects the function proceedings.
+     * @note Boolean vector and trajectory vector need to have same sizes.
+     */
+    static bool timeParameterise(const std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector,
+                                 const std::vector<bool> &color_vector, const BezierTrajectoryLimits &limits, Points &trajectory);
+
+    /**@brief Get pose of a trajectory at a given time (linear interpolation of positions, slerp of orientations)
+     * @param[in] trajectory timed trajectory
+     * @param[in] time time from start (s), clamped to trajectory duration
+     * @return interpolated pose (identity if trajectory is empty)
+     */
+    static Eigen::Affine3d sample(const Points &trajectory, double time);
+
+    /**@brief Estimate execution time of a trajectory without time parameterisation (one pass over poses, no allocation).
+     * Moves are split in runs between tool stops (direction reversals, rotations in place, passe starts and ends).
+     * In a run, each segment is travelled at its velocity limit (feed rate, extrication velocity, angular velocity),
+     * with acceleration and deceleration at both ends of the run. Corner slowdowns (junction deviation) are ignored :
+     * use timeParameterise for exact timings.
+     * @param[in] way_points_vector poses (from Bezier::generateTrajectory)
+     * @param[in] color_vector true for grind poses, false for extrication poses
+     * @param[in] index_vector index of last pose of each passe (first value -1), empty for one passe
+     * @param[in] limits velocity and acceleration limits
+     * @param[out] estimate lengths, reversals, stops and execution time
+     * @return boolean flag reflects the function proceedings.
+     */
+    static bool estimateCycleTime(const std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector,
+                                  const std::vector<bool> &color_vector, const std::vector<int> &index_vector,
+                                  const BezierTrajectoryLimits &limits, BezierCycleEstimate &estimate);
+};
+
+#endif
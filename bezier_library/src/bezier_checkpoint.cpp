@@ -0,0 +1,227 @@
+#include "bezier_library/bezier_checkpoint.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <sys/stat.h>
+
+typedef std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > Poses;
+
+static const char *TRAJECTORY_HEADER = "bezier_trajectory 1";
+static const char *CHECKPOINT_HEADER = "bezier_checkpoint 1";
+/** @brief Shortest text of a saved pose : 12 matrix values and color flag, one character and one separator each */
+static const std::streamoff MIN_POSE_LENGTH = 26;
+/** @brief Shortest text of a saved passe index : one character and one separator */
+static const std::streamoff MIN_INDEX_LENGTH = 2;
+
+/**@brief Get number of characters left in a file
+ * @param[in, out] file input file (position is restored)
+ * @return number of characters between current position and end of file
+ */
+static std::streamoff remainingLength(std::ifstream &file)
+{
+    const std::streampos position = file.tellg();
+    file.seekg(0, std::ios::end);
+    const std::streampos end = file.tellg();
+    file.seekg(position);
+    if (position < 0 || end < position)
+        return 0;
+    return end - position;
+}
+
+BezierCheckpointState::BezierCheckpointState() :
+        passe(0), pose(-1)
+{
+}
+
+//////////////////// IDENTIFIER ////////////////////
+std::string BezierCheckpoint::trajectoryId(const std::vector<std::string> &filenames, const std::string &parameters)
+{
+    std::ostringstream id;
+    id << TRAJECTORY_HEADER << "|";
+    for (size_t i = 0; i < filenames.size(); i++)
+    {
+        struct stat file_stat;
+        if (stat(filenames[i].c_str(), &file_stat) != 0)
+        {
+            printf("\nCheckpoint : can't stat %s", filenames[i].c_str());
+            return std::string();
+        }
+        id << filenames[i] << "@" << file_stat.st_size << ":" << file_stat.st_mtime << "|";
+    }
+    id << parameters;
+    std::string result(id.str());
+    // Identifier is stored on one line
+    for (size_t i = 0; i < result.size(); i++)
+        if (result[i] == '\n' || result[i] == '\r')
+            result[i] = ' ';
+    return result;
+}
+
+//////////////////// FILES ////////////////////
+bool BezierCheckpoint::writeFile(const std::string &filename, const std::string &content)
+{
+    const std::string temporary_filename(filename + ".tmp");
+    {
+        std::ofstream file(temporary_filename.c_str(), std::ios::out | std::ios::trunc);
+        if (!file)
+        {
+            printf("\nCheckpoint : can't write %s", temporary_filename.c_str());
+            return false;
+        }
+        file << content;
+        file.flush();
+        if (!file)
+        {
+            printf("\nCheckpoint : error while writing %s", temporary_filename.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temporary_filename.c_str(), filename.c_str()) != 0)
+    {
+        printf("\nCheckpoint : can't rename %s to %s", temporary_filename.c_str(), filename.c_str());
+        std::remove(temporary_filename.c_str());
+        return false;
+    }
+    return true;
+}
+
+//////////////////// TRAJECTORY ////////////////////
+bool BezierCheckpoint::saveTrajectory(const std::string &filename, const std::string &trajectory_id, const Poses &way_points_vector,
+                                      const std::vector<bool> &color_vector, const std::vector<int> &index_vector,
+                                      const std::vector<bool> &reachable_vector)
+{
+    if (way_points_vector.size() != color_vector.size()
+            || (!reachable_vector.empty() && reachable_vector.size() != way_points_vector.size()))
+    {
+        printf("\nCheckpoint : pose, color and reachability vectors must have same sizes");
+        return false;
+    }
+    const bool reachability = !reachable_vector.empty();
+    std::ostringstream content;
+    content << std::setprecision(17);
+    content << TRAJECTORY_HEADER << "\n" << trajectory_id << "\n";
+    content << "poses " << way_points_vector.size() << " reachability " << reachability << "\n";
+    for (size_t i = 0; i < way_points_vector.size(); i++)
+    {
+        // Rows of the 3x4 matrix (rotation, translation)
+        const Eigen::Matrix<double, 3, 4> matrix(way_points_vector[i].matrix().topRows<3>());
+        for (int row = 0; row < 3; row++)
+            for (int col = 0; col < 4; col++)
+                content << matrix(row, col) << " ";
+        content << color_vector[i];
+        if (reachability)
+            content << " " << reachable_vector[i];
+        content << "\n";
+    }
+    content << "passes " << index_vector.size() << "\n";
+    for (size_t i = 0; i < index_vector.size(); i++)
+        content << index_vector[i] << "\n";
+    return writeFile(filename, content.str());
+}
+
+bool BezierCheckpoint::loadTrajectory(const std::string &filename, const std::string &trajectory_id, Poses &way_points_vector,
+                                      std::vector<bool> &color_vector, std::vector<int> &index_vector, std::vector<bool> &reachable_vector)
+{
+    way_points_vector.clear();
+    color_vector.clear();
+    index_vector.clear();
+    reachable_vector.clear();
+    std::ifstream file(filename.c_str());
+    if (!file)
+        return false;
+    std::string header, id;
+    std::getline(file, header);
+    std::getline(file, id);
+    if (header != TRAJECTORY_HEADER || id != trajectory_id)
+        return false;
+
+    std::string keyword;
+    size_t number_of_poses = 0;
+    bool reachability = false;
+    file >> keyword >> number_of_poses;
+    if (keyword != "poses")
+        return false;
+    file >> keyword >> reachability;
+    if (keyword != "reachability" || !file)
+        return false;
+    // Counts are checked against file length before any allocation : a corrupted count can't exhaust memory
+    if (number_of_poses > (size_t)(remainingLength(file) / MIN_POSE_LENGTH))
+    {
+        printf("\nCheckpoint : invalid trajectory file %s (%lu poses announced)", filename.c_str(), (unsigned long)number_of_poses);
+        return false;
+    }
+    way_points_vector.resize(number_of_poses);
+    color_vector.resize(number_of_poses);
+    if (reachability)
+        reachable_vector.resize(number_of_poses);
+    for (size_t i = 0; i < number_of_poses && file; i++)
+    {
+        Eigen::Affine3d &pose = way_points_vector[i];
+        pose.setIdentity();
+        for (int row = 0; row < 3; row++)
+            for (int col = 0; col < 4; col++)
+                file >> pose.matrix()(row, col);
+        bool value;
+        file >> value;
+        color_vector[i] = value;
+        if (reachability)
+        {
+            file >> value;
+            reachable_vector[i] = value;
+        }
+    }
+    size_t number_of_indices = 0;
+    file >> keyword >> number_of_indices;
+    if (keyword != "passes" || number_of_indices > (size_t)(remainingLength(file) / MIN_INDEX_LENGTH + 1))
+        file.setstate(std::ios::failbit);
+    if (file)
+        index_vector.resize(number_of_indices);
+    for (size_t i = 0; i < number_of_indices && file; i++)
+        file >> index_vector[i];
+
+    // Passe indices must point inside the pose vector
+    bool valid = file && !index_vector.empty() && index_vector.front() == -1;
+    for (size_t i = 1; valid && i < index_vector.size(); i++)
+        valid = index_vector[i] > index_vector[i - 1] && index_vector[i] < (int)number_of_poses;
+    if (!valid)
+    {
+        printf("\nCheckpoint : invalid trajectory file %s", filename.c_str());
+        way_points_vector.clear();
+        color_vector.clear();
+        index_vector.clear();
+        reachable_vector.clear();
+        return false;
+    }
+    return true;
+}
+
+//////////////////// STATE ////////////////////
+bool BezierCheckpoint::saveState(const std::string &filename, const BezierCheckpointState &state)
+{
+    std::ostringstream content;
+    content << CHECKPOINT_HEADER << "\n" << state.trajectory_id << "\n";
+    content << "passe " << state.passe << "\n";
+    content << "pose " << state.pose << "\n";
+    return writeFile(filename, content.str());
+}
+
+bool BezierCheckpoint::loadState(const std::string &filename, BezierCheckpointState &state)
+{
+    std::ifstream file(filename.c_str());
+    if (!file)
+        return false;
+    std::string header, passe_keyword, pose_keyword;
+    BezierCheckpointState loaded_state;
+    std::getline(file, header);
+    std::getline(file, loaded_state.trajectory_id);
+    file >> passe_keyword >> loaded_state.passe >> pose_keyword >> loaded_state.pose;
+    if (!file || header != CHECKPOINT_HEADER || passe_keyword != "passe" || pose_keyword != "pose" || loaded_state.passe < 0)
+    {
+        printf("\nCheckpoint : invalid checkpoint file %s", filename.c_str());
+        return false;
+    }
+    state = loaded_state;
+    return true;
+}
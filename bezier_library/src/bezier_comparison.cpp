@@ -0,0 +1,173 @@
+#include "bezier_library/bezier_comparison.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+typedef BezierComparison::Poses Poses;
+
+BezierComparisonTolerances::BezierComparisonTolerances() :
+        distance(0.001), extrication_distance(0.005), angle(M_PI / 180)
+{
+}
+
+BezierComparisonReport::BezierComparisonReport() :
+        equivalent(false), reference_passes(0), passes(0), failed_passe(-1), max_distance(0), max_extrication_distance(0), max_angle(0)
+{
+}
+
+//////////////////// POLYLINES ////////////////////
+double BezierComparison::closestPoint(const Eigen::Affine3d *polyline, size_t size, const Eigen::Vector3d &point, size_t &segment, double &t)
+{
+    segment = 0;
+    t = 0;
+    double min_distance2 = (point - polyline[0].translation()).squaredNorm();
+    for (size_t i = 0; i + 1 < size; i++)
+    {
+        const Eigen::Vector3d a(polyline[i].translation());
+        const Eigen::Vector3d ab(polyline[i + 1].translation() - a);
+        const double length2 = ab.squaredNorm();
+        double s = (length2 > 0) ? (point - a).dot(ab) / length2 : 0;
+        s = std::min(1.0, std::max(0.0, s));
+        const double distance2 = (point - (a + s * ab)).squaredNorm();
+        if (distance2 < min_distance2)
+        {
+            min_distance2 = distance2;
+            segment = i;
+            t = s;
+        }
+    }
+    return std::sqrt(min_distance2);
+}
+
+double BezierComparison::hausdorffDistance(const Eigen::Affine3d *polyline_a, size_t size_a, const Eigen::Affine3d *polyline_b, size_t size_b)
+{
+    if (size_a == 0 && size_b == 0)
+        return 0;
+    if (size_a == 0 || size_b == 0)
+        return std::numeric_limits<double>::infinity();
+    double max_distance = 0;
+    size_t segment;
+    double t;
+    for (size_t i = 0; i < size_a; i++)
+        max_distance = std::max(max_distance, closestPoint(polyline_b, size_b, polyline_a[i].translation(), segment, t));
+    for (size_t i = 0; i < size_b; i++)
+        max_distance = std::max(max_distance, closestPoint(polyline_a, size_a, polyline_b[i].translation(), segment, t));
+    return max_distance;
+}
+
+double BezierComparison::maxFrameAngle(const Eigen::Affine3d *reference, size_t reference_size, const Eigen::Affine3d *poses, size_t size)
+{
+    double max_angle = 0;
+    if (reference_size == 0)
+        return max_angle;
+    for (size_t i = 0; i < size; i++)
+    {
+        size_t segment;
+        double t;
+        closestPoint(reference, reference_size, poses[i].translation(), segment, t);
+        Eigen::Quaterniond reference_rotation(reference[segment].linear());
+        if (segment + 1 < reference_size)
+            reference_rotation = reference_rotation.slerp(t, Eigen::Quaterniond(reference[segment + 1].linear()));
+        max_angle = std::max(max_angle, reference_rotation.angularDistance(Eigen::Quaterniond(poses[i].linear())));
+    }
+    return max_angle;
+}
+
+double BezierComparison::hausdorffDistance(const Poses &polyline_a, const Poses &polyline_b)
+{
+    return hausdorffDistance(polyline_a.empty() ? NULL : &polyline_a[0], polyline_a.size(),
+                             polyline_b.empty() ? NULL : &polyline_b[0], polyline_b.size());
+}
+
+double BezierComparison::maxFrameAngle(const Poses &reference, const Poses &poses)
+{
+    return maxFrameAngle(reference.empty() ? NULL : &reference[0], reference.size(), poses.empty() ? NULL : &poses[0], poses.size());
+}
+
+void BezierComparison::grindLines(const std::vector<bool> &colors, int first, int last, std::vector<std::pair<int, int> > &lines)
+{
+    lines.clear();
+    for (int i = first; i <= last; i++)
+    {
+        if (!colors[i])
+            continue;
+        if (i == first || !colors[i - 1])
+            lines.push_back(std::make_pair(i, i));
+        lines.back().second = i;
+    }
+}
+
+//////////////////// TRAJECTORIES ////////////////////
+bool BezierComparison::compare(const Poses &reference_poses, const std::vector<bool> &reference_colors, const std::vector<int> &reference_indices,
+                               const Poses &poses, const std::vector<bool> &colors, const std::vector<int> &indices,
+                               const BezierComparisonTolerances &tolerances, BezierComparisonReport &report)
+{
+    report = BezierComparisonReport();
+    report.reference_passes = reference_indices.empty() ? 0 : reference_indices.size() - 1;
+    report.passes = indices.empty() ? 0 : indices.size() - 1;
+    std::ostringstream message;
+    if (reference_poses.size() != reference_colors.size() || poses.size() != colors.size())
+    {
+        report.message = "pose and color vectors have different sizes";
+        return false;
+    }
+    if (report.passes != report.reference_passes)
+    {
+        message << "number of passes " << report.passes << " (reference " << report.reference_passes << ")";
+        report.message = message.str();
+        return false;
+    }
+
+    // Passes and grind lines are compared in place : (first, last) pose indices
+    std::vector<std::pair<int, int> > reference_lines, lines;
+    for (int passe = 0; passe < report.passes; passe++)
+    {
+        const int reference_first = reference_indices[passe] + 1, reference_last = reference_indices[passe + 1];
+        const int first = indices[passe] + 1, last = indices[passe + 1];
+        //////////// WHOLE PASSE : GRIND LINES AND EXTRICATIONS ////////////
+        const double extrication_distance = hausdorffDistance(&reference_poses[0] + reference_first, reference_last - reference_first + 1,
+                                                              &poses[0] + first, last - first + 1);
+        report.max_extrication_distance = std::max(report.max_extrication_distance, extrication_distance);
+        if (extrication_distance > tolerances.extrication_distance && report.failed_passe < 0)
+        {
+            report.failed_passe = passe;
+            message << "passe " << passe << " : distance " << extrication_distance << " m (tolerance " << tolerances.extrication_distance << ")";
+        }
+
+        //////////// GRIND LINES : DISTANCE AND FRAMES ////////////
+        grindLines(reference_colors, reference_first, reference_last, reference_lines);
+        grindLines(colors, first, last, lines);
+        if (lines.size() != reference_lines.size())
+        {
+            if (report.failed_passe < 0)
+            {
+                report.failed_passe = passe;
+                message << "passe " << passe << " : " << lines.size() << " grind lines (reference " << reference_lines.size() << ")";
+            }
+            continue;
+        }
+        for (size_t index_line = 0; index_line < lines.size(); index_line++)
+        {
+            const Eigen::Affine3d *reference_line = &reference_poses[0] + reference_lines[index_line].first;
+            const size_t reference_size = reference_lines[index_line].second - reference_lines[index_line].first + 1;
+            const Eigen::Affine3d *line = &poses[0] + lines[index_line].first;
+            const size_t size = lines[index_line].second - lines[index_line].first + 1;
+            const double distance = hausdorffDistance(reference_line, reference_size, line, size);
+            const double angle = std::max(maxFrameAngle(reference_line, reference_size, line, size),
+                                          maxFrameAngle(line, size, reference_line, reference_size));
+            report.max_distance = std::max(report.max_distance, distance);
+            report.max_angle = std::max(report.max_angle, angle);
+            if ((distance > tolerances.distance || angle > tolerances.angle) && report.failed_passe < 0)
+            {
+                report.failed_passe = passe;
+                message << "passe " << passe << ", line " << index_line << " : distance " << distance << " m (tolerance "
+                        << tolerances.distance << "), angle " << angle << " rad (tolerance " << tolerances.angle << ")";
+            }
+        }
+    }
+    report.message = message.str();
+    report.equivalent = (report.failed_passe < 0);
+    return report.equivalent;
+}
@@ -0,0 +1,207 @@
+#include "bezier_library/bezier_display.hpp"
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+
+//////////////////// CONSTRUCTOR & DESTRUCTOR ////////////////////
+BezierDisplay::BezierDisplay(size_t max_display_points) :
+        max_display_points_(max_display_points), publishing_(false), stop_(false)
+{
+    this->thread_ = boost::thread(boost::bind(&BezierDisplay::publishLoop, this));
+}
+
+BezierDisplay::~BezierDisplay()
+{
+    {
+        boost::mutex::scoped_lock lock(this->mutex_);
+        this->stop_ = true;
+    }
+    this->condition_.notify_all();
+    this->thread_.join();
+}
+
+//////////////////// PUBLISHING THREAD ////////////////////
+void BezierDisplay::enqueue(const ros::Publisher &publisher, const visualization_msgs::MarkerConstPtr &marker)
+{
+    {
+        boost::mutex::scoped_lock lock(this->mutex_);
+        PendingMarker pending;
+        pending.publisher = publisher;
+        pending.marker = marker;
+        // Only the newest marker of a topic is published
+        bool replaced = false;
+        for (size_t i = 0; i < this->queue_.size() && !replaced; i++)
+        {
+            if (this->queue_[i].publisher.getTopic() == publisher.getTopic())
+            {
+                this->queue_[i] = pending;
+                replaced = true;
+            }
+        }
+        if (!replaced)
+            this->queue_.push_back(pending);
+    }
+    this->condition_.notify_all();
+}
+
+void BezierDisplay::publishLoop()
+{
+    boost::mutex::scoped_lock lock(this->mutex_);
+    while (true)
+    {
+        while (this->queue_.empty() && !this->stop_)
+            this->condition_.wait(lock);
+        if (this->queue_.empty()) //stop requested and nothing left to publish
+            break;
+        PendingMarker pending = this->queue_.front();
+        this->queue_.pop_front();
+        this->publishing_ = true;
+        lock.unlock();
+        if (pending.publisher.getNumSubscribers() < 1)
+            ROS_WARN_ONCE("No subscriber to the markers yet : use latched publishers so that RVIZ gets them later");
+        pending.publisher.publish(pending.marker);
+        lock.lock();
+        this->publishing_ = false;
+        this->condition_.notify_all();
+    }
+}
+
+void BezierDisplay::flush()
+{
+    boost::mutex::scoped_lock lock(this->mutex_);
+    while (!this->queue_.empty() || this->publishing_)
+        this->condition_.wait(lock);
+}
+
+size_t BezierDisplay::decimationStep(size_t number_of_points) const
+{
+    if (this->max_display_points_ == 0 || number_of_points <= this->max_display_points_)
+        return 1;
+    return (number_of_points + this->max_display_points_ - 1) / this->max_display_points_;
+}
+
+//////////////////// MARKERS ////////////////////
+void BezierDisplay::displayNormal(const std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector,
+                                  const std::vector<bool> &points_color_viz, const ros::Publisher &normal_publisher)
+{
+    //check possible error
+    if (way_points_vector.size() != points_color_viz.size())
+    {
+        ROS_ERROR("Trajectory vector and bool vector have differents sizes in displayNormal function");
+        return;
+    }
+    displayNormal(BezierPassView(way_points_vector, points_color_viz), normal_publisher);
+}
+
+void BezierDisplay::displayNormal(const BezierPassView &passe, const ros::Publisher &normal_publisher)
+{
+    visualization_msgs::MarkerPtr marker = boost::make_shared<visualization_msgs::Marker>();
+    marker->header.frame_id = "/base_link";                // Set the frame ID = /base ou /base_link
+    marker->header.stamp = ros::Time::now();               //set the timestamp (for tf)
+    marker->ns = "normals";   //set the namespace of the marker
+    marker->id = 0;        //set an unique ID of the marker
+    marker->type = visualization_msgs::Marker::LINE_LIST; //one segment per normal
+    marker->action = visualization_msgs::Marker::ADD; //set the marker action
+    marker->pose.orientation.w = 1.0;
+    marker->scale.x = 0.002; // segment diameter
+    marker->color.r = 0.0f;
+    marker->color.g = 1.0f;
+    marker->color.b = 0.0f;
+    marker->color.a = 0.7;
+    marker->lifetime = ros::Duration();            //set the lifetime
+
+    const double length = 0.015; //length for normal markers
+    const size_t step = decimationStep(passe.size());
+    marker->points.reserve(2 * (passe.size() / step + 1));
+    for (size_t k = 0; k < passe.size(); k += step)
+    {
+        if (!passe.color(k))
+            continue;
+        geometry_msgs::Point start_point;
+        geometry_msgs::Point end_point;
+        const Eigen::Vector3d translation(passe.pose(k).translation());
+        const Eigen::Vector3d normal(passe.pose(k).linear().col(2));
+        end_point.x = translation[0];
+        end_point.y = translation[1];
+        end_point.z = translation[2];
+        start_point.x = end_point.x - length * normal[0];
+        start_point.y = end_point.y - length * normal[1];
+        start_point.z = end_point.z - length * normal[2];
+        marker->points.push_back(start_point);
+        marker->points.push_back(end_point);
+    }
+    enqueue(normal_publisher, marker);
+}
+
+void BezierDisplay::displayTrajectory(const std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector,
+                                      const std::vector<bool> &points_color_viz, const ros::Publisher &trajectory_publisher)
+{
+    //check possible error
+    if (way_points_vector.size() != points_color_viz.size())
+    {
+        ROS_ERROR("Trajectory vector and bool vector have differents sizes in displayTrajectory function");
+        return;
+    }
+    displayTrajectory(BezierPassView(way_points_vector, points_color_viz), trajectory_publisher);
+}
+
+void BezierDisplay::displayTrajectory(const BezierPassView &passe, const ros::Publisher &trajectory_publisher)
+{
+    visualization_msgs::MarkerPtr marker = boost::make_shared<visualization_msgs::Marker>();
+    marker->header.frame_id = "/base_link";                // Set frame ID
+    marker->header.stamp = ros::Time::now();               //set timestamp (for tf)
+    marker->ns = "trajectory";             //Set marker namespace
+    marker->id = 0;                //set an unique ID of the marker
+    marker->type = visualization_msgs::Marker::LINE_STRIP; //Marker type
+    marker->action = visualization_msgs::Marker::ADD; //set the marker action
+    marker->lifetime = ros::Duration();            //set the lifetime
+    marker->scale.x = 0.003; // Set scale of our new marker : Diameter in our case.
+    //Set marker orientation. Here, there is no rotation : (v1,v2,v3)=(0,0,0) angle=0
+    marker->pose.orientation.w = 1.0;      // cos(angle/2)
+
+    std_msgs::ColorRGBA grind_color; //If points is from grindstone path : Color is green
+    grind_color.g = 1.0f;
+    grind_color.a = 1.0;
+    std_msgs::ColorRGBA extrication_color; //If points is from extrication path : Color is red
+    extrication_color.r = 1.0f;
+    extrication_color.a = 1.0;
+
+    // Decimated trajectory : points where grind/extrication flag changes and last point are always kept
+    const size_t step = decimationStep(passe.size());
+    marker->points.reserve(passe.size() / step + 1);
+    marker->colors.reserve(passe.size() / step + 1);
+    geometry_msgs::Point p; //temporary point
+    for (size_t k = 1; k < passe.size(); k++)
+    {
+        bool color_change = (passe.color(k) != passe.color(k - 1));
+        if (k % step != 0 && !color_change && k != passe.size() - 1)
+            continue;
+        p.x = passe.pose(k).translation()[0];
+        p.y = passe.pose(k).translation()[1];
+        p.z = passe.pose(k).translation()[2];
+        marker->colors.push_back(passe.color(k) ? grind_color : extrication_color); //set color segment
+        marker->points.push_back(p);         //add point p to LINE_STRIP
+    }
+    enqueue(trajectory_publisher, marker);
+}
+
+void BezierDisplay::displayMesh(const ros::Publisher &mesh_publisher, const std::string &mesh_path)
+{
+    // Create a mesh marker from ply files
+    visualization_msgs::MarkerPtr mesh_marker = boost::make_shared<visualization_msgs::Marker>();
+    mesh_marker->header.frame_id = "/base_link";                // Set the frame ID = /base ou /base_link
+    mesh_marker->header.stamp = ros::Time::now();               //set the timestamp (for tf)
+    mesh_marker->id = 0;        //set an unique ID of the marker
+    mesh_marker->type = visualization_msgs::Marker::MESH_RESOURCE;
+    mesh_marker->mesh_resource = mesh_path;
+    mesh_marker->action = visualization_msgs::Marker::ADD; //set the marker action
+    mesh_marker->pose.orientation.w = 1.0;
+    mesh_marker->scale.x = mesh_marker->scale.y = mesh_marker->scale.z = 1;
+    mesh_marker->color.r = 0.6f;
+    mesh_marker->color.g = 0.6f;
+    mesh_marker->color.b = 0.6f;
+    mesh_marker->color.a = 1.0;
+    //set the lifetime
+    mesh_marker->lifetime = ros::Duration();
+    enqueue(mesh_publisher, mesh_marker);
+}
@@ -0,0 +1,256 @@
+#include "bezier_library/bezier_gouge.hpp"
+#include "bezier_library/bezier_mesh_view.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//////////////////// TOOL ////////////////////
+BezierTool::BezierTool() :
+        radius(0.01), length(0.02), tolerance(0.0005)
+{
+}
+
+//////////////////// BVH ////////////////////
+///@brief Maximal number of triangles in a BVH leaf
+static const int leaf_size = 4;
+
+///@brief Compare triangles by centroid coordinate (used to split BVH nodes)
+struct CentroidComparator
+{
+    const std::vector<float> *centroids;
+    int axis;
+    CentroidComparator(const std::vector<float> *centroids2, int axis2) : centroids(centroids2), axis(axis2) {};
+    bool operator() (int a, int b) const
+    {
+        return (*centroids)[3 * a + axis] < (*centroids)[3 * b + axis];
+    }
+};
+
+BezierGougeCheck::BezierGougeCheck(const BezierMeshView &part, const BezierTool &tool) :
+        tool_(tool)
+{
+    const int number_of_triangles = part.numberOfTriangles();
+    if (number_of_triangles == 0)
+        return;
+    this->triangles_.resize(9 * number_of_triangles);
+    std::vector<float> centroids(3 * number_of_triangles);
+    for (int index_triangle = 0; index_triangle < number_of_triangles; index_triangle++)
+    {
+        const vtkIdType *ids = part.triangle(index_triangle);
+        for (int k = 0; k < 3; k++)
+        {
+            const float *p = part.point(ids[k]);
+            for (int i = 0; i < 3; i++)
+            {
+                this->triangles_[9 * index_triangle + 3 * k + i] = p[i];
+                centroids[3 * index_triangle + i] += p[i] / 3;
+            }
+        }
+    }
+    std::vector<int> order(number_of_triangles);
+    for (int i = 0; i < number_of_triangles; i++)
+        order[i] = i;
+    this->nodes_.reserve(2 * (number_of_triangles / leaf_size + 1));
+    build(0, number_of_triangles, centroids, order);
+
+    // Store triangles in BVH order (leaves are contiguous)
+    std::vector<float> ordered_triangles(this->triangles_.size());
+    for (int i = 0; i < number_of_triangles; i++)
+        std::copy(this->triangles_.begin() + 9 * order[i], this->triangles_.begin() + 9 * order[i] + 9, ordered_triangles.begin() + 9 * i);
+    this->triangles_.swap(ordered_triangles);
+}
+
+void BezierGougeCheck::build(int begin, int end, const std::vector<float> &centroids, std::vector<int> &order)
+{
+    const size_t index_node = this->nodes_.size();
+    this->nodes_.push_back(Node());
+    float bounds[6] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                       -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max()};
+    float centroid_bounds[6] = {bounds[0], bounds[1], bounds[2], bounds[3], bounds[4], bounds[5]};
+    for (int i = begin; i < end; i++)
+    {
+        const float *triangle = &this->triangles_[9 * order[i]];
+        for (int k = 0; k < 9; k++)
+        {
+            bounds[k % 3] = std::min(bounds[k % 3], triangle[k]);
+            bounds[3 + k % 3] = std::max(bounds[3 + k % 3], triangle[k]);
+        }
+        for (int k = 0; k < 3; k++)
+        {
+            centroid_bounds[k] = std::min(centroid_bounds[k], centroids[3 * order[i] + k]);
+            centroid_bounds[3 + k] = std::max(centroid_bounds[3 + k], centroids[3 * order[i] + k]);
+        }
+    }
+    std::copy(bounds, bounds + 6, this->nodes_[index_node].bounds);
+
+    if (end - begin <= leaf_size)
+    {
+        this->nodes_[index_node].index = begin;
+        this->nodes_[index_node].count = end - begin;
+        return;
+    }
+    // Split at median centroid along largest axis
+    int axis = 0;
+    for (int k = 1; k < 3; k++)
+        if (centroid_bounds[3 + k] - centroid_bounds[k] > centroid_bounds[3 + axis] - centroid_bounds[axis])
+            axis = k;
+    const int middle = (begin + end) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end, CentroidComparator(&centroids, axis));
+    this->nodes_[index_node].count = 0;
+    build(begin, middle, centroids, order);
+    this->nodes_[index_node].index = this->nodes_.size();
+    build(middle, end, centroids, order);
+}
+
+//////////////////// INTERSECTION ////////////////////
+bool BezierGougeCheck::intersects(const Eigen::Vector3d vertices[3]) const
+{
+    // Clip triangle between tool planes : -length <= z <= -tolerance
+    const double z_planes[2] = {-this->tool_.length, -this->tool_.tolerance};
+    Eigen::Vector3d polygon[5], clipped[5]; // a triangle clipped by 2 planes has at most 5 vertices
+    int size = 3;
+    for (int k = 0; k < 3; k++)
+        polygon[k] = vertices[k];
+    for (int plane = 0; plane < 2 && size > 0; plane++)
+    {
+        const double sign = (plane == 0) ? 1 : -1; // keep sign * (z - z_plane) >= 0
+        int clipped_size = 0;
+        for (int k = 0; k < size; k++)
+        {
+            const Eigen::Vector3d &a = polygon[k], &b = polygon[(k + 1) % size];
+            double da = sign * (a[2] - z_planes[plane]), db = sign * (b[2] - z_planes[plane]);
+            if (da >= 0)
+                clipped[clipped_size++] = a;
+            if ((da >= 0) != (db >= 0))
+                clipped[clipped_size++] = a + (b - a) * (da / (da - db));
+        }
+        size = std::min(clipped_size, 5);
+        for (int k = 0; k < size; k++)
+            polygon[k] = clipped[k];
+    }
+    if (size == 0)
+        return false;
+
+    // Distance between tool axis (origin in XY plane) and clipped polygon
+    const double radius2 = this->tool_.radius * this->tool_.radius;
+    bool positive = false, negative = false;
+    for (int k = 0; k < size; k++)
+    {
+        const Eigen::Vector2d a(polygon[k][0], polygon[k][1]);
+        const Eigen::Vector2d b(polygon[(k + 1) % size][0], polygon[(k + 1) % size][1]);
+        const Eigen::Vector2d edge(b - a);
+        double t = (edge.squaredNorm() > 0) ? std::min(1.0, std::max(0.0, -a.dot(edge) / edge.squaredNorm())) : 0;
+        if ((a + t * edge).squaredNorm() <= radius2)
+            return true;
+        double cross = a[0] * edge[1] - a[1] * edge[0];
+        positive = positive || cross > 0;
+        negative = negative || cross < 0;
+    }
+    return positive != negative; // axis inside polygon (cross products of same sign)
+}
+
+bool BezierGougeCheck::gouges(const Eigen::Affine3d &pose) const
+{
+    if (this->nodes_.empty())
+        return false;
+    // Bounding box of tool
+    const Eigen::Vector3d axis(pose.linear().col(2));
+    const Eigen::Vector3d p0(pose.translation() - this->tool_.tolerance * axis);
+    const Eigen::Vector3d p1(pose.translation() - this->tool_.length * axis);
+    float box[6];
+    for (int k = 0; k < 3; k++)
+    {
+        double extent = this->tool_.radius * std::sqrt(std::max(0.0, 1 - axis[k] * axis[k]));
+        box[k] = std::min(p0[k], p1[k]) - extent;
+        box[3 + k] = std::max(p0[k], p1[k]) + extent;
+    }
+    const Eigen::Affine3d world_to_tool(pose.inverse());
+
+    int stack[64];
+    int stack_size = 0;
+    stack[stack_size++] = 0;
+    while (stack_size > 0)
+    {
+        const Node &node = this->nodes_[stack[--stack_size]];
+        if (node.bounds[0] > box[3] || node.bounds[3] < box[0] || node.bounds[1] > box[4] || node.bounds[4] < box[1]
+                || node.bounds[2] > box[5] || node.bounds[5] < box[2])
+            continue;
+        if (node.count > 0)
+        {
+            for (int index_triangle = node.index; index_triangle < node.index + node.count; index_triangle++)
+            {
+                const float *triangle = &this->triangles_[9 * index_triangle];
+                Eigen::Vector3d vertices[3];
+                for (int k = 0; k < 3; k++)
+                    vertices[k] = world_to_tool * Eigen::Vector3d(triangle[3 * k], triangle[3 * k + 1], triangle[3 * k + 2]);
+                if (intersects(vertices))
+                    return true;
+            }
+            continue;
+        }
+        const int first_child = &node - &this->nodes_[0] + 1;
+        stack[stack_size++] = node.index;
+        stack[stack_size++] = first_child;
+    }
+    return false;
+}
+
+//////////////////// BATCH ////////////////////
+long BezierGougeCheck::check(const Poses &poses, std::vector<unsigned char> &gouge_flags) const
+{
+    const long number_of_poses = poses.size();
+    gouge_flags.assign(number_of_poses, 0);
+    long gouging_poses = 0;
+#pragma omp parallel for schedule(dynamic, 64) reduction(+:gouging_poses)
+    for (long i = 0; i < number_of_poses; i++)
+    {
+        gouge_flags[i] = gouges(poses[i]);
+        if (gouge_flags[i])
+            gouging_poses++;
+    }
+    return gouging_poses;
+}
+
+long BezierGougeCheck::avoid(Poses &poses, std::vector<unsigned char> &gouge_flags, double max_tilt, double tilt_step,
+                             double max_lift, double lift_step) const
+{
+    const long number_of_poses = poses.size();
+    if (gouge_flags.size() != poses.size())
+        check(poses, gouge_flags);
+    long gouging_poses = 0;
+#pragma omp parallel for schedule(dynamic, 16) reduction(+:gouging_poses)
+    for (long i = 0; i < number_of_poses; i++)
+    {
+        if (!gouge_flags[i])
+            continue;
+        // Tilt around X then Y axis of the pose
+        for (double angle = tilt_step; tilt_step > 0 && angle <= max_tilt + 1e-9 && gouge_flags[i]; angle += tilt_step)
+        {
+            for (int index_axis = 0; index_axis < 4 && gouge_flags[i]; index_axis++)
+            {
+                Eigen::Vector3d axis(index_axis < 2 ? Eigen::Vector3d::UnitX() : Eigen::Vector3d::UnitY());
+                Eigen::Affine3d pose(poses[i] * Eigen::AngleAxisd((index_axis % 2 == 0) ? angle : -angle, axis));
+                if (!gouges(pose))
+                {
+                    poses[i] = pose;
+                    gouge_flags[i] = 0;
+                }
+            }
+        }
+        // Lift along -Z axis
+        for (double lift = lift_step; lift_step > 0 && lift <= max_lift + 1e-9 && gouge_flags[i]; lift += lift_step)
+        {
+            Eigen::Affine3d pose(poses[i]);
+            pose.translation() -= lift * poses[i].linear().col(2);
+            if (!gouges(pose))
+            {
+                poses[i] = pose;
+                gouge_flags[i] = 0;
+            }
+        }
+        if (gouge_flags[i])
+            gouging_poses++;
+    }
+    return gouging_poses;
+}
@@ -0,0 +1,348 @@
+#include "bezier_library/bezier_iso_surface.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// VTK headers
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+
+//////////////////// CASE TABLE ////////////////////
+///@brief Corners of cube faces, counterclockwise seen from outside the cube (corner index : x + 2y + 4z)
+static const int FACE_CORNERS[6][4] = {{0, 4, 6, 2}, {1, 3, 7, 5}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 2, 3, 1}, {4, 5, 7, 6}};
+
+/** @brief Marching cubes case table, built from face rules (see BezierIsoSurface) */
+struct MarchingCubesTable
+{
+    ///@brief Build edges and the 256 cases
+    MarchingCubesTable();
+
+    /** @brief first corner of each cube edge (edge index : 4 * axis + n) */
+    int edge_corner[12];
+    /** @brief number of triangles of each case (bit c of case is set if scalar of corner c >= iso value) */
+    int number_of_triangles[256];
+    /** @brief cube edges of triangle vertices of each case */
+    int triangles[256][36];
+};
+
+MarchingCubesTable::MarchingCubesTable()
+{
+    // Edges : edge index of each pair of corners
+    int edge_index[8][8];
+    for (int axis = 0, e = 0; axis < 3; axis++)
+        for (int corner = 0; corner < 8; corner++)
+        {
+            if (corner & (1 << axis))
+                continue;
+            edge_corner[e] = corner;
+            edge_index[corner][corner | (1 << axis)] = edge_index[corner | (1 << axis)][corner] = e;
+            e++;
+        }
+
+    for (int index_case = 0; index_case < 256; index_case++)
+    {
+        // On each face, join each crossing entering the surface with the next crossing leaving it (counterclockwise)
+        int next[12];
+        std::fill(next, next + 12, -1);
+        for (int face = 0; face < 6; face++)
+            for (int i = 0; i < 4; i++)
+            {
+                const int a = FACE_CORNERS[face][i], b = FACE_CORNERS[face][(i + 1) % 4];
+                if ((index_case >> a & 1) || !(index_case >> b & 1))
+                    continue; //not an entering crossing
+                for (int j = 1; j < 4; j++)
+                {
+                    const int c = FACE_CORNERS[face][(i + j) % 4], d = FACE_CORNERS[face][(i + j + 1) % 4];
+                    if ((index_case >> c & 1) && !(index_case >> d & 1))
+                    {
+                        next[edge_index[a][b]] = edge_index[c][d];
+                        break;
+                    }
+                }
+            }
+        // Each cut edge enters the surface on one of its faces : segments form loops, triangulated as fans
+        number_of_triangles[index_case] = 0;
+        bool visited[12] = {false, false, false, false, false, false, false, false, false, false, false, false};
+        for (int e = 0; e < 12; e++)
+        {
+            if (next[e] < 0 || visited[e])
+                continue;
+            int loop[12], loop_size = 0;
+            for (int edge = e; !visited[edge]; edge = next[edge])
+            {
+                visited[edge] = true;
+                loop[loop_size++] = edge;
+            }
+            for (int k = 1; k + 1 < loop_size; k++)
+            {
+                int *triangle = triangles[index_case] + 3 * number_of_triangles[index_case]++;
+                triangle[0] = loop[0];
+                triangle[1] = loop[k];
+                triangle[2] = loop[k + 1];
+            }
+        }
+    }
+}
+
+///@brief Case table (built once, at library load)
+static const MarchingCubesTable TABLE;
+
+//////////////////// CONSTRUCTOR ////////////////////
+BezierIsoSurface::BezierIsoSurface(int block_size) :
+        block_size_(std::max(2, block_size)), compute_normals_(false), number_of_blocks_(0), number_of_active_blocks_(0)
+{
+}
+
+//////////////////// EXTRACTION ////////////////////
+/**@brief Field gradient at a grid point (central differences, one-sided on grid borders)
+ * @param[in] scalars field values
+ * @param[in] dimensions number of points along each axis
+ * @param[in] spacing distance between two points along each axis
+ * @param[in] ijk grid point coordinates
+ * @param[out] gradient field gradient
+ */
+static void gradient(const float *scalars, const long dimensions[3], const double spacing[3], const long ijk[3], double gradient[3])
+{
+    const long stride[3] = {1, dimensions[0], dimensions[0] * dimensions[1]};
+    const long point = ijk[0] + ijk[1] * stride[1] + ijk[2] * stride[2];
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const long previous = (ijk[axis] > 0) ? point - stride[axis] : point;
+        const long next = (ijk[axis] + 1 < dimensions[axis]) ? point + stride[axis] : point;
+        gradient[axis] = (scalars[next] - scalars[previous]) / (spacing[axis] * (next - previous) / stride[axis]);
+    }
+}
+
+bool BezierIsoSurface::extract(const float *scalars, const int dimensions[3], const double origin[3], const double spacing[3], float value)
+{
+    points_.clear();
+    normals_.clear();
+    triangles_.clear();
+    number_of_blocks_ = number_of_active_blocks_ = 0;
+    const long size[3] = {dimensions[0], dimensions[1], dimensions[2]};
+    if (!scalars || size[0] < 2 || size[1] < 2 || size[2] < 2)
+        return false;
+    const long stride[3] = {1, size[0], size[0] * size[1]};
+    const long block_size = block_size_;
+    const long blocks[3] = {(size[0] + block_size - 1) / block_size, (size[1] + block_size - 1) / block_size,
+                            (size[2] + block_size - 1) / block_size};
+    number_of_blocks_ = blocks[0] * blocks[1] * blocks[2];
+
+    //////////// ACTIVE BLOCKS : SCALAR RANGE CONTAINS VALUE ////////////
+    // A block owns the edges leaving its points and the cells whose first corner is one of its points :
+    // its range includes the next layer of points along each axis.
+    std::vector<unsigned char> active(number_of_blocks_, 0);
+#pragma omp parallel for schedule(dynamic, 4)
+    for (long block = 0; block < number_of_blocks_; block++)
+    {
+        const long b[3] = {block % blocks[0], (block / blocks[0]) % blocks[1], block / (blocks[0] * blocks[1])};
+        long first[3], last[3];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            first[axis] = b[axis] * block_size;
+            last[axis] = std::min(first[axis] + block_size, size[axis] - 1); //included
+        }
+        float min_value = std::numeric_limits<float>::max(), max_value = -std::numeric_limits<float>::max();
+        for (long k = first[2]; k <= last[2]; k++)
+            for (long j = first[1]; j <= last[1]; j++)
+            {
+                const float *row = scalars + j * stride[1] + k * stride[2];
+                for (long i = first[0]; i <= last[0]; i++)
+                {
+                    min_value = std::min(min_value, row[i]);
+                    max_value = std::max(max_value, row[i]);
+                }
+            }
+        active[block] = (min_value < value && max_value >= value);
+    }
+    std::vector<long> active_blocks;
+    for (long block = 0; block < number_of_blocks_; block++)
+        if (active[block])
+            active_blocks.push_back(block);
+    number_of_active_blocks_ = active_blocks.size();
+    const long number_of_active_blocks = number_of_active_blocks_;
+
+    //////////// VERTICES : ONE PER CUT EDGE, NUMBERED BLOCK BY BLOCK ////////////
+    // Pass 1 counts cut edges of each block, pass 2 numbers them from the block offset and interpolates them.
+    std::vector<long> block_offsets(number_of_active_blocks + 1, 0);
+    edge_vertices_.resize(3 * size[0] * size[1] * size[2]);
+    for (int pass = 0; pass < 2; pass++)
+    {
+#pragma omp parallel for schedule(dynamic, 1)
+        for (long index_block = 0; index_block < number_of_active_blocks; index_block++)
+        {
+            const long block = active_blocks[index_block];
+            const long b[3] = {block % blocks[0], (block / blocks[0]) % blocks[1], block / (blocks[0] * blocks[1])};
+            long vertex = (pass == 0) ? 0 : block_offsets[index_block];
+            long ijk[3];
+            for (ijk[2] = b[2] * block_size; ijk[2] < std::min((b[2] + 1) * block_size, size[2]); ijk[2]++)
+                for (ijk[1] = b[1] * block_size; ijk[1] < std::min((b[1] + 1) * block_size, size[1]); ijk[1]++)
+                    for (ijk[0] = b[0] * block_size; ijk[0] < std::min((b[0] + 1) * block_size, size[0]); ijk[0]++)
+                    {
+                        const long point = ijk[0] + ijk[1] * stride[1] + ijk[2] * stride[2];
+                        const bool inside = scalars[point] >= value;
+                        for (int axis = 0; axis < 3; axis++)
+                        {
+                            if (ijk[axis] + 1 >= size[axis] || (scalars[point + stride[axis]] >= value) == inside)
+                                continue;
+                            if (pass == 0)
+                            {
+                                vertex++;
+                                continue;
+                            }
+                            edge_vertices_[3 * point + axis] = vertex;
+                            const double t = (value - scalars[point]) / (scalars[point + stride[axis]] - scalars[point]);
+                            float *position = &points_[3 * vertex];
+                            for (int k = 0; k < 3; k++)
+                                position[k] = origin[k] + spacing[k] * (ijk[k] + (k == axis ? t : 0));
+                            if (compute_normals_)
+                            {
+                                long ijk_next[3] = {ijk[0], ijk[1], ijk[2]};
+                                ijk_next[axis]++;
+                                double gradient_a[3], gradient_b[3];
+                                gradient(scalars, size, spacing, ijk, gradient_a);
+                                gradient(scalars, size, spacing, ijk_next, gradient_b);
+                                double normal[3], norm = 0;
+                                for (int k = 0; k < 3; k++)
+                                {
+                                    normal[k] = -((1 - t) * gradient_a[k] + t * gradient_b[k]);
+                                    norm += normal[k] * normal[k];
+                                }
+                                norm = (norm > 0) ? std::sqrt(norm) : 1;
+                                for (int k = 0; k < 3; k++)
+                                    normals_[3 * vertex + k] = normal[k] / norm;
+                            }
+                            vertex++;
+                        }
+                    }
+            if (pass == 0)
+                block_offsets[index_block + 1] = vertex; //number of vertices of block (offsets are summed after the pass)
+        }
+        if (pass == 0)
+        {
+            for (long index_block = 0; index_block < number_of_active_blocks; index_block++)
+                block_offsets[index_block + 1] += block_offsets[index_block];
+            points_.resize(3 * block_offsets[number_of_active_blocks]);
+            if (compute_normals_)
+                normals_.resize(points_.size());
+        }
+    }
+
+    //////////// TRIANGLES : CASE OF EACH CELL, PER BLOCK ////////////
+    long corner_offsets[8];
+    for (int corner = 0; corner < 8; corner++)
+        corner_offsets[corner] = (corner & 1) * stride[0] + (corner >> 1 & 1) * stride[1] + (corner >> 2 & 1) * stride[2];
+    std::vector<std::vector<long> > block_triangles(number_of_active_blocks);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (long index_block = 0; index_block < number_of_active_blocks; index_block++)
+    {
+        const long block = active_blocks[index_block];
+        const long b[3] = {block % blocks[0], (block / blocks[0]) % blocks[1], block / (blocks[0] * blocks[1])};
+        std::vector<long> &output = block_triangles[index_block];
+        for (long k = b[2] * block_size; k < std::min((b[2] + 1) * block_size, size[2] - 1); k++)
+            for (long j = b[1] * block_size; j < std::min((b[1] + 1) * block_size, size[1] - 1); j++)
+                for (long i = b[0] * block_size; i < std::min((b[0] + 1) * block_size, size[0] - 1); i++)
+                {
+                    const long point = i + j * stride[1] + k * stride[2];
+                    int index_case = 0;
+                    for (int corner = 0; corner < 8; corner++)
+                        if (scalars[point + corner_offsets[corner]] >= value)
+                            index_case |= 1 << corner;
+                    for (int index_triangle = 0; index_triangle < TABLE.number_of_triangles[index_case]; index_triangle++)
+                    {
+                        const int *edges = TABLE.triangles[index_case] + 3 * index_triangle;
+                        long ids[3];
+                        for (int v = 0; v < 3; v++)
+                            ids[v] = edge_vertices_[3 * (point + corner_offsets[TABLE.edge_corner[edges[v]]]) + edges[v] / 4];
+                        // Drop triangles without area (iso value on a grid point)
+                        const float *a = &points_[3 * ids[0]], *p_b = &points_[3 * ids[1]], *c = &points_[3 * ids[2]];
+                        const float u[3] = {p_b[0] - a[0], p_b[1] - a[1], p_b[2] - a[2]};
+                        const float w[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+                        if (u[1] * w[2] - u[2] * w[1] == 0 && u[2] * w[0] - u[0] * w[2] == 0 && u[0] * w[1] - u[1] * w[0] == 0)
+                            continue;
+                        output.insert(output.end(), ids, ids + 3);
+                    }
+                }
+    }
+    size_t number_of_ids = 0;
+    for (long index_block = 0; index_block < number_of_active_blocks; index_block++)
+        number_of_ids += block_triangles[index_block].size();
+    triangles_.reserve(number_of_ids);
+    for (long index_block = 0; index_block < number_of_active_blocks; index_block++)
+        triangles_.insert(triangles_.end(), block_triangles[index_block].begin(), block_triangles[index_block].end());
+    return true;
+}
+
+vtkSmartPointer<vtkPolyData> BezierIsoSurface::extract(vtkSmartPointer<vtkImageData> field, double value)
+{
+    vtkSmartPointer<vtkPolyData> surface = vtkSmartPointer<vtkPolyData>::New();
+    vtkDataArray *scalars = field->GetPointData()->GetScalars();
+    int dimensions[3], extent[6];
+    double origin[3], spacing[3];
+    field->GetDimensions(dimensions);
+    field->GetExtent(extent);
+    field->GetOrigin(origin);
+    field->GetSpacing(spacing);
+    const vtkIdType number_of_samples = (vtkIdType)dimensions[0] * dimensions[1] * dimensions[2];
+    if (!scalars || number_of_samples == 0 || scalars->GetNumberOfTuples() != number_of_samples)
+        return surface;
+    for (int k = 0; k < 3; k++)
+        origin[k] += extent[2 * k] * spacing[k];
+
+    // Float scalars (vtkImplicitModeller output) are read in place, others are converted once
+    std::vector<float> converted;
+    const float *values;
+    vtkFloatArray *float_scalars = vtkFloatArray::SafeDownCast(scalars);
+    if (float_scalars && float_scalars->GetNumberOfComponents() == 1)
+        values = float_scalars->GetPointer(0);
+    else
+    {
+        converted.resize(number_of_samples);
+        for (vtkIdType i = 0; i < number_of_samples; i++)
+            converted[i] = scalars->GetComponent(i, 0);
+        values = &converted[0];
+    }
+    if (!this->extract(values, dimensions, origin, spacing, value))
+        return surface;
+
+    // Compact mesh : float points, connectivity written directly in VTK layout (3, id0, id1, id2)
+    const vtkIdType number_of_points = points_.size() / 3;
+    const vtkIdType number_of_triangles = triangles_.size() / 3;
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetDataTypeToFloat();
+    points->SetNumberOfPoints(number_of_points);
+    if (number_of_points > 0)
+        std::copy(points_.begin(), points_.end(), vtkFloatArray::SafeDownCast(points->GetData())->GetPointer(0));
+    vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+    connectivity->SetNumberOfValues(4 * number_of_triangles);
+    if (number_of_triangles > 0)
+    {
+        vtkIdType *cell = connectivity->GetPointer(0);
+        for (vtkIdType index_triangle = 0; index_triangle < number_of_triangles; index_triangle++, cell += 4)
+        {
+            cell[0] = 3;
+            cell[1] = triangles_[3 * index_triangle];
+            cell[2] = triangles_[3 * index_triangle + 1];
+            cell[3] = triangles_[3 * index_triangle + 2];
+        }
+    }
+    vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+    polys->SetCells(number_of_triangles, connectivity);
+    surface->SetPoints(points);
+    surface->SetPolys(polys);
+    if (compute_normals_)
+    {
+        vtkSmartPointer<vtkFloatArray> normals = vtkSmartPointer<vtkFloatArray>::New();
+        normals->SetName("Normals");
+        normals->SetNumberOfComponents(3);
+        normals->SetNumberOfTuples(number_of_points);
+        if (number_of_points > 0)
+            std::copy(normals_.begin(), normals_.end(), normals->GetPointer(0));
+        surface->GetPointData()->SetNormals(normals);
+    }
+    return surface;
+}
@@ -1,10 +1,62 @@
 #include "bezier_library/bezier_library.hpp"
+#include "bezier_library/bezier_impl.hpp"
+#include "bezier_library/bezier_iso_surface.hpp"
+#include "bezier_library/bezier_mesh_cleaning.hpp"
+#include "bezier_library/bezier_mesh_view.hpp"
+#include "bezier_library/bezier_tiling.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include <boost/lexical_cast.hpp>
+
+// PCL headers
+#include <pcl/io/vtk_lib_io.h>
+#include <pcl/ModelCoefficients.h>
+#include <pcl/sample_consensus/method_types.h>
+#include <pcl/sample_consensus/model_types.h>
+#include <pcl/segmentation/sac_segmentation.h>
+#include <pcl/surface/vtk_smoothing/vtk_utils.h>
+
+// VTK headers
+#include <vtkAppendPolyData.h>
+#include <vtkCellArray.h>
+#include <vtkCleanPolyData.h>
+#include <vtkCutter.h>
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkImplicitModeller.h>
+#include <vtkKdTreePointLocator.h>
+#include <vtkMarchingCubes.h>
+#include <vtkMath.h>
+#include <vtkPlane.h>
+#include <vtkPLYReader.h>
+#include <vtkPLYWriter.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyDataConnectivityFilter.h>
+#include <vtkPolyDataNormals.h>
+#include <vtkQuadricDecimation.h>
+#include <vtkTriangleFilter.h>
+
+/** @brief Version of path generation : change it whenever generated trajectories change, so that cached trajectories
+ * of previous versions are not used (see BezierImpl::get_settings) */
+static const char *BEZIER_ENGINE_VERSION = "bezier_engine 2";
 
 //////////////////// CONSTRUCTORS & DESTRUCTOR ////////////////////
 //Default Constructor
-Bezier::Bezier() :
-        grind_depth_(0.05), effector_diameter_(0.02), covering_(0.50), mesh_normal_vector_(Eigen::Vector3d::Identity()),
-        vector_dir_(Eigen::Vector3d::Identity())
+BezierImpl::BezierImpl() :
+        grind_depth_(0.05), effector_diameter_(0.02), covering_(0.50), weld_tolerance_(0.00001), stitch_gap_(0),
+        resampling_chordal_tolerance_(0), resampling_angular_tolerance_(0), smoothing_window_(0), smoothing_max_deviation_(0), decimated_(false),
+        max_reorientation_(0),
+        gouge_check_(false), gouge_max_tilt_(0), gouge_max_lift_(0), prepared_(false), passes_depth_(0), distance_field_depth_(0),
+        distance_field_grind_depth_(0), tile_memory_budget_(0), parallel_tiles_(1), dilation_cache_grind_depth_(0), point_cloud_(false), cloud_band_width_(0),
+        cloud_bin_length_(0), mesh_normal_vector_(Eigen::Vector3d::Identity()), vector_dir_(Eigen::Vector3d::Identity())
 {
     this->inputPolyData_ = vtkSmartPointer<vtkPolyData>::New();
     this->defaultPolyData_ = vtkSmartPointer<vtkPolyData>::New();
@@ -12,52 +64,256 @@ Bezier::Bezier() :
 }
 
 //Initialized Constructor
-Bezier::Bezier(std::string filename_inputMesh, std::string filename_defaultMesh,
-                 double grind_depth, double effector_diameter, double covering, int extrication_coefficiant, int extrication_frequency) :
-        grind_depth_(grind_depth), effector_diameter_(effector_diameter), covering_(covering), extrication_coefficiant_(extrication_coefficiant),
-        extrication_frequency_(extrication_frequency), mesh_normal_vector_(Eigen::Vector3d::Identity()), vector_dir_(Eigen::Vector3d::Identity())
+BezierImpl::BezierImpl(std::string filename_inputMesh, std::string filename_defaultMesh,
+                 double grind_depth, double effector_diameter, double covering, int extrication_coefficiant, int extrication_frequency,
+                 double weld_tolerance) :
+        grind_depth_(grind_depth), extrication_coefficiant_(extrication_coefficiant), extrication_frequency_(extrication_frequency),
+        effector_diameter_(effector_diameter), covering_(covering), weld_tolerance_(std::max(weld_tolerance, 0.0)),
+        stitch_gap_(0),
+        resampling_chordal_tolerance_(0), resampling_angular_tolerance_(0), smoothing_window_(0), smoothing_max_deviation_(0), decimated_(false),
+        max_reorientation_(0),
+        gouge_check_(false), gouge_max_tilt_(0), gouge_max_lift_(0),
+        prepared_(false), passes_depth_(0), distance_field_depth_(0), distance_field_grind_depth_(0), tile_memory_budget_(0), parallel_tiles_(1),
+        dilation_cache_grind_depth_(0), point_cloud_(false), cloud_band_width_(0), cloud_bin_length_(0), mesh_normal_vector_(Eigen::Vector3d::Identity()),
+        vector_dir_(Eigen::Vector3d::Identity())
 {
     this->inputPolyData_ = vtkSmartPointer<vtkPolyData>::New();
     if(!this->loadPLYPolydata(filename_inputMesh, this->inputPolyData_))
         printf("Can't load input mesh");
+    else if(!this->cleanMesh(this->inputPolyData_))
+        printf("Can't clean input mesh");
     this->defaultPolyData_ = vtkSmartPointer<vtkPolyData>::New();
     if(!this->loadPLYPolydata(filename_defaultMesh, this->defaultPolyData_))
         printf("Can't load default mesh");
+    else if(!this->cleanMesh(this->defaultPolyData_))
+        printf("Can't clean default mesh");
     this->printSelf();
 }
 
-Bezier::~Bezier(){}
-
-//////////////////// SORTING STRUCT : USE TO ORGANIZE STRIPPER /////////////////
-///@brief structure used to reorder lines
-struct lineOrganizerStruct
+//Sharing Constructor
+BezierImpl::BezierImpl(const BezierImpl &source, double grind_depth, double effector_diameter, double covering, int extrication_coefficiant,
+                       int extrication_frequency) :
+        grind_depth_(grind_depth), extrication_coefficiant_(extrication_coefficiant), extrication_frequency_(extrication_frequency),
+        effector_diameter_(effector_diameter), covering_(covering), weld_tolerance_(source.weld_tolerance_),
+        stitch_gap_(source.stitch_gap_),
+        resampling_chordal_tolerance_(source.resampling_chordal_tolerance_), resampling_angular_tolerance_(source.resampling_angular_tolerance_),
+        smoothing_window_(source.smoothing_window_), smoothing_max_deviation_(source.smoothing_max_deviation_), resolution_(source.resolution_),
+        decimated_(false), max_reorientation_(0), gouge_check_(false), gouge_max_tilt_(0), gouge_max_lift_(0),
+        prepared_(false), passes_depth_(0), distance_field_depth_(0), distance_field_grind_depth_(0),
+        tile_memory_budget_(source.tile_memory_budget_), parallel_tiles_(source.parallel_tiles_), dilation_cache_grind_depth_(0), point_cloud_(false),
+        cloud_band_width_(source.cloud_band_width_), cloud_bin_length_(source.cloud_bin_length_), mesh_normal_vector_(Eigen::Vector3d::Identity()),
+        vector_dir_(Eigen::Vector3d::Identity())
 {
-        // sort struct have to know its containing objects
-        Bezier* bezier_object;
-        lineOrganizerStruct(Bezier* bezier_object2) : bezier_object(bezier_object2) {};
+    this->share(source);
+    this->printSelf();
+}
 
-        // this is our sort function : use dot products to determine line position
-        bool operator() (const std::vector<std::pair<Eigen::Vector3d,Eigen::Vector3d> > &line_a, const std::vector<std::pair<Eigen::Vector3d,Eigen::Vector3d > > &line_b)
-        {
-            Eigen::Vector3d vector_dir = bezier_object->get_vector_direction();
-            float dist_a = vector_dir.dot(line_a[0].first);
-            float dist_b = vector_dir.dot(line_b[0].first);
-            return dist_a < dist_b;
-        }
-};
+BezierImpl::~BezierImpl(){}
 
 //////////////////// PRIVATE FUNCTIONS ////////////////////
-void Bezier::printSelf(void){
+void BezierImpl::printSelf(void){
     std::cout<<"\n***********************************************\nBEZIER PARAMETERS\n  Grind depth (in centimeters) : "<<
             this->grind_depth_*100<<"\n  Effector diameter (in centimeters) : "<<this->effector_diameter_*100<<
             "\n  Covering (in %) : "<<this->covering_*100<<"/100\n***********************************************"<<std::endl;
 }
 
-Eigen::Vector3d Bezier::get_vector_direction(){
+void BezierImpl::share(const BezierImpl &source){
+    // Shallow copies : arrays (points, cells, normals) are shared, pipeline information is not.
+    // Bounds are computed here (cell traversal) so that filters running in parallel only read shared arrays.
+    this->inputPolyData_ = vtkSmartPointer<vtkPolyData>::New();
+    this->inputPolyData_->ShallowCopy(source.inputPolyData_);
+    this->inputPolyData_->GetBounds();
+    this->defaultPolyData_ = vtkSmartPointer<vtkPolyData>::New();
+    this->defaultPolyData_->ShallowCopy(source.defaultPolyData_);
+    this->defaultPolyData_->GetBounds();
+    this->point_cloud_ = source.point_cloud_;
+    this->decimated_ = source.decimated_;
+    this->mesh_normal_vector_ = source.mesh_normal_vector_;
+    this->vector_dir_ = source.vector_dir_;
+    this->prepared_ = source.prepared_;
+    // Distance field (or tile fields) and passes only depend on grind depth
+    if ((source.distance_field_ || !source.tile_fields_.empty()) && source.distance_field_grind_depth_ == this->grind_depth_)
+    {
+        if (source.distance_field_)
+        {
+            this->distance_field_ = vtkSmartPointer<vtkImageData>::New();
+            this->distance_field_->ShallowCopy(source.distance_field_);
+        }
+        this->tile_fields_.resize(source.tile_fields_.size());
+        for (size_t tile = 0; tile < source.tile_fields_.size(); tile++)
+        {
+            if (!source.tile_fields_[tile])
+                continue;
+            this->tile_fields_[tile] = vtkSmartPointer<vtkImageData>::New();
+            this->tile_fields_[tile]->ShallowCopy(source.tile_fields_[tile]);
+        }
+        this->distance_field_depth_ = source.distance_field_depth_;
+        this->distance_field_grind_depth_ = source.distance_field_grind_depth_;
+    }
+    this->shareDilations(source);
+    this->dilationPolyDataVector_.clear();
+    this->passes_depth_ = 0;
+    if (!source.dilationPolyDataVector_.empty() && source.passes_depth_ == this->grind_depth_)
+    {
+        for (size_t i = 0; i < source.dilationPolyDataVector_.size(); i++)
+        {
+            if (source.dilationPolyDataVector_[i] == source.inputPolyData_) //last pass is input mesh itself
+            {
+                this->dilationPolyDataVector_.push_back(this->inputPolyData_);
+                continue;
+            }
+            vtkSmartPointer<vtkPolyData> pass = vtkSmartPointer<vtkPolyData>::New();
+            pass->ShallowCopy(source.dilationPolyDataVector_[i]);
+            pass->GetBounds();
+            this->dilationPolyDataVector_.push_back(pass);
+        }
+        this->passes_depth_ = source.passes_depth_;
+    }
+}
+
+Eigen::Vector3d BezierImpl::get_vector_direction(){
     return this->vector_dir_;
 }
 
-bool Bezier::loadPLYPolydata(std::string filename, vtkSmartPointer<vtkPolyData> &poly_data)
+void BezierImpl::set_parameters(double grind_depth, double effector_diameter, double covering, int extrication_coefficiant, int extrication_frequency){
+    this->grind_depth_ = grind_depth;
+    this->effector_diameter_ = effector_diameter;
+    this->covering_ = covering;
+    this->extrication_coefficiant_ = extrication_coefficiant;
+    this->extrication_frequency_ = extrication_frequency;
+    this->printSelf();
+}
+
+void BezierImpl::set_stitch_gap(double gap){
+    this->stitch_gap_ = std::max(gap, 0.0);
+}
+
+void BezierImpl::set_tiling(double memory_budget, int parallel_tiles){
+    this->tile_memory_budget_ = std::max(memory_budget, 0.0);
+    this->parallel_tiles_ = std::max(parallel_tiles, 1);
+    // Fields and passes are generated again with the new tiles
+    this->distance_field_ = NULL;
+    this->tile_fields_.clear();
+    this->distance_field_depth_ = 0;
+    this->dilation_cache_.clear();
+    this->dilationPolyDataVector_.clear();
+    this->passes_depth_ = 0;
+}
+
+void BezierImpl::set_point_cloud_slicing(double band_width, double bin_length){
+    this->cloud_band_width_ = std::max(0.0, band_width);
+    this->cloud_bin_length_ = std::max(0.0, bin_length);
+}
+
+void BezierImpl::set_resampling_tolerances(double chordal_tolerance, double angular_tolerance){
+    this->resampling_chordal_tolerance_ = std::max(chordal_tolerance, 0.0);
+    this->resampling_angular_tolerance_ = std::max(angular_tolerance, 0.0);
+}
+
+void BezierImpl::set_normal_smoothing(double window_length, double max_deviation){
+    this->smoothing_window_ = std::max(window_length, 0.0);
+    this->smoothing_max_deviation_ = std::max(max_deviation, 0.0);
+}
+
+void BezierImpl::get_angular_rates(std::vector<double> &angular_rates){
+    angular_rates = this->angular_rates_;
+}
+
+void BezierImpl::set_resolution(const BezierResolution &resolution){
+    this->resolution_ = resolution;
+    this->resolution_.mesh_reduction = std::min(std::max(resolution.mesh_reduction, 0.0), 0.95);
+    this->resolution_.field_samples = std::max(resolution.field_samples, 2);
+    this->resolution_.max_field_samples = std::max(resolution.max_field_samples, 2);
+    if (!(resolution.slice_spacing > 0))
+        this->resolution_.slice_spacing = 1;
+    // Meshes are decimated (then normals, plane model and cut direction computed again) by the next path generation
+    if (this->resolution_.mesh_reduction > 0 && !this->decimated_ && !this->point_cloud_)
+        this->prepared_ = false;
+    // Fields and passes are generated again with the new sampling
+    this->distance_field_ = NULL;
+    this->tile_fields_.clear();
+    this->distance_field_depth_ = 0;
+    this->dilation_cache_.clear();
+    this->dilationPolyDataVector_.clear();
+    this->passes_depth_ = 0;
+}
+
+BezierImpl *BezierImpl::createPreview(const BezierResolution &resolution) const{
+    BezierImpl *preview = new BezierImpl(*this, this->grind_depth_, this->effector_diameter_, this->covering_, this->extrication_coefficiant_,
+                                         this->extrication_frequency_);
+    preview->set_resolution(resolution);
+    return preview;
+}
+
+void BezierImpl::set_robot_model(const BezierRobotModel &model, double max_reorientation){
+    this->reachability_.reset(new BezierReachability(model));
+    this->max_reorientation_ = std::max(max_reorientation, 0.0);
+}
+
+void BezierImpl::get_reachability(std::vector<bool> &reachable_vector){
+    reachable_vector.assign(this->reachable_flags_.begin(), this->reachable_flags_.end());
+}
+
+void BezierImpl::set_gouge_check(bool enable, double tolerance, double max_tilt, double max_lift){
+    this->gouge_check_ = enable;
+    this->gouge_tool_.tolerance = std::max(tolerance, 0.0);
+    this->gouge_max_tilt_ = std::max(max_tilt, 0.0);
+    this->gouge_max_lift_ = std::max(max_lift, 0.0);
+}
+
+void BezierImpl::get_gouges(std::vector<std::vector<int> > &gouge_indices){
+    gouge_indices = this->gouge_indices_;
+}
+
+void BezierImpl::set_progress_callback(BezierProgressCallback *callback){
+    this->progress_.set_callback(callback);
+}
+
+void BezierImpl::set_cancellation_token(const BezierCancellationToken *token){
+    this->progress_.set_token(token);
+}
+
+void BezierImpl::set_deadline(double deadline){
+    this->progress_.set_deadline(deadline);
+}
+
+BezierStatus BezierImpl::get_status(){
+    return this->progress_.status();
+}
+
+std::string BezierImpl::get_settings(){
+    std::ostringstream settings;
+    settings << std::setprecision(17) << BEZIER_ENGINE_VERSION
+             << " grind " << this->grind_depth_ << " " << this->effector_diameter_ << " " << this->covering_
+             << " extrication " << this->extrication_coefficiant_ << " " << this->extrication_frequency_
+             << " weld " << this->weld_tolerance_ << " stitch " << this->stitch_gap_
+             << " resampling " << this->resampling_chordal_tolerance_ << " " << this->resampling_angular_tolerance_
+             << " smoothing " << this->smoothing_window_ << " " << this->smoothing_max_deviation_
+             << " resolution " << this->resolution_.mesh_reduction << " " << this->resolution_.field_samples << " "
+             << this->resolution_.max_field_samples << " " << this->resolution_.slice_spacing << " " << this->resolution_.shared_field
+             << " " << this->resolution_.block_iso_surface
+             << " tiling " << this->tile_memory_budget_ << " " << this->parallel_tiles_
+             << " cloud " << this->point_cloud_ << " " << this->cloud_band_width_ << " " << this->cloud_bin_length_
+             << " gouge " << this->gouge_check_;
+    if (this->gouge_check_)
+        settings << " " << this->gouge_tool_.tolerance << " " << this->gouge_max_tilt_ << " " << this->gouge_max_lift_;
+    settings << " reachability " << (bool)this->reachability_;
+    if (this->reachability_)
+    {
+        const BezierRobotModel &model = this->reachability_->model();
+        settings << " " << this->max_reorientation_ << " " << model.a1 << " " << model.a2 << " " << model.b << " " << model.c1
+                 << " " << model.c2 << " " << model.c3 << " " << model.c4;
+        for (int joint = 0; joint < 6; joint++)
+            settings << " " << model.offsets[joint] << " " << model.sign_corrections[joint] << " " << model.joint_min[joint]
+                     << " " << model.joint_max[joint];
+        for (int row = 0; row < 3; row++)
+            for (int col = 0; col < 4; col++)
+                settings << " " << model.tool.matrix()(row, col);
+    }
+    return settings.str();
+}
+
+bool BezierImpl::loadPLYPolydata(std::string filename, vtkSmartPointer<vtkPolyData> &poly_data)
 {
     vtkSmartPointer<vtkPLYReader> reader = vtkSmartPointer<vtkPLYReader>::New(); //reader for ply file
     reader->SetFileName(filename.c_str());
@@ -66,7 +322,35 @@ bool Bezier::loadPLYPolydata(std::string filename, vtkSmartPointer<vtkPolyData>
     return true;
 }
 
-bool Bezier::savePLYPolyData(std::string filename, vtkSmartPointer<vtkPolyData> poly_data)
+bool BezierImpl::cleanMesh(vtkSmartPointer<vtkPolyData> &poly_data)
+{
+    BezierMeshCleaningReport report;
+    bool flag = BezierMeshCleaner::clean(poly_data, this->weld_tolerance_, report);
+    report.print();
+    return flag;
+}
+
+bool BezierImpl::decimateMesh(vtkSmartPointer<vtkPolyData> &poly_data)
+{
+    const vtkIdType number_of_cells = poly_data->GetNumberOfCells();
+    if (number_of_cells < 1000) //fixme arbitrary value : small meshes are already fast
+        return true;
+    vtkSmartPointer<vtkQuadricDecimation> decimation = vtkSmartPointer<vtkQuadricDecimation>::New();
+#if VTK_MAJOR_VERSION <= 5
+    decimation->SetInput(poly_data);
+#else
+    decimation->SetInputData(poly_data);
+#endif
+    decimation->SetTargetReduction(this->resolution_.mesh_reduction);
+    decimation->Update();
+    if (decimation->GetOutput()->GetNumberOfCells() == 0)
+        return false;
+    poly_data = decimation->GetOutput();
+    printf("\nMesh decimated : %ld -> %ld triangles", (long)number_of_cells, (long)poly_data->GetNumberOfCells());
+    return true;
+}
+
+bool BezierImpl::savePLYPolyData(std::string filename, vtkSmartPointer<vtkPolyData> poly_data)
 {
     vtkSmartPointer<vtkPLYWriter> plyWriter = vtkSmartPointer<vtkPLYWriter>::New();
     plyWriter->SetFileName(filename.c_str());
@@ -77,24 +361,125 @@ bool Bezier::savePLYPolyData(std::string filename, vtkSmartPointer<vtkPolyData>
     return true;
 }
 
-/** fixme dilation problem detected : when depth is to high, dilated mesh has unexpected holes
- * These holes are problematic. In fact, when cutting process is called on dilated mesh, slices are divided in some parts due to these holes
- * and this affects the path generation, especially for extrical trajectory. We have to find a solution, perhaps find best parameters
- * in order to resolve this problem.
- */
-bool Bezier::dilatation(double depth, vtkSmartPointer<vtkPolyData> poly_data, vtkSmartPointer<vtkPolyData> &dilate_poly_data)
+int BezierImpl::estimateNumberOfPasses()
+{
+    if (this->inputPolyData_->GetNumberOfPoints() == 0 || !(this->grind_depth_ > 0))
+        return 1;
+    BezierMeshView input_view(this->inputPolyData_);
+    BezierMeshView default_view(this->defaultPolyData_);
+    // Big input mesh : closest points of default points are searched in the tile of their core (up to one effector diameter around it)
+    BezierTiling tiling(input_view, this->tilingAxis(), this->numberOfTiles(input_view.numberOfTriangles()));
+    double max_distance2 = 0;
+    for (int tile = 0; tile < tiling.numberOfTiles(); tile++)
+    {
+        vtkSmartPointer<vtkPolyData> tile_input = (tiling.numberOfTiles() > 1) ? tiling.extract(tile, this->effector_diameter_) : this->inputPolyData_;
+        if (tile_input->GetNumberOfPoints() == 0)
+            continue;
+        vtkSmartPointer<vtkKdTreePointLocator> kDTree = vtkSmartPointer<vtkKdTreePointLocator>::New();
+        kDTree->SetDataSet(tile_input);
+        kDTree->BuildLocator();
+        BezierMeshView tile_view(tile_input);
+        for (vtkIdType i = 0; i < default_view.numberOfPoints(); i++)
+        {
+            const float *p = default_view.point(i);
+            if (!tiling.inCore(tile, tiling.project(p)))
+                continue;
+            double point[3] = {p[0], p[1], p[2]};
+            const float *closest_point = tile_view.point(kDTree->FindClosestPoint(point));
+            double distance2 = (point[0] - closest_point[0]) * (point[0] - closest_point[0]) + (point[1] - closest_point[1]) * (point[1] - closest_point[1])
+                    + (point[2] - closest_point[2]) * (point[2] - closest_point[2]);
+            max_distance2 = std::max(max_distance2, distance2);
+        }
+    }
+    return std::max(1, (int)std::ceil(std::sqrt(max_distance2) / this->grind_depth_));
+}
+
+bool BezierImpl::fieldSampling(double depth, FieldSampling &sampling)
+{
+    // Get maximum length of the sides
+    double bounds[6];
+    this->inputPolyData_->GetBounds(bounds);
+    double max_side_length = std::max(bounds[1] - bounds[0], bounds[3] - bounds[2]);
+    max_side_length = std::max(max_side_length, bounds[5] - bounds[4]);
+    if (!(max_side_length > 0))
+        return false;
+    // Field at least twice deeper than the previous one : few fields are computed while passes get deeper
+    bool same_spacing = this->distance_field_depth_ > 0 && this->distance_field_grind_depth_ == this->grind_depth_;
+    if (same_spacing && depth <= this->distance_field_depth_)
+        sampling.depth = this->distance_field_depth_;
+    else
+        sampling.depth = same_spacing ? std::max(depth, 2 * this->distance_field_depth_) : depth;
+    // Sample spacing of a 50x50x50 field around the first pass (full resolution), kept when the field gets deeper (capped number of samples)
+    for (int k = 0; k < 3; k++)
+    {
+        double side = bounds[2 * k + 1] - bounds[2 * k];
+        double spacing = (side + 2 * this->grind_depth_) / (this->resolution_.field_samples - 1);
+        sampling.dimensions[k] = std::min(this->resolution_.max_field_samples, (int)std::ceil((side + 2 * sampling.depth) / spacing) + 1);
+        sampling.bounds[2 * k] = bounds[2 * k] - sampling.depth;
+        sampling.bounds[2 * k + 1] = bounds[2 * k + 1] + sampling.depth;
+        sampling.spacing[k] = (sampling.bounds[2 * k + 1] - sampling.bounds[2 * k]) / (sampling.dimensions[k] - 1);
+    }
+    // Distances capped at twice the depth in order to be sure -> long time but smoothed dilation
+    sampling.maximum_distance = std::min(max_side_length, 2 * sampling.depth);
+    return true;
+}
+
+bool BezierImpl::tileSampling(const FieldSampling &sampling, const double box[6], FieldSampling &tile_sampling)
+{
+    // Samples of the whole grid covering the box
+    tile_sampling = sampling;
+    for (int k = 0; k < 3; k++)
+    {
+        int first = std::max(0, (int)std::floor((box[2 * k] - sampling.bounds[2 * k]) / sampling.spacing[k]));
+        int last = std::min(sampling.dimensions[k] - 1, (int)std::ceil((box[2 * k + 1] - sampling.bounds[2 * k]) / sampling.spacing[k]));
+        if (last - first < 1)
+            return false;
+        tile_sampling.bounds[2 * k] = sampling.bounds[2 * k] + first * sampling.spacing[k];
+        tile_sampling.bounds[2 * k + 1] = sampling.bounds[2 * k] + last * sampling.spacing[k];
+        tile_sampling.dimensions[k] = last - first + 1;
+    }
+    return true;
+}
+
+vtkSmartPointer<vtkImageData> BezierImpl::computeField(vtkSmartPointer<vtkPolyData> poly_data, const FieldSampling &sampling)
+{
+    double bounds[6];
+    std::copy(sampling.bounds, sampling.bounds + 6, bounds);
+    int dimensions[3] = {sampling.dimensions[0], sampling.dimensions[1], sampling.dimensions[2]};
+    double max_side_length = std::max(bounds[1] - bounds[0], std::max(bounds[3] - bounds[2], bounds[5] - bounds[4]));
+
+    //distance field
+    vtkSmartPointer<vtkImplicitModeller> implicitModeller = vtkSmartPointer<vtkImplicitModeller>::New();
+    implicitModeller->SetProcessModeToPerVoxel(); //optimize process  -> per voxel and not per cell
+    implicitModeller->SetSampleDimensions(dimensions);
+#if VTK_MAJOR_VERSION <= 5
+    implicitModeller->SetInput(poly_data);
+#else
+    implicitModeller->SetInputData(poly_data);
+#endif
+    implicitModeller->AdjustBoundsOff(); // model bounds are given : tiles sample the grid of the whole field
+    implicitModeller->SetModelBounds(bounds);
+    implicitModeller->SetMaximumDistance(std::min(1.0, sampling.maximum_distance / max_side_length)); // fraction of largest side
+    implicitModeller->Update();
+    return implicitModeller->GetOutput();
+}
+
+bool BezierImpl::depthField(double depth, vtkSmartPointer<vtkImageData> &field)
 {
     // Get maximum length of the sides
     double bounds[6];
     this->inputPolyData_->GetBounds(bounds);
     double max_side_length = std::max(bounds[1] - bounds[0], bounds[3] - bounds[2]);
     max_side_length = std::max(max_side_length, bounds[5] - bounds[4]);
+    if (!(max_side_length > 0))
+        return false;
     double threshold = depth / max_side_length;
+    const int samples = this->resolution_.field_samples;
 
-    //dilation
+    //distance field
     vtkSmartPointer<vtkImplicitModeller> implicitModeller = vtkSmartPointer<vtkImplicitModeller>::New();
     implicitModeller->SetProcessModeToPerVoxel(); //optimize process  -> per voxel and not per cell
-    implicitModeller->SetSampleDimensions(50, 50, 50);
+    implicitModeller->SetSampleDimensions(samples, samples, samples);
 #if VTK_MAJOR_VERSION <= 5
     implicitModeller->SetInput(this->inputPolyData_);
 #else
@@ -108,122 +493,341 @@ bool Bezier::dilatation(double depth, vtkSmartPointer<vtkPolyData> poly_data, vt
       implicitModeller->SetMaximumDistance(2*threshold); // 2*threshold in order to be sure -> long time but smoothed dilation
     implicitModeller->ComputeModelBounds(this->inputPolyData_);
     implicitModeller->Update();
+    field = implicitModeller->GetOutput();
+    return true;
+}
+
+bool BezierImpl::distanceField(double depth, vtkSmartPointer<vtkImageData> &field)
+{
+    FieldSampling sampling;
+    if (!this->fieldSampling(depth, sampling))
+        return false;
+    if (this->distance_field_ && sampling.depth == this->distance_field_depth_ && this->distance_field_grind_depth_ == this->grind_depth_)
+    {
+        field = this->distance_field_;
+        return true;
+    }
+    this->distance_field_ = this->computeField(this->inputPolyData_, sampling);
+    this->tile_fields_.clear();
+    this->distance_field_depth_ = sampling.depth;
+    this->distance_field_grind_depth_ = this->grind_depth_;
+    printf("\nDistance field : %d x %d x %d samples, up to %.1f mm", sampling.dimensions[0], sampling.dimensions[1], sampling.dimensions[2],
+           sampling.depth * 1000.0);
+    field = this->distance_field_;
+    return true;
+}
+
+int BezierImpl::numberOfTiles(vtkIdType number_of_cells)
+{
+    return BezierTiling::numberOfTiles(number_of_cells, this->tile_memory_budget_, this->parallel_tiles_);
+}
+
+Eigen::Vector3d BezierImpl::tilingAxis()
+{
+    return this->vector_dir_.cross(this->mesh_normal_vector_).normalized();
+}
 
+///@brief Iso-surface of a distance field without normals (vtkMarchingCubes, or block-parallel marching cubes, see BezierResolution::block_iso_surface)
+static vtkSmartPointer<vtkPolyData> isoSurface(vtkSmartPointer<vtkImageData> field, double value, bool block_iso_surface)
+{
+    //normals are computed once, after removal of useless cells
+    if (block_iso_surface)
+    {
+        BezierIsoSurface surface;
+        return surface.extract(field, value);
+    }
     vtkSmartPointer<vtkMarchingCubes> surface = vtkSmartPointer<vtkMarchingCubes>::New();
-    surface->SetInputConnection(implicitModeller->GetOutputPort());
-    surface->ComputeNormalsOn();
-    surface->SetValue(0, depth);
+#if VTK_MAJOR_VERSION <= 5
+    surface->SetInput(field);
+#else
+    surface->SetInputData(field);
+#endif
+    surface->ComputeNormalsOff();
+    surface->SetValue(0, value);
     surface->Update();
-    dilate_poly_data = surface->GetOutput();
+    return surface->GetOutput();
+}
 
+bool BezierImpl::selectOuterCells(vtkSmartPointer<vtkPolyData> input, const BezierMeshView &surface_view, const BezierTiling *tiling, int tile,
+                                  std::vector<unsigned char> &keep_cells, long &outward_cells)
+{
     //resolve under part of dilation (morphological dilation is usually used on volume not on surface. So, we have to adapt result to our process)
     // Build a Kdtree
     vtkSmartPointer<vtkKdTreePointLocator> kDTree = vtkSmartPointer<vtkKdTreePointLocator>::New();
-    kDTree->SetDataSet(this->inputPolyData_);
+    kDTree->SetDataSet(input);
     kDTree->BuildLocator();
-    //Build cell and link in dilate_poly_data
-    dilate_poly_data->BuildCells();
-    dilate_poly_data->BuildLinks();
-    // Get normal tab
-    vtkFloatArray *PointNormalArray = vtkFloatArray::SafeDownCast(this->inputPolyData_->GetPointData()->GetNormals());
-    if (!PointNormalArray)
+    // Flat view on input mesh (points, triangles and normals)
+    BezierMeshView input_view(input);
+    if (!input_view.hasNormals())
         return false;
+    keep_cells.assign(surface_view.numberOfTriangles(), 0);
+    outward_cells = 0; //number of kept cells whose triangle ordering gives an outward normal (from input mesh)
     // For each cell in dilate_polydata
-    for (vtkIdType index_cell = 0; index_cell < (dilate_poly_data->GetNumberOfCells()); index_cell++)
-    {
-        // Get cell
-        vtkCell* cell = dilate_poly_data->GetCell(index_cell);
-        // Get center of cell
-        double pcoords[3] = {0, 0, 0};
-        double *weights = new double[dilate_poly_data->GetMaxCellSize()];
-        int subId = cell->GetParametricCenter(pcoords);
-        double cellCenter[3] = {0, 0, 0};
-        cell->EvaluateLocation(subId, pcoords, cellCenter, weights);
+    for (vtkIdType index_cell = 0; index_cell < surface_view.numberOfTriangles(); index_cell++)
+    {
+        if (!tiling && !this->progress_.keepGoing()) //tiles are checked by tiledDilatation
+            return false;
+        // Get center of cell (triangle centroid)
+        const vtkIdType *triangle = surface_view.triangle(index_cell);
+        const float *a = surface_view.point(triangle[0]);
+        const float *b = surface_view.point(triangle[1]);
+        const float *c = surface_view.point(triangle[2]);
+        double cellCenter[3] = {(a[0] + b[0] + c[0]) / 3.0, (a[1] + b[1] + c[1]) / 3.0, (a[2] + b[2] + c[2]) / 3.0};
+        if (!vtkMath::IsFinite(cellCenter[0]) || !vtkMath::IsFinite(cellCenter[1]) || !vtkMath::IsFinite(cellCenter[2]))
+            continue;
+        // Cells of a tile are only kept in its core (each cell belongs to one tile)
+        if (tiling)
+        {
+            const float center[3] = {(float)cellCenter[0], (float)cellCenter[1], (float)cellCenter[2]};
+            if (!tiling->inCore(tile, tiling->project(center)))
+                continue;
+        }
         // Get closest point (in input_polydata)
         vtkIdType iD = kDTree->FindClosestPoint(cellCenter);
-        double closestPoint[3];
-        this->inputPolyData_->GetPoint(iD, closestPoint);
+        const float *closestPoint = input_view.point(iD);
         // Get direction vector
         Eigen::Vector3d direction_vector = Eigen::Vector3d(cellCenter[0] - closestPoint[0],
                                                            cellCenter[1] - closestPoint[1],
                                                            cellCenter[2] - closestPoint[2]);
-
         // Get closest point normal
-        double normal[3];
-        PointNormalArray->GetTuple(iD, normal);
+        const float *normal = input_view.normal(iD);
         Eigen::Vector3d normal_vector(normal[0], normal[1], normal[2]);
         // Normalize vectors
         direction_vector.normalize();
         normal_vector.normalize();
         // Test in order to save or remove cell
-        if (!vtkMath::IsFinite(cellCenter[0]) ||
-            !vtkMath::IsFinite(cellCenter[1]) ||
-            !vtkMath::IsFinite(cellCenter[2]) || normal_vector.dot(direction_vector) <= 0)
-            dilate_poly_data->DeleteCell(index_cell);
+        keep_cells[index_cell] = (normal_vector.dot(direction_vector) > 0);
+        // Orientation of triangle ordering
+        if (keep_cells[index_cell])
+        {
+            Eigen::Vector3d ab(b[0] - a[0], b[1] - a[1], b[2] - a[2]);
+            Eigen::Vector3d ac(c[0] - a[0], c[1] - a[1], c[2] - a[2]);
+            if (ab.cross(ac).dot(direction_vector) > 0)
+                outward_cells++;
+        }
+    }
+    return true;
+}
+
+bool BezierImpl::dilatation(double depth, vtkSmartPointer<vtkPolyData> /*poly_data*/, vtkSmartPointer<vtkPolyData> &dilate_poly_data)
+{
+    if (this->point_cloud_)
+        return this->offsetCloud(depth, dilate_poly_data);
+    if (this->numberOfTiles(this->inputPolyData_->GetNumberOfCells()) > 1)
+        return this->tiledDilatation(depth, dilate_poly_data); //tiles are not kept (memory budget)
+
+    // Passes and extrication meshes are dilated at multiples of grind depth : these dilations are kept
+    const double multiple = (this->grind_depth_ > 0) ? depth / this->grind_depth_ : 0;
+    const int index = (int)std::floor(multiple + 0.5) - 1;
+    const bool cached = (index >= 0 && std::abs(multiple - (index + 1)) < 1e-6);
+    if (cached && this->dilation_cache_grind_depth_ != this->grind_depth_)
+    {
+        this->dilation_cache_.clear();
+        this->dilation_cache_grind_depth_ = this->grind_depth_;
+    }
+    if (cached && index < (int)this->dilation_cache_.size() && this->dilation_cache_[index])
+    {
+        dilate_poly_data = vtkSmartPointer<vtkPolyData>::New();
+        dilate_poly_data->ShallowCopy(this->dilation_cache_[index]);
+        return true;
+    }
+    if (!this->computeDilatation(depth, dilate_poly_data))
+        return false;
+    if (cached)
+    {
+        if (index >= (int)this->dilation_cache_.size())
+            this->dilation_cache_.resize(index + 1);
+        this->dilation_cache_[index] = dilate_poly_data;
+        dilate_poly_data = vtkSmartPointer<vtkPolyData>::New();
+        dilate_poly_data->ShallowCopy(this->dilation_cache_[index]);
     }
-    //remove all deleted cells
-    dilate_poly_data->RemoveDeletedCells();
+    return true;
+}
+
+/** fixme dilation problem detected : when depth is to high, dilated mesh has unexpected holes
+ * These holes are problematic. In fact, when cutting process is called on dilated mesh, slices are divided in some parts due to these holes
+ * and this affects the path generation, especially for extrical trajectory. We have to find a solution, perhaps find best parameters
+ * in order to resolve this problem.
+ */
+bool BezierImpl::computeDilatation(double depth, vtkSmartPointer<vtkPolyData> &dilate_poly_data)
+{
+    //dilation : iso-surface of distance field (one field per depth, or one field shared by passes)
+    vtkSmartPointer<vtkImageData> field;
+    if (this->resolution_.shared_field ? !this->distanceField(depth, field) : !this->depthField(depth, field))
+        return false;
+    dilate_poly_data = isoSurface(field, depth, this->resolution_.block_iso_surface);
+
+    // Flat view on dilated mesh (points, triangles)
+    BezierMeshView dilate_view(dilate_poly_data);
+    std::vector<unsigned char> keep_cells;
+    long outward_cells(0);
+    if (!this->selectOuterCells(this->inputPolyData_, dilate_view, NULL, 0, keep_cells, outward_cells))
+        return false;
+    //remove outside cells and their points
+    dilate_poly_data = dilate_view.extractTriangles(keep_cells);
     //check dilated_polydata size
     if(dilate_poly_data->GetNumberOfCells()==0)
         return false;
-    return true;
+    //point normals of dilated mesh are oriented towards input mesh
+    return this->normals_.compute(dilate_poly_data, 2 * outward_cells > dilate_poly_data->GetNumberOfCells());
 }
 
-bool Bezier::defaultIntersectionOptimisation(vtkSmartPointer<vtkPolyData> &poly_data){
+bool BezierImpl::tiledDilatation(double depth, vtkSmartPointer<vtkPolyData> &dilate_poly_data)
+{
+    BezierMeshView input_view(this->inputPolyData_);
+    if (!input_view.hasNormals())
+        return false;
+    BezierTiling tiling(input_view, this->tilingAxis(), this->numberOfTiles(input_view.numberOfTriangles()));
+    const int number_of_tiles = tiling.numberOfTiles();
+    // Tiles sample the grid of the whole field : iso-surfaces of neighbour tiles meet on tile borders
+    FieldSampling sampling;
+    if (!this->fieldSampling(depth, sampling))
+        return false;
+    const bool cached = ((int)this->tile_fields_.size() == number_of_tiles && sampling.depth == this->distance_field_depth_
+            && this->distance_field_grind_depth_ == this->grind_depth_);
+    if (!cached)
+    {
+        this->distance_field_ = NULL;
+        this->tile_fields_.assign(number_of_tiles, vtkSmartPointer<vtkImageData>());
+        printf("\nDistance field : %d x %d x %d samples, up to %.1f mm, %d tiles", sampling.dimensions[0], sampling.dimensions[1],
+               sampling.dimensions[2], sampling.depth * 1000.0, number_of_tiles);
+    }
+    // Capped distances and closest points in a tile core only depend on input cells closer than margin
+    const double min_spacing = std::min(sampling.spacing[0], std::min(sampling.spacing[1], sampling.spacing[2]));
+    const double max_spacing = std::max(sampling.spacing[0], std::max(sampling.spacing[1], sampling.spacing[2]));
+    const double margin = sampling.maximum_distance + 3 * max_spacing;
+
+    std::vector<vtkSmartPointer<vtkPolyData> > pieces(number_of_tiles);
+    std::vector<long> outward_cells(number_of_tiles, 0);
+    bool stop = false;
+#pragma omp parallel for schedule(dynamic, 1) num_threads(this->parallel_tiles_)
+    for (int tile = 0; tile < number_of_tiles; tile++)
+    {
+        bool keep_going;
+#pragma omp critical (bezier_progress)
+        {
+            stop = stop || !this->progress_.keepGoing();
+            keep_going = !stop;
+        }
+        if (!keep_going)
+            continue;
+        vtkSmartPointer<vtkPolyData> tile_input = tiling.extract(tile, margin);
+        if (tile_input->GetNumberOfCells() == 0)
+            continue;
+        //////////// DISTANCE FIELD OF TILE : SAMPLES OF THE WHOLE GRID AROUND TILE ////////////
+        if (!cached)
+        {
+            double box[6];
+            tile_input->GetBounds(box);
+            for (int k = 0; k < 3; k++)
+            {
+                box[2 * k] -= sampling.depth;
+                box[2 * k + 1] += sampling.depth;
+            }
+            FieldSampling tile_sampling;
+            if (tileSampling(sampling, box, tile_sampling))
+                this->tile_fields_[tile] = this->computeField(tile_input, tile_sampling);
+        }
+        if (!this->tile_fields_[tile])
+            continue;
+        //////////// ISO-SURFACE OF TILE CORE ////////////
+        BezierMeshView surface_view(isoSurface(this->tile_fields_[tile], depth, this->resolution_.block_iso_surface));
+        std::vector<unsigned char> keep_cells;
+        if (this->selectOuterCells(tile_input, surface_view, &tiling, tile, keep_cells, outward_cells[tile]))
+            pieces[tile] = surface_view.extractTriangles(keep_cells);
+    }
+    if (stop)
+        return false;
+    this->distance_field_depth_ = sampling.depth;
+    this->distance_field_grind_depth_ = this->grind_depth_;
+
+    //////////// APPEND TILE CORES AND WELD POINTS OF TILE BORDERS ////////////
+    vtkSmartPointer<vtkAppendPolyData> append = vtkSmartPointer<vtkAppendPolyData>::New();
+    long total_outward_cells(0);
+    for (int tile = 0; tile < number_of_tiles; tile++)
+    {
+        if (!pieces[tile] || pieces[tile]->GetNumberOfCells() == 0)
+            continue;
+#if VTK_MAJOR_VERSION <= 5
+        append->AddInput(pieces[tile]);
+#else
+        append->AddInputData(pieces[tile]);
+#endif
+        total_outward_cells += outward_cells[tile];
+    }
+    if (append->GetNumberOfInputConnections(0) == 0)
+        return false;
+    vtkSmartPointer<vtkCleanPolyData> clean = vtkSmartPointer<vtkCleanPolyData>::New();
+    clean->SetInputConnection(append->GetOutputPort());
+    clean->PointMergingOn();
+    clean->ToleranceIsAbsoluteOn();
+    clean->SetAbsoluteTolerance(1e-3 * min_spacing); // same samples give the same points, up to rounding
+    clean->ConvertPolysToLinesOff();
+    clean->ConvertLinesToPointsOff();
+    clean->ConvertStripsToPolysOff();
+    clean->Update();
+    dilate_poly_data = clean->GetOutput();
+    if (dilate_poly_data->GetNumberOfCells() == 0)
+        return false;
+    //point normals of dilated mesh are oriented towards input mesh
+    return this->normals_.compute(dilate_poly_data, 2 * total_outward_cells > dilate_poly_data->GetNumberOfCells());
+}
+
+bool BezierImpl::defaultIntersectionOptimisation(vtkSmartPointer<vtkPolyData> &poly_data){
+        if (this->point_cloud_)
+            return this->defaultIntersectionCloud(poly_data);
         bool intersection_flag = false;
         // Build a Kdtree on default
         vtkSmartPointer<vtkKdTreePointLocator> kDTreeDefault = vtkSmartPointer<vtkKdTreePointLocator>::New();
         kDTreeDefault->SetDataSet(this->defaultPolyData_);
         kDTreeDefault->BuildLocator();
-        vtkFloatArray *defaultPointNormalArray = vtkFloatArray::SafeDownCast(this->defaultPolyData_->GetPointData()->GetNormals());
+        // Flat views on meshes (points, triangles and normals)
+        BezierMeshView default_view(this->defaultPolyData_);
+        if (!default_view.hasNormals())
+            return false;
+        BezierMeshView view(poly_data);
+        std::vector<unsigned char> keep_cells(view.numberOfTriangles(), 0);
         // For each cell in dilate polydata
-        for (vtkIdType index_cell = 0; index_cell < (poly_data->GetNumberOfCells()); index_cell++)
+        for (vtkIdType index_cell = 0; index_cell < view.numberOfTriangles(); index_cell++)
         {
-            // Get cell
-            vtkCell* cell = poly_data->GetCell(index_cell);
+            if (!this->progress_.keepGoing())
+                return false;
             //get points of cell
-            vtkPoints * pts = cell->GetPoints();
-            //variable test use to know points position
-            bool inside=false;
-            for(int index_pt=0; index_pt<pts->GetNumberOfPoints(); index_pt++){
+            const vtkIdType *triangle = view.triangle(index_cell);
+            for(int index_pt=0; index_pt<3; index_pt++){
                 //get point
-                double pt[3];
-                pts->GetPoint(index_pt,pt);
+                const float *p = view.point(triangle[index_pt]);
+                double pt[3] = {p[0], p[1], p[2]};
+                if (!vtkMath::IsFinite(pt[0]) || !vtkMath::IsFinite(pt[1]) || !vtkMath::IsFinite(pt[2]))
+                    continue;
                 //get closest point (in defautPolyData)
                 vtkIdType iD = kDTreeDefault->FindClosestPoint(pt);
-                double closestPoint[3];
-                this->defaultPolyData_->GetPoint(iD, closestPoint);
+                const float *closestPoint = default_view.point(iD);
                 //get direction vector
                 Eigen::Vector3d direction_vector = Eigen::Vector3d(closestPoint[0] - pt[0],
                                                                    closestPoint[1] - pt[1],
                                                                    closestPoint[2] - pt[2] );
                 //get closest point normal
-                double normal[3];
-                defaultPointNormalArray->GetTuple(iD, normal);
+                const float *normal = default_view.normal(iD);
                 Eigen::Vector3d normal_vector(normal[0], normal[1], normal[2]);
                 //normalize vectors
                 direction_vector.normalize();
                 normal_vector.normalize();
                 //Test in order to save or remove cell
-                if (vtkMath::IsFinite(pt[0]) &&
-                    vtkMath::IsFinite(pt[1]) &&
-                    vtkMath::IsFinite(pt[2]) && normal_vector.dot(direction_vector) > 0.1) //fixme threshold use for corner (90° angle) : It resolves problem with neighbor and dot product
+                if (normal_vector.dot(direction_vector) > 0.1) //fixme threshold use for corner (90° angle) : It resolves problem with neighbor and dot product
                 {
-                    inside = true;
+                    keep_cells[index_cell] = 1; //inside
                     intersection_flag = true;
                     break;
                 }
             }
-            if (!inside)
-                poly_data->DeleteCell(index_cell);
-
         }
-        //remove all deleted cells ( outside cells)
-        poly_data->RemoveDeletedCells();
+        //remove outside cells and their points
+        poly_data = view.extractTriangles(keep_cells);
         return intersection_flag;
 }
 
-bool Bezier::generateCellNormals(vtkSmartPointer<vtkPolyData> &poly_data){
+bool BezierImpl::generateCellNormals(vtkSmartPointer<vtkPolyData> &poly_data){
     vtkSmartPointer<vtkPolyDataNormals> normals = vtkSmartPointer<vtkPolyDataNormals>::New();
     normals->SetInputData(poly_data);
     normals->ComputeCellNormalsOn();
@@ -240,22 +844,12 @@ bool Bezier::generateCellNormals(vtkSmartPointer<vtkPolyData> &poly_data){
     return true;
 }
 
-bool Bezier::generatePointNormals(vtkSmartPointer<vtkPolyData> &poly_data){
-    vtkSmartPointer<vtkPolyDataNormals> normals = vtkSmartPointer<vtkPolyDataNormals>::New();
-    normals->SetInputData(poly_data);
-    normals->ComputeCellNormalsOff();
-    normals->ComputePointNormalsOn();
-    normals->Update();
-    poly_data = normals->GetOutput();
-    vtkFloatArray *PointNormalArray = vtkFloatArray::SafeDownCast(poly_data->GetPointData()->GetNormals());
-
-    if (!PointNormalArray)
-        return false;
-
-    return true;
+bool BezierImpl::generatePointNormals(vtkSmartPointer<vtkPolyData> &poly_data){
+    //area-weighted normals, computed once per mesh version
+    return this->normals_.compute(poly_data);
 }
 
-void Bezier::ransac(){
+void BezierImpl::ransac(){
     //Get polydata point cloud (PCL)
     pcl::PolygonMesh mesh;
     pcl::VTKUtils::vtk2mesh(this->inputPolyData_, mesh);
@@ -286,54 +880,37 @@ void Bezier::ransac(){
                                                 model_coefficients.values[2]);
 }
 
-void Bezier::generateDirection(){
+void BezierImpl::generateDirection(){
     //find to simple orthogonal vectors to mesh_normal
     Eigen::Vector3d x_vector = Eigen::Vector3d(this->mesh_normal_vector_[2], 0, -this->mesh_normal_vector_[0]);
-    Eigen::Vector3d y_vector = Eigen::Vector3d(0, this->mesh_normal_vector_[2], -this->mesh_normal_vector_[1]);
-    //by default, we chose x_vector. But another vector in this plan could be choose.
+    //by default, we chose x_vector. But another vector in this plan could be choose (y_vector = (0, normal[2], -normal[1])).
     x_vector.normalize();
     this->vector_dir_ = x_vector;
 }
 
-unsigned int Bezier::determineSliceNumberExpected(vtkSmartPointer<vtkPolyData> poly_data, Eigen::Vector3d vector_dir){
-    // Init with extreme values
-    double min_value = DBL_MAX;
-    double max_value = DBL_MIN;
-    //Get point cloud from polydata : We have to use points of cells and not point cloud directly.
-    //In fact, in dilation process, several cells have been deleted. Yet, none of points has been deleted.
-    for (vtkIdType index_cell = 0; index_cell < (poly_data->GetNumberOfCells()); index_cell++)
-    {
-        // Get cell
-        vtkCell* cell = poly_data->GetCell(index_cell);
-        //get points of cell
-        vtkPoints * pts = cell->GetPoints();
-        for (int i = 0; i < pts->GetNumberOfPoints(); i++)
-        {
-            double p[3];
-            pts->GetPoint(i, p);
-            Eigen::Vector3d point(p[0], p[1], p[2]);
-            double value = point.dot(vector_dir);
-            if (value > max_value)
-                max_value = value;
-            if (value < min_value)
-                min_value = value;
-        }
-    }
+unsigned int BezierImpl::determineSliceNumberExpected(vtkSmartPointer<vtkPolyData> poly_data, Eigen::Vector3d vector_dir){
+    //Get point cloud from polydata : dilated meshes are compacted (BezierMeshView::extractTriangles) so every point belongs to a cell.
+    BezierMeshView view(poly_data);
+    BezierScalar min_value, max_value;
+    if (!Geometry::projectionRange(view.points(), view.numberOfPoints(), vector_dir.cast<BezierScalar>(), min_value, max_value))
+        return 0;
     //Virtual effector size = effector size * (1- covering%)
     //Distance we have to cut = max_value - min_value
     double virtual_effector_diameter = this->effector_diameter_ * (1 - this->covering_);
     double distance = max_value - min_value;
-    return std::ceil(distance / virtual_effector_diameter);
+    return std::ceil(distance / (virtual_effector_diameter * this->resolution_.slice_spacing));
 }
 
-unsigned int Bezier::getRealSliceNumber(vtkSmartPointer<vtkStripper> stripper, Eigen::Vector3d vector_dir){
-    vtkIdType numberOfLines = stripper->GetOutput()->GetNumberOfLines();
-    vtkPoints *points = stripper->GetOutput()->GetPoints();
-    vtkCellArray *cells = stripper->GetOutput()->GetLines();
+unsigned int BezierImpl::getRealSliceNumber(vtkSmartPointer<vtkPolyData> slices, Eigen::Vector3d vector_dir){
+    vtkPoints *points = slices->GetPoints();
+    vtkCellArray *cells = slices->GetLines();
+    if (!points || !cells)
+        return 0;
     vtkIdType *indices;
     vtkIdType numberOfPoints;
     unsigned int lineCount = 0;
-    std::vector<double> dot_vector;
+    std::vector<BezierScalar> dot_vector;
+    dot_vector.reserve(cells->GetNumberOfCells());
     //For all lines
     for (cells->InitTraversal(); cells->GetNextCell(numberOfPoints, indices); lineCount++)
     {
@@ -345,34 +922,42 @@ unsigned int Bezier::getRealSliceNumber(vtkSmartPointer<vtkStripper> stripper, E
         points->GetPoint(indices[indice], point);
         //scalar product between vector_dir and point[0] vector
         Eigen::Vector3d point_vector(point[0], point[1], point[2]);
-        double dot = vector_dir.dot(point_vector);
         //For each scalar products, push back to a vector
-        dot_vector.push_back(dot);
+        dot_vector.push_back(vector_dir.dot(point_vector));
     }
-    if (dot_vector.size() == 0) //if vector size is null return 0
-        return 0;
-    //else sort vector
-    std::sort(dot_vector.begin(), dot_vector.end());
-    //Remove duplicated value or too close values
-    int index = 0;
-    double value = (this->effector_diameter_*(1-this->covering_))/(2*10); //2 to get rayon, 10 to get 10% of virtual rayon as threshold
-    while (index < (dot_vector.size() - 1))
-    {
-        if (std::abs(dot_vector[index] - dot_vector[index + 1]) < value)
-        {
-            dot_vector.erase(dot_vector.begin() + index + 1);
-        }
-        //whitout threshold :
-        /*if (dot_vector[index] == dot_vector[index + 1])
-         dot_vector.erase(dot_vector.begin() + index + 1);*/
-        else
-            index++;
-    }
-    //Return size of vector (equal real number of lines)
-    return dot_vector.size();
+    //Remove duplicated value or too close values and return real number of lines
+    BezierScalar value = (this->effector_diameter_*(1-this->covering_))/(2*10); //2 to get rayon, 10 to get 10% of virtual rayon as threshold
+    return Geometry::countDistinctValues(dot_vector, value);
 }
 
-bool Bezier::cutMesh(vtkSmartPointer<vtkPolyData> poly_data, Eigen::Vector3d cut_dir, unsigned int line_number_expected, vtkSmartPointer<vtkStripper> &stripper){
+///@brief Cut a mesh with number_of_slices planes normal to cut_dir between origin+min_value*cut_dir and origin+max_value*cut_dir
+static vtkSmartPointer<vtkPolyData> cutSlices(vtkSmartPointer<vtkPolyData> poly_data, const double origin[3], const Eigen::Vector3d &cut_dir,
+                                              int number_of_slices, double min_value, double max_value)
+{
+    // Create a plane to cut mesh
+    vtkSmartPointer<vtkPlane> plane = vtkSmartPointer<vtkPlane>::New();
+    plane->SetOrigin(origin[0], origin[1], origin[2]);
+    plane->SetNormal(cut_dir[0], cut_dir[1], cut_dir[2]);
+    // Create a cutter
+    vtkSmartPointer<vtkCutter> cutter = vtkSmartPointer<vtkCutter>::New();
+    cutter->SetCutFunction(plane);
+#if VTK_MAJOR_VERSION <= 5
+    cutter->SetInput(poly_data);
+#else
+    cutter->SetInputData(poly_data);
+#endif
+    cutter->GenerateValues(number_of_slices, min_value, max_value);
+    // VTK triangle filter used for stripper
+    vtkSmartPointer<vtkTriangleFilter> triangleFilter = vtkSmartPointer<vtkTriangleFilter>::New();
+    triangleFilter->SetInputConnection(cutter->GetOutputPort());
+    // VTK Stripper used to generate polylines from cutter
+    vtkSmartPointer<vtkStripper> stripper = vtkSmartPointer<vtkStripper>::New();
+    stripper->SetInputConnection(triangleFilter->GetOutputPort());
+    stripper->Update();
+    return stripper->GetOutput();
+}
+
+bool BezierImpl::cutMesh(vtkSmartPointer<vtkPolyData> poly_data, Eigen::Vector3d cut_dir, unsigned int line_number_expected, vtkSmartPointer<vtkPolyData> &slices, bool tiled){
     // Get info about polyData : center point & bounds
     double minBound[3];
     minBound[0] = poly_data->GetBounds()[0];
@@ -394,217 +979,206 @@ bool Bezier::cutMesh(vtkSmartPointer<vtkPolyData> poly_data, Eigen::Vector3d cut
 
     // Direction for cutter
     cut_dir.normalize();
+    if (poly_data->GetNumberOfPoints() == 0)
+        return false;
+
+    // Big meshes are cut tile by tile : every tile is cut by the same planes (center and bounds of the whole mesh)
+    const int number_of_tiles = (tiled && !this->point_cloud_) ? this->numberOfTiles(poly_data->GetNumberOfCells()) : 1;
+    boost::scoped_ptr<BezierMeshView> view;
+    boost::scoped_ptr<BezierTiling> tiling;
+    if (number_of_tiles > 1)
+    {
+        view.reset(new BezierMeshView(poly_data));
+        tiling.reset(new BezierTiling(*view, this->tilingAxis(), number_of_tiles));
+    }
 
-    // Create a plane to cut mesh
-    vtkSmartPointer<vtkPlane> plane = vtkSmartPointer<vtkPlane>::New();
-    plane->SetOrigin(poly_data->GetCenter());
-    plane->SetNormal(cut_dir[0], cut_dir[1], cut_dir[2]);
-    // Create a cutter
-    vtkSmartPointer<vtkCutter> cutter = vtkSmartPointer<vtkCutter>::New();
-    cutter->SetCutFunction(plane);
-#if VTK_MAJOR_VERSION <= 5
-    cutter->SetInput(poly_data);
-#else
-    cutter->SetInputData(poly_data);
-#endif
-    cutter->Update();
     // Check real number of lines : if holes in mesh, number of lines returns by vtk is wrong
+    // Each retry adds one cutting plane : give up when planes are doubled (slices missing in holes can't be recovered)
+    const int max_retries = std::max((int)line_number_expected, 1);
     int line_number_real(0);
     int temp(0);
-    while (line_number_real < line_number_expected)
-    {
-        cutter->GenerateValues(line_number_expected + temp, -distanceMin, distanceMax);
-        cutter->Update();
-        // VTK triangle filter used for stripper
-        vtkSmartPointer<vtkTriangleFilter> triangleFilter = vtkSmartPointer<vtkTriangleFilter>::New();
-        triangleFilter->SetInputConnection(cutter->GetOutputPort());
-        triangleFilter->Update();
-        // VTK Stripper used to generate polylines from cutter
-        stripper->SetInputConnection(triangleFilter->GetOutputPort());
-        stripper->Update();
-
-        line_number_real = this->getRealSliceNumber(stripper, cut_dir);
-        if (line_number_real < line_number_expected)
+    while (line_number_real < (int)line_number_expected)
+    {
+        if (!this->progress_.keepGoing())
+            return false;
+        if (temp > max_retries)
+        {
+            printf("\nCan't cut %u slices : %d slices found with %u planes", line_number_expected, line_number_real,
+                   line_number_expected + temp - 1);
+            return false;
+        }
+        if (number_of_tiles > 1)
+        {
+            std::vector<vtkSmartPointer<vtkPolyData> > pieces(number_of_tiles);
+#pragma omp parallel for schedule(dynamic, 1) num_threads(this->parallel_tiles_)
+            for (int tile = 0; tile < number_of_tiles; tile++)
+                pieces[tile] = cutSlices(tiling->extract(tile, 0), center, cut_dir, line_number_expected + temp, -distanceMin, distanceMax);
+            vtkSmartPointer<vtkAppendPolyData> append = vtkSmartPointer<vtkAppendPolyData>::New();
+            for (int tile = 0; tile < number_of_tiles; tile++)
+#if VTK_MAJOR_VERSION <= 5
+                append->AddInput(pieces[tile]);
+#else
+                append->AddInputData(pieces[tile]);
+#endif
+            append->Update();
+            slices = append->GetOutput();
+        }
+        else if (this->point_cloud_)
+            slices = this->sliceCloud(poly_data, center, cut_dir, line_number_expected + temp, -distanceMin, distanceMax);
+        else
+            slices = cutSlices(poly_data, center, cut_dir, line_number_expected + temp, -distanceMin, distanceMax);
+
+        line_number_real = this->getRealSliceNumber(slices, cut_dir);
+        if (line_number_real < (int)line_number_expected)
             temp++;
-        std::cout << "\nExpected : " << line_number_expected << " returned : "
-                << stripper->GetOutput()->GetNumberOfLines() << " calculated : " << line_number_real << std::endl;
     }
+    if (number_of_tiles > 1)
+        printf("\n  -> cut in %d tiles", number_of_tiles);
     return true;
 }
 
-bool Bezier::generateRobotPoses(Eigen::Vector3d point, Eigen::Vector3d point_next, Eigen::Vector3d normal, Eigen::Affine3d &pose){
-    Eigen::Vector3d normal_x(Eigen::Vector3d().Identity());
-    Eigen::Vector3d normal_y(Eigen::Vector3d().Identity());
-    Eigen::Vector3d normal_z= Eigen::Vector3d(normal[0],normal[1],normal[2]);
-    normal_x = point_next-point; //next point direction
-    if (normal_x == Eigen::Vector3d::Zero())
+bool BezierImpl::generateRobotPoses(const Geometry::Vector3 &point, const Geometry::Vector3 &point_next, const Geometry::Vector3 &normal, Eigen::Affine3d &pose){
+    if (point_next == point)
     {
         PCL_ERROR("X normal = 0, mesh is too dense or duplicate points in the line!\n");
         return false;
     }
-    normal_y = normal_z.cross(normal_x); //determined using others normal vectors
-
-    normal_x.normalize();
-    normal_y.normalize();
-    normal_z.normalize();
-
-    // Check if pose has NAN values
-    if(!vtkMath::IsFinite((float)normal_y[0]) || !vtkMath::IsFinite((float)normal_y[1]) || !vtkMath::IsFinite((float)normal_y[2]))
-        return false;
-    //else generate matrix(pose)
-    //->translation
-    pose.translation() << point[0],point[1],point[2];
-    //->rotation
-    pose.linear().col(0) << normal_x[0], normal_x[1], normal_x[2];
-    pose.linear().col(1) << normal_y[0], normal_y[1], normal_y[2];
-    pose.linear().col(2) << normal_z[0], normal_z[1], normal_z[2];
-
-    return true;
+    return Geometry::generateRobotPose(point, point_next, normal, pose);
 }
 
-bool Bezier::checkOrientation(std::vector<std::vector<std::pair<Eigen::Vector3d, Eigen::Vector3d> > > &lines)
+bool BezierImpl::checkOrientation(Geometry::Lines &lines)
 {
     // Get vector reference
-    Eigen::Vector3d reference = this->vector_dir_.cross(this->mesh_normal_vector_);
+    Geometry::Vector3 reference = this->vector_dir_.cross(this->mesh_normal_vector_).cast<BezierScalar>();
     reference.normalize();
 
     //Compare orientation of lines with reference
-    for (int line_index = 0; line_index < lines.size(); line_index++)
+    for (size_t line_index = 0; line_index < lines.size(); line_index++)
     {
+        if (lines[line_index].empty())
+            continue;
         // Get line orientation
         int point_number = lines[line_index].size();
-        Eigen::Vector3d vector_orientation = lines[line_index][point_number - 1].first - lines[line_index][0].first;
+        Geometry::Vector3 vector_orientation = lines[line_index][point_number - 1].first - lines[line_index][0].first;
         vector_orientation.normalize();
         //Compare (Check orientation)
         if (reference.dot(vector_orientation) < 0) //dot product<0 so, vectors have opposite orientation.
             std::reverse(lines[line_index].begin(), lines[line_index].end()); // change orientation of line
     }
+    return true;
 }
 
-void Bezier::removeNearNeighborPoints(std::vector<std::vector<std::pair<Eigen::Vector3d, Eigen::Vector3d> > > &lines){
-    //for each points
-    for(int index_line=0; index_line<lines.size();index_line++){
-        for(int index_point=0; index_point<(lines[index_line].size()-1);index_point++){
-            Eigen::Vector3d point_vector = lines[index_line][index_point].first; //get point position
-            Eigen::Vector3d next_point_vector = lines[index_line][index_point+1].first; //get next point position
-            double point[3] = {point_vector[0],point_vector[1],point_vector[2]};
-            double next_point[3] = {next_point_vector[0],next_point_vector[1],next_point_vector[2]};
-            if(sqrt(vtkMath::Distance2BetweenPoints(point, next_point))<0.001){ //fixme arbitrary value
-                if(index_point<(lines[index_line].size()-2))
-                    lines[index_line].erase(lines[index_line].begin()+index_point+1);
-                else
-                    lines[index_line].erase(lines[index_line].begin()+index_point);
-            }
-        }
-    }
+void BezierImpl::removeNearNeighborPoints(Geometry::Lines &lines){
+    Geometry::removeNearNeighborPoints(lines, 0.001); //fixme arbitrary value
 }
 
-bool Bezier::generateStripperOnSurface(vtkSmartPointer<vtkPolyData> PolyData, std::vector<std::vector<std::pair<Eigen::Vector3d, Eigen::Vector3d> > > &lines){
+bool BezierImpl::generateStripperOnSurface(vtkSmartPointer<vtkPolyData> PolyData, Geometry::Lines &lines){
     // Set slice number (With covering)
     unsigned int slice_number_expected = this->determineSliceNumberExpected(PolyData, this->vector_dir_);
     // Cut mesh
-    vtkSmartPointer<vtkStripper> stripper = vtkSmartPointer<vtkStripper>::New();
-    cutMesh(PolyData, this->vector_dir_, slice_number_expected, stripper); // fil this stripper with cutMesh function
+    vtkSmartPointer<vtkPolyData> slices;
+    if (!cutMesh(PolyData, this->vector_dir_, slice_number_expected, slices, true)) // fil slices with cutMesh function
+        return false;
     //// ************************** ///////////
     ///fixme At the moment we use vector to reorganize data from stripper
     ///      In the future, we must change that in order to use stripper only
     //// ************************** ///////////
     // Get data from stripper
-    vtkIdType numberOfLines = stripper->GetOutput()->GetNumberOfLines();
-    vtkPoints *points = stripper->GetOutput()->GetPoints();
-    vtkCellArray *cells = stripper->GetOutput()->GetLines();
+    vtkIdType numberOfLines = slices->GetNumberOfLines();
+    vtkPoints *points = slices->GetPoints();
+    vtkCellArray *cells = slices->GetLines();
     vtkIdType *indices;
     vtkIdType numberOfPoints;
     unsigned int lineCount = 0;
     // Get normal array of stripper
-    vtkFloatArray *PointNormalArray = vtkFloatArray::SafeDownCast(stripper->GetOutput()->GetPointData()->GetNormals());
-    if (!PointNormalArray)
+    vtkFloatArray *PointNormalArray = vtkFloatArray::SafeDownCast(slices->GetPointData()->GetNormals());
+    if (!PointNormalArray || !points || !cells)
         return false;
+    Geometry::Lines fragments; // a slice can be broken in several fragments by mesh holes
+    fragments.reserve(numberOfLines);
     for (cells->InitTraversal(); cells->GetNextCell(numberOfPoints, indices); lineCount++) //for each line : iterator
     {
-        std::vector<std::pair<Eigen::Vector3d, Eigen::Vector3d> > line; // line.first : point position, line.second : point normal
+        fragments.push_back(Geometry::Line()); // built in place : no copy of the line
+        Geometry::Line &line = fragments.back(); // line.first : point position, line.second : point normal
+        line.reserve(numberOfPoints);
         for (vtkIdType i = 0; i < numberOfPoints; i++)
         {
             //Get points
             double point[3];
             points->GetPoint(indices[i], point);
-            Eigen::Vector3d point_vector(point[0],point[1],point[2]);
+            Geometry::Vector3 point_vector(point[0],point[1],point[2]);
             //Get Z normal
             double normal[3];
             PointNormalArray->GetTuple(indices[i], normal);
-            Eigen::Vector3d normal_vector(normal[0],normal[1],normal[2]);
+            Geometry::Vector3 normal_vector(normal[0],normal[1],normal[2]);
             if(PolyData==this->inputPolyData_)
                 normal_vector *=-1;
             //add to line vector
             line.push_back(std::make_pair(point_vector,normal_vector));
         }
-        lines.push_back(line);
     }
-    // Sort vector : re order lines
-    std::sort(lines.begin(), lines.end(), lineOrganizerStruct(this));
+    // Stitch fragments of a same plane (same threshold as getRealSliceNumber)
+    Geometry::Vector3 reference = this->vector_dir_.cross(this->mesh_normal_vector_).cast<BezierScalar>();
+    reference.normalize();
+    BezierScalar plane_threshold = (this->effector_diameter_*(1-this->covering_))/(2*10);
+    // Tile borders break every slice without gap : fragments ends are joined even if gap stitching is disabled
+    BezierScalar stitch_gap = this->stitch_gap_;
+    if (this->numberOfTiles(PolyData->GetNumberOfCells()) > 1)
+        stitch_gap = std::max(stitch_gap, (BezierScalar)1e-6);
+    unsigned int bridged_gaps = Geometry::stitchLines(fragments, this->vector_dir_.cast<BezierScalar>(), reference, plane_threshold, stitch_gap);
+    if (bridged_gaps > 0)
+        printf("\n  -> %u fragments stitched : %lu lines", bridged_gaps, (unsigned long)fragments.size());
+    // Lines are swapped, never copied (vectors of points)
+    if (lines.empty())
+        lines.swap(fragments);
+    else
+    {
+        lines.reserve(lines.size() + fragments.size());
+        for (size_t i = 0; i < fragments.size(); i++)
+        {
+            lines.push_back(Geometry::Line());
+            lines.back().swap(fragments[i]);
+        }
+    }
+    // Sort vector : re order lines by position of their first point along cut direction
+    const Geometry::Vector3 vector_dir = this->vector_dir_.cast<BezierScalar>();
+    std::vector<std::pair<BezierScalar, size_t> > line_order;
+    line_order.reserve(lines.size());
+    for (size_t i = 0; i < lines.size(); i++)
+        line_order.push_back(std::make_pair(vector_dir.dot(lines[i][0].first), i));
+    std::sort(line_order.begin(), line_order.end());
+    Geometry::Lines sorted_lines(lines.size());
+    for (size_t i = 0; i < line_order.size(); i++)
+        sorted_lines[i].swap(lines[line_order[i].second]);
+    lines.swap(sorted_lines);
     // Check line orientation
     checkOrientation(lines);
     // Remove too closed points
     removeNearNeighborPoints(lines);
+    // Smooth normals : continuous tool orientations on noisy normals (before resampling, on dense points)
+    if (this->smoothing_window_ > 0)
+        this->smoothing_report_.add(Geometry::smoothNormals(lines, this->smoothing_window_, this->smoothing_max_deviation_));
+    // Resample lines : dense on curved features, sparse on flat ones
+    if (this->resampling_chordal_tolerance_ > 0 && this->resampling_angular_tolerance_ > 0)
+        this->resampling_report_.add(Geometry::simplifyLines(lines, this->resampling_chordal_tolerance_, this->resampling_angular_tolerance_));
     return true;
 }
 
-int Bezier::seekClosestLine(Eigen::Vector3d point_vector, std::vector<std::vector<std::pair<Eigen::Vector3d, Eigen::Vector3d> > > extrication_lines)
+int BezierImpl::seekClosestLine(const Geometry::Vector3 &point_vector, const Geometry::Lines &extrication_lines)
 {
-    int index_of_closest_line(0);
-    double distance(DBL_MAX);
-    for (size_t index_line = 0; index_line < extrication_lines.size(); index_line++)
-    {
-      double number_of_point = extrication_lines[index_line].size();
-      Eigen::Vector3d end_extrication_point_vector = extrication_lines[index_line][number_of_point-1].first;
-      //get distance
-      double point[3] = {point_vector[0], point_vector[1], point_vector[2]};
-      double extrication_point[3] = {end_extrication_point_vector[0],
-                                     end_extrication_point_vector[1],
-                                     end_extrication_point_vector[2]};
-      if (distance > vtkMath::Distance2BetweenPoints(point, extrication_point))
-      {
-        distance = vtkMath::Distance2BetweenPoints(point, extrication_point);
-        index_of_closest_line = index_line;
-      }
-    }
-    return index_of_closest_line;
+    return Geometry::seekClosestLine(point_vector, extrication_lines);
 }
 
 //fixme combine seekclosestPoint and seekclosestextricationPassPoint in one function
-int Bezier::seekClosestPoint(Eigen::Vector3d point_vector, std::vector<std::pair<Eigen::Vector3d, Eigen::Vector3d> > extrication_line){
-    int index(0);
-    double distance(DBL_MAX);
-    for(size_t index_point=0; index_point<extrication_line.size();index_point++){
-       Eigen::Vector3d extrication_point_vector = extrication_line[index_point].first;
-       double point[3] = {point_vector[0],point_vector[1],point_vector[2]};
-       double extrication_point[3] = {extrication_point_vector[0], extrication_point_vector[1], extrication_point_vector[2]};
-       if (distance > vtkMath::Distance2BetweenPoints(point, extrication_point)){
-               distance = vtkMath::Distance2BetweenPoints(point, extrication_point);
-               index = index_point;
-       }
-    }
-    return index;
+int BezierImpl::seekClosestPoint(const Geometry::Vector3 &point_vector, const Geometry::Line &extrication_line){
+    return Geometry::seekClosestPoint(point_vector, extrication_line);
 }
 
-int Bezier::seekClosestExtricationPassPoint(Eigen::Vector3d point_vector, std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > extrication_poses){
-  int index(0);
-  double distance(DBL_MAX);
-  for (size_t index_point = 0; index_point < extrication_poses.size(); index_point++)
-  {
-    Eigen::Vector3d closest_point_vector = extrication_poses[index_point].translation();
-    double point[3] = {point_vector[0], point_vector[1], point_vector[2]};
-    double closest_point[3] = {closest_point_vector[0], closest_point_vector[1], closest_point_vector[2]};
-    if (distance > vtkMath::Distance2BetweenPoints(point, closest_point))
-    {
-      distance = vtkMath::Distance2BetweenPoints(point, closest_point);
-      index = index_point;
-    }
-  }
-  return index;
+int BezierImpl::seekClosestExtricationPassPoint(const Geometry::Vector3 &point_vector, const Geometry::Poses &extrication_poses){
+    return Geometry::seekClosestPose(point_vector, extrication_poses);
 }
 
-bool Bezier::saveDilatedMeshes (std::string path)
+bool BezierImpl::saveDilatedMeshes (std::string path)
 {
     if (dilationPolyDataVector_.empty())
         return false;
@@ -615,7 +1189,7 @@ bool Bezier::saveDilatedMeshes (std::string path)
         std::string file (path+"/mesh_"+number+".ply");
         if (!savePLYPolyData(file, dilationPolyDataVector_[i]))
             return false;
-        ROS_INFO_STREAM(file << " saved successfully");
+        std::cout << file << " saved successfully" << std::endl;
     }
     return true;
 }
@@ -623,17 +1197,46 @@ bool Bezier::saveDilatedMeshes (std::string path)
 
 //////////////////// PUBLIC FUNCTION ////////////////////
 
-bool Bezier::generateTrajectory(std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector, std::vector<bool> &color_vector, std::vector<int> &index_vector){
-    /////////// CLEAR VECTOR ///////////////
-    way_points_vector.clear();
-    color_vector.clear();
-    /////////// GENERATE NORMAL ON INPUTPOLYDATA ///////////////
-    this->generatePointNormals(this->inputPolyData_);
+bool BezierImpl::prepare(){
+    if (this->prepared_)
+        return true;
+    if (!this->progress_.stage(BEZIER_STAGE_PREPARATION, 0))
+        return false;
+    /////////// DECIMATE MESHES (PREVIEW RESOLUTION) : SHARED MESHES ARE REPLACED, NOT MODIFIED ///////////////
+    if (!this->point_cloud_ && this->resolution_.mesh_reduction > 0 && !this->decimated_)
+    {
+        if (!this->decimateMesh(this->inputPolyData_) || !this->decimateMesh(this->defaultPolyData_))
+            return false;
+        this->decimated_ = true;
+    }
+    /////////// GENERATE NORMAL ON INPUTPOLYDATA AND DEFAULTPOLYDATA (POINT CLOUDS COME WITH THEIR NORMALS) ///////////////
+    if (!this->point_cloud_)
+    {
+        this->generatePointNormals(this->inputPolyData_);
+        this->generatePointNormals(this->defaultPolyData_);
+    }
     //////////// GENERATE MESH NORMAL ////////////
     this->ransac();
     //////////// FIND CUT DIRECTION FROM MESH NORMAL ////////////
     this->generateDirection();
+    // Cells are built once : objects sharing these meshes (see share) only read them
+    this->inputPolyData_->BuildCells();
+    this->defaultPolyData_->BuildCells();
+    this->prepared_ = true;
+    return true;
+}
+
+bool BezierImpl::generatePasses(){
+    if (!this->prepare())
+        return false;
+    if (!this->dilationPolyDataVector_.empty() && this->passes_depth_ == this->grind_depth_)
+        return true;
     //////////// GENERATE PASSE VECTOR : DILATION PROCESS ////////////
+    this->dilationPolyDataVector_.clear();
+    this->passes_depth_ = 0;
+    const int expected_passes = this->estimateNumberOfPasses();
+    if (!this->progress_.stage(BEZIER_STAGE_DILATION, expected_passes + 1))
+        return false;
     printf("\nPlease wait : dilation in progress");
     this->dilationPolyDataVector_.push_back(this->inputPolyData_);
     bool intersection_flag=true; //flag variable : dilate while dilated mesh intersect default mesh
@@ -643,55 +1246,230 @@ bool Bezier::generateTrajectory(std::vector<Eigen::Affine3d, Eigen::aligned_allo
     {
         vtkSmartPointer<vtkPolyData> dilate_polydata = vtkSmartPointer<vtkPolyData>::New();
         bool flag_dilation = dilatation(depth, this->inputPolyData_, dilate_polydata);
-        if (flag_dilation && defaultIntersectionOptimisation(dilate_polydata) && dilate_polydata->GetNumberOfCells() > 10) //fixme //Check intersection between new dilated mesh and default
+        if (flag_dilation && defaultIntersectionOptimisation(dilate_polydata) //fixme //Check intersection between new dilated mesh and default
+            && (this->point_cloud_ ? dilate_polydata->GetNumberOfPoints() : dilate_polydata->GetNumberOfCells()) > 10)
         {
             this->dilationPolyDataVector_.push_back(dilate_polydata); //if intersection, consider dilated mesh as a pass
+            dilate_polydata->BuildCells();
             printf("\n  -> New pass generated");
         }
         else
             intersection_flag = false; //No intersection : end of dilation
         depth += this->grind_depth_;
+        int generated_passes = this->dilationPolyDataVector_.size() - 1;
+        if (!this->progress_.update(generated_passes, (double)generated_passes / std::max(expected_passes, generated_passes + 1)))
+        {
+            //incomplete passes are not kept
+            this->dilationPolyDataVector_.clear();
+            return false;
+        }
     }
     printf("\nDilation process done");
     //////////// REVERSE PASSE VECTOR : GRIND FROM UPPER PASS  ////////////
     std::reverse(this->dilationPolyDataVector_.begin(),this->dilationPolyDataVector_.end());
+    this->passes_depth_ = this->grind_depth_;
+    //////////// SHARED DISTANCE FIELD DEEP ENOUGH FOR THE DEEPEST EXTRICATION MESH (NOT USED BY POINT CLOUDS) ////////////
+    if (this->point_cloud_ || !this->resolution_.shared_field)
+        return true;
+    vtkSmartPointer<vtkImageData> field;
+    this->distanceField((this->extrication_coefficiant_ + this->dilationPolyDataVector_.size() - 1) * this->grind_depth_, field);
+    return true;
+}
+
+bool BezierImpl::loadMesh(std::string filename, vtkSmartPointer<vtkPolyData> &poly_data){
+    poly_data = vtkSmartPointer<vtkPolyData>::New();
+    return this->loadPLYPolydata(filename, poly_data) && this->cleanMesh(poly_data);
+}
+
+bool BezierImpl::splitDefaultMesh(std::vector<vtkSmartPointer<vtkPolyData> > &regions){
+    regions.clear();
+    vtkSmartPointer<vtkPolyDataConnectivityFilter> connectivity = vtkSmartPointer<vtkPolyDataConnectivityFilter>::New();
+#if VTK_MAJOR_VERSION <= 5
+    connectivity->SetInput(this->defaultPolyData_);
+#else
+    connectivity->SetInputData(this->defaultPolyData_);
+#endif
+    connectivity->SetExtractionModeToAllRegions();
+    connectivity->ColorRegionsOn();
+    connectivity->Update();
+    vtkSmartPointer<vtkPolyData> components = connectivity->GetOutput();
+    vtkDataArray *region_ids = components->GetPointData()->GetArray("RegionId");
+    if (!region_ids)
+        return false;
+    // Cells of a region : region of their first point
+    BezierMeshView view(components);
+    const int number_of_regions = connectivity->GetNumberOfExtractedRegions();
+    std::vector<std::vector<unsigned char> > keep_cells(number_of_regions, std::vector<unsigned char>(view.numberOfTriangles(), 0));
+    std::vector<vtkIdType> number_of_cells(number_of_regions, 0);
+    for (vtkIdType index_cell = 0; index_cell < view.numberOfTriangles(); index_cell++)
+    {
+        int region = (int)region_ids->GetTuple1(view.triangle(index_cell)[0]);
+        if (region < 0 || region >= number_of_regions)
+            continue;
+        keep_cells[region][index_cell] = 1;
+        number_of_cells[region]++;
+    }
+    for (int region = 0; region < number_of_regions; region++)
+    {
+        if (number_of_cells[region] < 10) //fixme same threshold as passes : smaller regions are noise
+            continue;
+        regions.push_back(view.extractTriangles(keep_cells[region]));
+    }
+    printf("\nDefault mesh : %d connected regions, %lu kept", number_of_regions, (unsigned long)regions.size());
+    return !regions.empty();
+}
+
+void BezierImpl::set_default_mesh(vtkSmartPointer<vtkPolyData> default_poly_data){
+    this->defaultPolyData_ = default_poly_data;
+    if (!this->point_cloud_)
+        this->generatePointNormals(this->defaultPolyData_);
+    this->defaultPolyData_->BuildCells();
+    // Passes depend on default mesh, dilations do not
+    this->dilationPolyDataVector_.clear();
+    this->passes_depth_ = 0;
+}
+
+bool BezierImpl::cacheDilations(int number_of_depths){
+    if (!this->prepare())
+        return false;
+    if (this->point_cloud_ || this->numberOfTiles(this->inputPolyData_->GetNumberOfCells()) > 1)
+        return true;
+    // One distance field deep enough for all depths, when fields are shared
+    vtkSmartPointer<vtkImageData> field;
+    if (this->resolution_.shared_field && !this->distanceField(number_of_depths * this->grind_depth_, field))
+        return false;
+    for (int k = 1; k <= number_of_depths; k++)
+    {
+        vtkSmartPointer<vtkPolyData> dilate_poly_data;
+        if (!this->dilatation(k * this->grind_depth_, this->inputPolyData_, dilate_poly_data))
+            break;
+    }
+    return true;
+}
+
+void BezierImpl::shareDilations(const BezierImpl &source){
+    this->dilation_cache_.clear();
+    this->dilation_cache_grind_depth_ = 0;
+    if (source.dilation_cache_grind_depth_ != this->grind_depth_)
+        return;
+    // Cached meshes are only read : they are shallow copied by dilatation before any use
+    this->dilation_cache_ = source.dilation_cache_;
+    this->dilation_cache_grind_depth_ = source.dilation_cache_grind_depth_;
+    if (source.distance_field_ && source.distance_field_grind_depth_ == this->grind_depth_ && source.distance_field_depth_ > this->distance_field_depth_)
+    {
+        this->distance_field_ = vtkSmartPointer<vtkImageData>::New();
+        this->distance_field_->ShallowCopy(source.distance_field_);
+        this->distance_field_depth_ = source.distance_field_depth_;
+        this->distance_field_grind_depth_ = source.distance_field_grind_depth_;
+    }
+}
+
+bool BezierImpl::generateTrajectory(std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector, std::vector<bool> &color_vector, std::vector<int> &index_vector){
+    this->progress_.start();
+    bool success = this->generatePath(way_points_vector, color_vector, index_vector);
+    BezierStatus status = this->progress_.finish(success);
+    if (status == BEZIER_SUCCEEDED)
+        return true;
+    //////////// STOPPED OR FAILED : NO PARTIAL PATH ////////////
+    way_points_vector.clear();
+    color_vector.clear();
+    index_vector.clear();
+    this->reachable_flags_.clear();
+    this->gouge_indices_.clear();
+    if (status == BEZIER_CANCELLED)
+        printf("\nPath generation cancelled\n");
+    else if (status == BEZIER_DEADLINE_EXCEEDED)
+        printf("\nPath generation stopped : deadline exceeded\n");
+    else
+        printf("\nPath generation failed\n");
+    return false;
+}
+
+bool BezierImpl::generatePath(std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector, std::vector<bool> &color_vector, std::vector<int> &index_vector){
+    /////////// CLEAR VECTOR (CAPACITY IS KEPT : OUTPUT VECTORS CAN BE REUSED) ///////////////
+    way_points_vector.clear();
+    color_vector.clear();
+    index_vector.clear();
+    this->resampling_report_ = Geometry::SimplificationReport();
+    this->smoothing_report_ = Geometry::SmoothingReport();
+    this->angular_rates_.clear();
+    this->reachable_flags_.clear();
+    this->gouge_indices_.clear();
+    //////////// NORMALS, MESH NORMAL, CUT DIRECTION AND PASSES (SHARED UNTIL MESHES OR GRIND DEPTH CHANGE) ////////////
+    if (!this->generatePasses())
+        return false;
     //////////// VARIABLES USE TO GENERATE EXTRICATION MESH ////////////
     vtkSmartPointer<vtkPolyData> extrication_poly_data = vtkSmartPointer<vtkPolyData>::New();
-    std::vector<std::vector<std::pair<Eigen::Vector3d, Eigen::Vector3d> > > extrication_lines;
+    Geometry::Lines extrication_lines;
 
     index_vector.push_back(way_points_vector.size()-1); //push back index of last pose in passe
     //////////// START PROCESS : GENERATE TRAJECTORY ////////////
-    for(int polydata_index=0; polydata_index<this->dilationPolyDataVector_.size();polydata_index++){ ///FOR EACH POLYDATA : PASSES
+    const int number_of_passes = this->dilationPolyDataVector_.size();
+    index_vector.reserve(index_vector.size() + number_of_passes);
+    if (!this->progress_.stage(BEZIER_STAGE_PASSES, number_of_passes))
+        return false;
+    for(int polydata_index=0; polydata_index<number_of_passes;polydata_index++){ ///FOR EACH POLYDATA : PASSES
+      if (!this->progress_.update(polydata_index, (double)polydata_index / number_of_passes))
+        return false;
       //////////// GENERATE EXTRICATION MESH ////////////
       if (polydata_index%extrication_frequency_== 0){
         //-> dilated_depth = extrication_coefficiant+numberOfPolydataDilated-1-n*frequency)*grind_depth
         double dilated_depth((extrication_coefficiant_+dilationPolyDataVector_.size()-1-polydata_index)*this->grind_depth_);
-        dilatation(dilated_depth, this->inputPolyData_, extrication_poly_data);
+        if (!dilatation(dilated_depth, this->inputPolyData_, extrication_poly_data) || !this->progress_.keepGoing())
+            return false;
         //dilatation(this->extrication_coefficiant_*this->grind_depth_, this->dilationPolyDataVector_[polydata_index], extrication_poly_data);
-        generateStripperOnSurface(extrication_poly_data, extrication_lines);
+        if (!generateStripperOnSurface(extrication_poly_data, extrication_lines) || !this->progress_.keepGoing())
+            return false;
+        if (extrication_lines.empty())
+        {
+            printf("\nNo extrication line found on extrication mesh (passe %d)", polydata_index);
+            return false;
+        }
       }
       double dist_to_extrication_mesh((this->extrication_coefficiant_+polydata_index)*this->grind_depth_); //distance between dilationPolyDataVector_[index_polydata] and extrication polydata
       //////////// GENERATE TRAJECTORY ON MESH (POLYDATA) ////////////
-      std::vector<std::vector<std::pair<Eigen::Vector3d, Eigen::Vector3d> > > lines;
-      this->generateStripperOnSurface(this->dilationPolyDataVector_[polydata_index],lines);
-      for(int index_line=0; index_line<lines.size();index_line++){ ///FOR EACH LINE
+      Geometry::Lines lines;
+      if (!this->generateStripperOnSurface(this->dilationPolyDataVector_[polydata_index],lines) || !this->progress_.keepGoing())
+          return false;
+      if (lines.empty())
+      {
+          printf("\nNo line found on passe %d", polydata_index);
+          return false;
+      }
+      // Reserve poses of remaining passes from this one : line points, line ends and extrications (about as many poses)
+      size_t pass_poses = 0;
+      for (size_t index_line = 0; index_line < lines.size(); index_line++)
+          pass_poses += 2 * (lines[index_line].size() + 2);
+      const size_t expected_poses = way_points_vector.size() + pass_poses * (number_of_passes - polydata_index);
+      if (expected_poses > way_points_vector.capacity())
+      {
+          way_points_vector.reserve(std::max(expected_poses, 2 * way_points_vector.capacity()));
+          color_vector.reserve(way_points_vector.capacity());
+      }
+      for(int index_line=0; index_line<(int)lines.size();index_line++){ ///FOR EACH LINE
+            if (!this->progress_.update(polydata_index, (polydata_index + (double)index_line / lines.size()) / number_of_passes))
+                return false;
 
             ///Variable use to store pose : use for extrication
             Eigen::Affine3d start_pose(Eigen::Affine3d::Identity()); //Start line pose
             Eigen::Affine3d end_pose(Eigen::Affine3d::Identity()); //End line pose
+            if (lines[index_line].size() >= 2)
+                this->angular_rates_.push_back(Geometry::peakAngularRate(lines[index_line]));
 
             //////////// GENERATE POSES ON A LINE ////////////
-            for(int index_point=0; index_point<lines[index_line].size();index_point++){ ///FOR EACH POINT
+            for(int index_point=0; index_point<(int)lines[index_line].size();index_point++){ ///FOR EACH POINT
+              if (!this->progress_.keepGoing())
+                  return false;
               //ignore to small line
               if (lines[index_line].size()<2){
                     printf("Line is too small (number_of_points < 2)\n");
                     break;
                }
                //Get points, normal and generate pose
-                Eigen::Vector3d point, next_point, normal;
+                Geometry::Vector3 point, next_point, normal;
                 Eigen::Affine3d pose(Eigen::Affine3d::Identity());
                 bool flag_isFinite = true; //check generated pose for NAN value
-                if (index_point < (lines[index_line].size() - 1)){
+                if (index_point < ((int)lines[index_line].size() - 1)){
                     point = lines[index_line][index_point].first;
                     next_point = lines[index_line][index_point+1].first;
                     normal = lines[index_line][index_point].second;
@@ -714,47 +1492,44 @@ bool Bezier::generateTrajectory(std::vector<Eigen::Affine3d, Eigen::aligned_allo
                     way_points_vector.push_back(pose);
                     color_vector.push_back(true);
                 }
-                if(index_point == (lines[index_line].size()-1)){ //LAST POINT IN LINE
+                if(index_point == ((int)lines[index_line].size()-1)){ //LAST POINT IN LINE
                     end_pose = pose;
                     way_points_vector.push_back(pose); //add pose with false color flag (out of line)
                     color_vector.push_back(false);
                 }
             }
             //////////// END OF LINE : GENERATE EXTRICATION TO NEXT LINE ////////////
-            if(index_line==(lines.size()-1)) //no simple extrication for the last line of mesh
+            if(index_line==((int)lines.size()-1)) //no simple extrication for the last line of mesh
                     break;
             Eigen::Vector3d end_point(end_pose.translation()+dist_to_extrication_mesh*end_pose.linear().col(0));
             Eigen::Vector3d dilated_end_point(end_pose.translation()-dist_to_extrication_mesh*end_pose.linear().col(2));
             Eigen::Vector3d dilated_start_point(start_pose.translation()-dist_to_extrication_mesh*start_pose.linear().col(2));
             //seek closest line in extrication lines
-            int index_of_closest_line = seekClosestLine(end_point,extrication_lines);
+            int index_of_closest_line = seekClosestLine(end_point.cast<BezierScalar>(),extrication_lines);
             //seek for dilated_end_point neighbor in extrication line
-            int index_of_closest_end_point = seekClosestPoint(dilated_end_point, extrication_lines[index_of_closest_line]);
+            int index_of_closest_end_point = seekClosestPoint(dilated_end_point.cast<BezierScalar>(), extrication_lines[index_of_closest_line]);
             //seek for dilated_start_point neighbor in extrication line
-            int index_of_closest_start_point = seekClosestPoint(dilated_start_point,extrication_lines[index_of_closest_line]);
-            //get vector between these indexes
-            std::vector<std::pair<Eigen::Vector3d, Eigen::Vector3d> > extrication_line(
-                  extrication_lines[index_of_closest_line].begin()+index_of_closest_start_point, extrication_lines[index_of_closest_line].begin()+index_of_closest_end_point);
-            //generate pose on this vector (line)
+            int index_of_closest_start_point = seekClosestPoint(dilated_start_point.cast<BezierScalar>(),extrication_lines[index_of_closest_line]);
+            //generate poses between these indexes, in reverse order (from end of line to start of line)
+            const Geometry::Line &extrication_line = extrication_lines[index_of_closest_line];
             Eigen::Affine3d pose(end_pose);
-            Eigen::Vector3d point(Eigen::Vector3d::Identity());
-            std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > extrication_poses;
-            for (int index_point = 0; index_point < extrication_line.size(); index_point++)
+            for (int index_point = index_of_closest_end_point - 1; index_point >= index_of_closest_start_point; index_point--)
             {
-                    point = extrication_line[index_point].first;
-                    pose.translation() << point[0], point[1], point[2];
-                    extrication_poses.push_back(pose);
+                    pose.translation() = extrication_line[index_point].first.cast<double>();
+                    way_points_vector.push_back(pose);
                     color_vector.push_back(false);
             }
-            //reverse extrication pose
-            std::reverse(extrication_poses.begin(),extrication_poses.end());
-            way_points_vector.insert(way_points_vector.end(), extrication_poses.begin(), extrication_poses.end());
         }
         //////////// EXTRICATION FROM LAST LINE TO FIRST ONE ////////////
-        Eigen::Vector3d start_point_pass(lines[0][0].first);
-        Eigen::Vector3d start_normal_pass(lines[0][0].second);
-        Eigen::Vector3d end_point_pass(lines[lines.size()-1][lines[lines.size()-1].size()].first);
-        Eigen::Vector3d end_normal_pass(lines[lines.size()-1][lines[lines.size()-1].size()].second);
+        if (lines.front().empty() || lines.back().empty() || way_points_vector.empty())
+        {
+            printf("\nNo pose generated on passe %d", polydata_index);
+            return false;
+        }
+        Eigen::Vector3d start_point_pass(lines[0][0].first.cast<double>());
+        Eigen::Vector3d start_normal_pass(lines[0][0].second.cast<double>());
+        Eigen::Vector3d end_point_pass(lines.back().back().first.cast<double>());
+        Eigen::Vector3d end_normal_pass(lines.back().back().second.cast<double>());
         //get vector from last point of last line and first point of first line
         Eigen::Vector3d extrication_pass_dir(end_point_pass-start_point_pass);
         extrication_pass_dir.normalize();
@@ -765,14 +1540,15 @@ bool Bezier::generateTrajectory(std::vector<Eigen::Affine3d, Eigen::aligned_allo
         extrication_cut_dir = extrication_cut_dir.cross(this->mesh_normal_vector_);
         extrication_cut_dir.normalize();
         //Cut this dilated mesh to determine extrication pass trajectory
-        vtkSmartPointer<vtkStripper> extrication_stripper = vtkSmartPointer<vtkStripper>::New();
-        cutMesh(extrication_poly_data, extrication_cut_dir, 1, extrication_stripper);
+        vtkSmartPointer<vtkPolyData> extrication_slices;
+        if (!cutMesh(extrication_poly_data, extrication_cut_dir, 1, extrication_slices, false))
+            return false;
         //get last pose
         Eigen::Affine3d extrication_pose(Eigen::Affine3d::Identity());
         extrication_pose = way_points_vector.back();
         //check stripper orientation
-        vtkPoints *points = extrication_stripper->GetOutput()->GetPoints();
-        vtkCellArray *cells = extrication_stripper->GetOutput()->GetLines();
+        vtkPoints *points = extrication_slices->GetPoints();
+        vtkCellArray *cells = extrication_slices->GetLines();
         vtkIdType *indices;
         vtkIdType numberOfPoints;
         vtkIdType lastnumberOfPoints(0); //fixme alternative solution used to face hole problems in dilated mesh
@@ -784,6 +1560,7 @@ bool Bezier::generateTrajectory(std::vector<Eigen::Affine3d, Eigen::aligned_allo
         for (cells->InitTraversal(); cells->GetNextCell(numberOfPoints, indices); lineCount++){ //in case where more than one slice has been cut
           if(numberOfPoints>lastnumberOfPoints){ //get the max length stripper
             extrication_poses.clear();
+            extrication_poses.reserve(numberOfPoints);
             for (vtkIdType i = 0; i < numberOfPoints; i++){
               double point[3];
               points->GetPoint(indices[i], point);
@@ -792,160 +1569,200 @@ bool Bezier::generateTrajectory(std::vector<Eigen::Affine3d, Eigen::aligned_allo
              }
           }
         }
+        if (extrication_poses.empty())
+        {
+            printf("\nNo extrication pass found on passe %d", polydata_index);
+            return false;
+        }
         orientation = extrication_pose.translation() - extrication_poses[0].translation();
         //check orientation
         if (orientation.dot(extrication_pass_dir) > 0)
             std::reverse(extrication_poses.begin(), extrication_poses.end());
         //seek for closest start pass point index
-        int index_end_point_pass = seekClosestExtricationPassPoint(end_point_pass-dist_to_extrication_mesh*end_normal_pass, extrication_poses);
+        int index_end_point_pass = seekClosestExtricationPassPoint((end_point_pass-dist_to_extrication_mesh*end_normal_pass).cast<BezierScalar>(), extrication_poses);
         //seek for closest end pass point index
-        int index_start_point_pass = seekClosestExtricationPassPoint(start_point_pass-dist_to_extrication_mesh*start_normal_pass, extrication_poses);
+        int index_start_point_pass = seekClosestExtricationPassPoint((start_point_pass-dist_to_extrication_mesh*start_normal_pass).cast<BezierScalar>(), extrication_poses);
         //get indice of close points
         way_points_vector.insert(way_points_vector.end(), extrication_poses.begin()+index_end_point_pass, extrication_poses.begin()+index_start_point_pass);
-        for(size_t i=0; i<(index_start_point_pass-index_end_point_pass);i++){
-          color_vector.push_back(false);
-        }
+        if (index_start_point_pass > index_end_point_pass)
+            color_vector.insert(color_vector.end(), index_start_point_pass - index_end_point_pass, false);
         index_vector.push_back(way_points_vector.size()-1); //push back index of last pose in passe
     }
-    return true;
-}
-
-void Bezier::displayNormal(std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > way_points_vector, std::vector<bool> points_color_viz, ros::Publisher &normal_publisher)
-{
-    //check possible error
-    if (way_points_vector.size() != points_color_viz.size())
-        PCL_ERROR("Error : Trajectory vector and bool vector have differents sizes in displayTrajectory function \n");
-    visualization_msgs::MarkerArray markers;
-    for (int k = 0; k < way_points_vector.size(); k++)
+    //////////// GOUGE CHECK : TOOL AGAINST INPUT MESH ////////////
+    if (this->gouge_check_ && this->point_cloud_)
+        printf("\nGouge check needs input mesh triangles : skipped in point cloud mode");
+    else if (this->gouge_check_)
     {
-        if (points_color_viz[k] == true)
+        if (!this->progress_.stage(BEZIER_STAGE_GOUGE_CHECK, number_of_passes))
+            return false;
+        this->gouge_tool_.radius = this->effector_diameter_ / 2;
+        this->gouge_tool_.length = this->effector_diameter_;
+        BezierGougeCheck gouge_check(BezierMeshView(this->inputPolyData_), this->gouge_tool_);
+        std::vector<unsigned char> gouge_flags;
+        long gouging_poses = gouge_check.check(way_points_vector, gouge_flags);
+        if (gouging_poses > 0 && (this->gouge_max_tilt_ > 0 || this->gouge_max_lift_ > 0))
+            gouging_poses = gouge_check.avoid(way_points_vector, gouge_flags, this->gouge_max_tilt_, M_PI / 90,
+                                              this->gouge_max_lift_, this->gouge_tool_.tolerance);
+        // Gouging poses of each passe
+        for (size_t index_passe = 0; index_passe + 1 < index_vector.size(); index_passe++)
         {
-            visualization_msgs::Marker marker;
-            marker.header.frame_id = "/base_link";                // Set the frame ID = /base ou /base_link
-            marker.header.stamp = ros::Time::now();               //set the timestamp (for tf)
-            marker.ns = "basic_shapes";   //set the namespace of the marker
-            marker.id = k;        //set an unique ID of the marker
-            marker.type = visualization_msgs::Marker::ARROW;
-            marker.action = visualization_msgs::Marker::ADD; //set the marker action
-
-            // Set the scale of the marker -- 1x1x1 here means 1m on a side
-            marker.scale.x = 0.002; //radius
-            marker.scale.y = 0.004; //radius
-            //marker.scale.z = 0.001;
-
-            double length = 0.015; //length for normal markers
-            geometry_msgs::Point start_point;
-            geometry_msgs::Point end_point;
-            end_point.x = way_points_vector[k].translation()[0];
-            end_point.y = way_points_vector[k].translation()[1];
-            end_point.z = way_points_vector[k].translation()[2];
-            start_point.x = end_point.x - length * way_points_vector[k].linear().col(2)[0];
-            start_point.y = end_point.y - length * way_points_vector[k].linear().col(2)[1];
-            start_point.z = end_point.z - length * way_points_vector[k].linear().col(2)[2];
-
-            marker.points.push_back(start_point);
-            marker.points.push_back(end_point);
-
-            marker.color.r = 0.0f;
-            marker.color.g = 1.0f;
-            marker.color.b = 0.0f;
-            marker.color.a = 0.7;
-            //set the lifetime
-            marker.lifetime = ros::Duration();
-            markers.markers.push_back(marker);
+            this->gouge_indices_.push_back(std::vector<int>());
+            for (int i = index_vector[index_passe] + 1; i <= index_vector[index_passe + 1] && i < (int)gouge_flags.size(); i++)
+                if (gouge_flags[i])
+                    this->gouge_indices_.back().push_back(i);
+            if (!this->gouge_indices_.back().empty())
+                printf("\nGouge check : passe %lu has %lu gouging poses", (unsigned long)index_passe,
+                       (unsigned long)this->gouge_indices_.back().size());
         }
+        printf("\nGouge check : %ld gouging poses (over %lu)", gouging_poses, (unsigned long)way_points_vector.size());
     }
-    while (normal_publisher.getNumSubscribers() < 1)
+        //////////// REACHABILITY : FLAG OR RE-ORIENT UNREACHABLE POSES ////////////
+    if (this->reachability_)
     {
-        ROS_WARN_ONCE("Please create a subscriber to the marker");
-        sleep(1);
+        if (!this->progress_.stage(BEZIER_STAGE_REACHABILITY, number_of_passes))
+            return false;
+        long unreachable_poses = this->reachability_->check(way_points_vector, this->reachable_flags_);
+        long reoriented_poses = 0;
+        if (unreachable_poses > 0 && this->max_reorientation_ > 0)
+        {
+            long remaining_poses = this->reachability_->reorient(way_points_vector, this->reachable_flags_, this->max_reorientation_, 5 * M_PI / 180);
+            reoriented_poses = unreachable_poses - remaining_poses;
+            unreachable_poses = remaining_poses;
+        }
+        printf("\nReachability : %ld poses re-oriented, %ld unreachable poses (over %lu)", reoriented_poses, unreachable_poses,
+               (unsigned long)way_points_vector.size());
     }
-    normal_publisher.publish(markers);
+    if (this->resampling_report_.input_points > 0)
+        printf("\nLines resampling : %ld waypoints removed (%ld -> %ld), max deviation %.3f mm / %.2f deg\n",
+               this->resampling_report_.input_points - this->resampling_report_.output_points, this->resampling_report_.input_points,
+               this->resampling_report_.output_points, this->resampling_report_.max_chordal_deviation * 1000.0,
+               this->resampling_report_.max_angular_deviation * 180.0 / M_PI);
+    if (this->smoothing_report_.input_points > 0)
+        printf("\nNormal smoothing : window %.1f mm, max deviation %.2f deg (%ld normals limited over %ld)\n", this->smoothing_window_ * 1000.0,
+               this->smoothing_report_.max_deviation * 180.0 / M_PI, this->smoothing_report_.limited_points, this->smoothing_report_.input_points);
+    if (!this->angular_rates_.empty())
+        printf("\nPeak angular rate of grind lines : %.1f deg/m\n",
+               *std::max_element(this->angular_rates_.begin(), this->angular_rates_.end()) * 180.0 / M_PI);
+    return true;
 }
 
-void Bezier::displayTrajectory(std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > way_points_vector, std::vector<bool> points_color_viz, ros::Publisher &trajectory_publisher)
+//////////////////// PUBLIC INTERFACE ////////////////////
+Bezier::Bezier() :
+        impl_(new BezierImpl())
 {
-    //check possible error
-    if (way_points_vector.size() != points_color_viz.size())
-    {
-        PCL_ERROR("Error : Trajectory vector and bool vector have differents sizes in displayTrajectory function \n");
-    }
-    double diffRepz = 0.45;               // z offset between "/base" and "/base_link"
-    visualization_msgs::Marker marker;
-    marker.header.frame_id = "/base_link";                // Set frame ID
-    marker.header.stamp = ros::Time::now();               //set timestamp (for tf)
-    marker.ns = "trajectory";             //Set marker namespace
-    marker.id = 0;                //set an unique ID of the marker
-    marker.type = visualization_msgs::Marker::LINE_STRIP; //Marker type
-    marker.action = visualization_msgs::Marker::ADD; //set the marker action
-    marker.lifetime = ros::Duration();            //set the lifetime
-    marker.scale.x = 0.003; // Set scale of our new marker : Diameter in our case.
-    //Set marker orientation. Here, there is no rotation : (v1,v2,v3)=(0,0,0) angle=0
-    marker.pose.orientation.x = 0.0;      // v1* sin(angle/2)
-    marker.pose.orientation.y = 0.0;      // v2* sin(angle/2)
-    marker.pose.orientation.z = 0.0;      // v3* sin(angle/2)
-    marker.pose.orientation.w = 1.0;      // cos(angle/2)
+}
 
-    // Set the pose and color of marker from parameter[in]
-    geometry_msgs::Point p; //temporary point
-    std_msgs::ColorRGBA color; //temporary color
-    for (int k = 1; k < way_points_vector.size(); k++)
-    {
-        //for each index of trajectory vector, store coordinates in a temporary point p;
-        p.x = way_points_vector[k].translation()[0];
-        p.y = way_points_vector[k].translation()[1];
-        p.z = way_points_vector[k].translation()[2];
-        //for each index of boolean vector, check membership of point;
-        if (points_color_viz[k] == true)
-        {
-            color.r = 0.0f;
-            color.g = 1.0f; //If points is from grindstone path : Color is green
-            color.b = 0.0f;
-            color.a = 1.0;
-        }
-        else
-        {
-            color.r = 1.0f; //If points is from extrication path : Color is red
-            color.g = 0.0f;
-            color.b = 0.0f;
-            color.a = 1.0;
-        }
-        marker.colors.push_back(color);     //add color c to LINE_STRIP to set color segment
-        marker.points.push_back(p);         //add point p to LINE_STRIP
-    }
-    while (trajectory_publisher.getNumSubscribers() < 1)
-    {
-        ROS_WARN_ONCE("Please create a subscriber to the marker");
-        sleep(1);
-    }
-    trajectory_publisher.publish(marker);
+Bezier::Bezier(std::string filename_inputMesh, std::string filename_defaultMesh,
+                 double grind_depth, double effector_diameter, double covering, int extrication_coefficiant, int extrication_frequency,
+                 double weld_tolerance) :
+        impl_(new BezierImpl(filename_inputMesh, filename_defaultMesh, grind_depth, effector_diameter, covering, extrication_coefficiant,
+                             extrication_frequency, weld_tolerance))
+{
 }
 
-void Bezier::displayMesh(ros::Publisher &mesh_publisher, std::string mesh_path)
+Bezier::Bezier(BezierImpl *impl) :
+        impl_(impl)
 {
-    // Create a mesh marker from ply files
-    visualization_msgs::Marker mesh_marker;
-    mesh_marker.header.frame_id = "/base_link";                // Set the frame ID = /base ou /base_link
-    mesh_marker.header.stamp = ros::Time::now();               //set the timestamp (for tf)
-    mesh_marker.id = 0;        //set an unique ID of the marker
-    mesh_marker.type = visualization_msgs::Marker::MESH_RESOURCE;
-    mesh_marker.mesh_resource = mesh_path;
-    mesh_marker.action = visualization_msgs::Marker::ADD; //set the marker action
+}
 
-    mesh_marker.scale.x = mesh_marker.scale.y = mesh_marker.scale.z = 1;
+Bezier::~Bezier(){}
 
-    mesh_marker.color.r = 0.6f;
-    mesh_marker.color.g = 0.6f;
-    mesh_marker.color.b = 0.6f;
-    mesh_marker.color.a = 1.0;
-    //set the lifetime
-    mesh_marker.lifetime = ros::Duration();
-    //Publish
-    while (mesh_publisher.getNumSubscribers() < 1)
-    {
-        ROS_WARN_ONCE("Please create a subscriber to the marker");
-        sleep(1);
-    }
-    mesh_publisher.publish(mesh_marker);
+bool Bezier::generateTrajectory(std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector, std::vector<bool> &color_vector, std::vector<int> &index_vector)
+{
+    return this->impl_->generateTrajectory(way_points_vector, color_vector, index_vector);
+}
+
+bool Bezier::saveDilatedMeshes(std::string path)
+{
+    return this->impl_->saveDilatedMeshes(path);
+}
+
+Eigen::Vector3d Bezier::get_vector_direction()
+{
+    return this->impl_->get_vector_direction();
+}
+
+void Bezier::set_parameters(double grind_depth, double effector_diameter, double covering, int extrication_coefficiant, int extrication_frequency)
+{
+    this->impl_->set_parameters(grind_depth, effector_diameter, covering, extrication_coefficiant, extrication_frequency);
+}
+
+void Bezier::set_stitch_gap(double gap)
+{
+    this->impl_->set_stitch_gap(gap);
+}
+
+void Bezier::set_tiling(double memory_budget, int parallel_tiles)
+{
+    this->impl_->set_tiling(memory_budget, parallel_tiles);
 }
 
+void Bezier::set_point_cloud_slicing(double band_width, double bin_length)
+{
+    this->impl_->set_point_cloud_slicing(band_width, bin_length);
+}
+
+void Bezier::set_resampling_tolerances(double chordal_tolerance, double angular_tolerance)
+{
+    this->impl_->set_resampling_tolerances(chordal_tolerance, angular_tolerance);
+}
+
+void Bezier::set_robot_model(const BezierRobotModel &model, double max_reorientation)
+{
+    this->impl_->set_robot_model(model, max_reorientation);
+}
+
+void Bezier::get_reachability(std::vector<bool> &reachable_vector)
+{
+    this->impl_->get_reachability(reachable_vector);
+}
+
+void Bezier::set_gouge_check(bool enable, double tolerance, double max_tilt, double max_lift)
+{
+    this->impl_->set_gouge_check(enable, tolerance, max_tilt, max_lift);
+}
+
+void Bezier::get_gouges(std::vector<std::vector<int> > &gouge_indices)
+{
+    this->impl_->get_gouges(gouge_indices);
+}
+
+void Bezier::set_normal_smoothing(double window_length, double max_deviation)
+{
+    this->impl_->set_normal_smoothing(window_length, max_deviation);
+}
+
+void Bezier::get_angular_rates(std::vector<double> &angular_rates)
+{
+    this->impl_->get_angular_rates(angular_rates);
+}
+
+void Bezier::set_resolution(const BezierResolution &resolution)
+{
+    this->impl_->set_resolution(resolution);
+}
+
+void Bezier::set_progress_callback(BezierProgressCallback *callback)
+{
+    this->impl_->set_progress_callback(callback);
+}
+
+void Bezier::set_cancellation_token(const BezierCancellationToken *token)
+{
+    this->impl_->set_cancellation_token(token);
+}
+
+void Bezier::set_deadline(double deadline)
+{
+    this->impl_->set_deadline(deadline);
+}
+
+BezierStatus Bezier::get_status()
+{
+    return this->impl_->get_status();
+}
+
+std::string Bezier::get_settings()
+{
+    return this->impl_->get_settings();
+}
@@ -0,0 +1,193 @@
+#include "bezier_library/bezier_mesh_cleaning.hpp"
+#include "bezier_library/bezier_mesh_view.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <utility>
+
+#include <boost/cstdint.hpp>
+#include <boost/unordered_map.hpp>
+
+// PCL headers
+#include <pcl/common/time.h>
+
+//////////////////// SPATIAL HASHING ////////////////////
+///@brief Hash of a grid cell (collisions only merge buckets : distances are always checked)
+static inline boost::uint64_t hashCell(long x, long y, long z)
+{
+    return (static_cast<boost::uint64_t>(x) * 73856093u) ^ (static_cast<boost::uint64_t>(y) * 19349663u) ^
+           (static_cast<boost::uint64_t>(z) * 83492791u);
+}
+
+///@brief Bucket of the grid : range [first, second[ in the sorted (hash, point id) vector
+typedef std::pair<long, long> Bucket;
+
+///@brief Root of a point in a union-find forest (path halving)
+static inline long findRoot(std::vector<long> &parent, long i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+//////////////////// REPORT ////////////////////
+BezierMeshCleaningReport::BezierMeshCleaningReport() :
+        input_points(0), input_triangles(0), merged_points(0), unused_points(0), degenerate_triangles(0),
+        output_points(0), output_triangles(0), time(0)
+{
+}
+
+void BezierMeshCleaningReport::print() const
+{
+    printf("\nMesh cleaning : %ld merged points, %ld unused points, %ld degenerate triangles removed"
+           "\n  -> points %ld -> %ld, triangles %ld -> %ld (%.1f ms)",
+           merged_points, unused_points, degenerate_triangles, input_points, output_points, input_triangles,
+           output_triangles, time);
+}
+
+//////////////////// CLEANER ////////////////////
+long BezierMeshCleaner::weldVertices(const float *points, long number_of_points, double tolerance, std::vector<long> &representative)
+{
+    representative.resize(number_of_points);
+    for (long i = 0; i < number_of_points; i++)
+        representative[i] = i;
+    if (number_of_points == 0 || tolerance <= 0)
+        return 0;
+
+    // Grid origin = min corner of bounding box
+    double origin[3] = {points[0], points[1], points[2]};
+    for (long i = 1; i < number_of_points; i++)
+        for (int k = 0; k < 3; k++)
+            origin[k] = std::min(origin[k], (double)points[3 * i + k]);
+
+    // Grid cell of each point (parallel)
+    const double inverse_size = 1.0 / tolerance;
+    std::vector<long> cells(3 * number_of_points);
+    std::vector<std::pair<boost::uint64_t, long> > keys(number_of_points);
+#pragma omp parallel for
+    for (long i = 0; i < number_of_points; i++)
+    {
+        for (int k = 0; k < 3; k++)
+            cells[3 * i + k] = static_cast<long>(std::floor((points[3 * i + k] - origin[k]) * inverse_size));
+        keys[i] = std::make_pair(hashCell(cells[3 * i], cells[3 * i + 1], cells[3 * i + 2]), i);
+    }
+
+    // Group points by cell : in each bucket, point ids are sorted
+    std::sort(keys.begin(), keys.end());
+    boost::unordered_map<boost::uint64_t, Bucket> buckets;
+    buckets.rehash(number_of_points / 2 + 1);
+    for (long begin = 0; begin < number_of_points;)
+    {
+        long end = begin + 1;
+        while (end < number_of_points && keys[end].first == keys[begin].first)
+            end++;
+        buckets[keys[begin].first] = Bucket(begin, end);
+        begin = end;
+    }
+
+    // Pairs of points within tolerance (parallel, read only grid) : each pair is found once, from its largest id
+    const double tolerance2 = tolerance * tolerance;
+    std::vector<std::pair<long, long> > pairs;
+#pragma omp parallel
+    {
+        std::vector<std::pair<long, long> > thread_pairs;
+#pragma omp for schedule(dynamic, 1024) nowait
+        for (long i = 0; i < number_of_points; i++)
+        {
+            const float *p = points + 3 * i;
+            for (int dx = -1; dx <= 1; dx++)
+                for (int dy = -1; dy <= 1; dy++)
+                    for (int dz = -1; dz <= 1; dz++)
+                    {
+                        boost::unordered_map<boost::uint64_t, Bucket>::const_iterator bucket = buckets.find(
+                                hashCell(cells[3 * i] + dx, cells[3 * i + 1] + dy, cells[3 * i + 2] + dz));
+                        if (bucket == buckets.end())
+                            continue;
+                        for (long index = bucket->second.first; index < bucket->second.second; index++)
+                        {
+                            long j = keys[index].second;
+                            if (j >= i) //ids are sorted in bucket
+                                break;
+                            const float *q = points + 3 * j;
+                            double d0 = p[0] - q[0], d1 = p[1] - q[1], d2 = p[2] - q[2];
+                            if (d0 * d0 + d1 * d1 + d2 * d2 <= tolerance2)
+                                thread_pairs.push_back(std::make_pair(i, j));
+                        }
+                    }
+        }
+#pragma omp critical
+        pairs.insert(pairs.end(), thread_pairs.begin(), thread_pairs.end());
+    }
+
+    // Union-find : each group of points connected by pairs gets its smallest point id as root (independent of pair order)
+    std::vector<long> &parent = representative;
+    for (size_t index_pair = 0; index_pair < pairs.size(); index_pair++)
+    {
+        long a = findRoot(parent, pairs[index_pair].first);
+        long b = findRoot(parent, pairs[index_pair].second);
+        if (a < b)
+            parent[b] = a;
+        else if (b < a)
+            parent[a] = b;
+    }
+    long merged_points = 0;
+    for (long i = 0; i < number_of_points; i++)
+    {
+        representative[i] = findRoot(parent, i);
+        if (representative[i] != i)
+            merged_points++;
+    }
+    return merged_points;
+}
+
+bool BezierMeshCleaner::clean(vtkSmartPointer<vtkPolyData> &poly_data, double tolerance, BezierMeshCleaningReport &report)
+{
+    pcl::StopWatch watch;
+    report = BezierMeshCleaningReport();
+    BezierMeshView view(poly_data);
+    report.input_points = view.numberOfPoints();
+    report.input_triangles = view.numberOfTriangles();
+    if (view.numberOfPoints() == 0 || view.numberOfTriangles() == 0)
+        return false;
+
+    // Weld vertices
+    std::vector<long> representative;
+    report.merged_points = weldVertices(view.points(), view.numberOfPoints(), tolerance, representative);
+
+    // Remove degenerate triangles : collapsed by welding or (almost) null area
+    const double min_double_area = tolerance * tolerance;
+    long number_of_triangles = view.numberOfTriangles();
+    std::vector<unsigned char> keep(number_of_triangles, 0);
+    long degenerate_triangles = 0;
+#pragma omp parallel for reduction(+:degenerate_triangles)
+    for (long index_triangle = 0; index_triangle < number_of_triangles; index_triangle++)
+    {
+        const vtkIdType *ids = view.triangle(index_triangle);
+        long a = representative[ids[0]], b = representative[ids[1]], c = representative[ids[2]];
+        bool degenerate = (a == b || b == c || a == c);
+        if (!degenerate)
+        {
+            const float *pa = view.point(a), *pb = view.point(b), *pc = view.point(c);
+            double u[3] = {pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2]};
+            double v[3] = {pc[0] - pa[0], pc[1] - pa[1], pc[2] - pa[2]};
+            double n[3] = {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+            degenerate = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) <= min_double_area;
+        }
+        keep[index_triangle] = !degenerate;
+        if (degenerate)
+            degenerate_triangles++;
+    }
+    report.degenerate_triangles = degenerate_triangles;
+
+    // Compact arrays
+    poly_data = view.extractTriangles(keep, representative);
+    report.output_points = poly_data->GetNumberOfPoints();
+    report.output_triangles = poly_data->GetNumberOfPolys();
+    report.unused_points = report.input_points - report.merged_points - report.output_points;
+    report.time = watch.getTime();
+    return report.output_triangles > 0;
+}
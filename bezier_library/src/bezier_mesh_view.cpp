@@ -0,0 +1,188 @@
+#include "bezier_library/bezier_mesh_view.hpp"
+
+// VTK headers
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+
+BezierMeshView::BezierMeshView(vtkSmartPointer<vtkPolyData> poly_data) :
+        poly_data_(poly_data), number_of_points_(0), number_of_triangles_(0), points_(NULL), triangles_(NULL),
+        triangle_stride_(3), triangle_offset_(0), normals_(NULL), first_polygon_cell_(0)
+{
+    //////////// POINTS ////////////
+    vtkPoints *points = poly_data_->GetPoints();
+    if (points)
+    {
+        number_of_points_ = points->GetNumberOfPoints();
+        vtkFloatArray *float_points = vtkFloatArray::SafeDownCast(points->GetData());
+        if (float_points)
+            points_ = float_points->GetPointer(0); //zero copy
+        else
+        {
+            points_copy_.resize(3 * number_of_points_);
+            for (vtkIdType i = 0; i < number_of_points_; i++)
+            {
+                double p[3];
+                points->GetPoint(i, p);
+                points_copy_[3 * i] = p[0];
+                points_copy_[3 * i + 1] = p[1];
+                points_copy_[3 * i + 2] = p[2];
+            }
+            points_ = points_copy_.empty() ? NULL : &points_copy_[0];
+        }
+    }
+
+    //////////// TRIANGLES ////////////
+    vtkCellArray *polys = poly_data_->GetPolys();
+    first_polygon_cell_ = poly_data_->GetNumberOfVerts() + poly_data_->GetNumberOfLines();
+    if (polys && polys->GetNumberOfCells() > 0)
+    {
+        vtkIdType number_of_cells = polys->GetNumberOfCells();
+        vtkIdType *connectivity = polys->GetPointer();
+        // VTK layout is (n, id0, id1, ..., n, id0, ...) : zero copy if all cells are triangles
+        bool triangles_only = (polys->GetNumberOfConnectivityEntries() == 4 * number_of_cells);
+        for (vtkIdType i = 0; triangles_only && i < number_of_cells; i++)
+            triangles_only = (connectivity[4 * i] == 3);
+        if (triangles_only)
+        {
+            triangles_ = connectivity;
+            triangle_stride_ = 4;
+            triangle_offset_ = 1;
+            number_of_triangles_ = number_of_cells;
+        }
+        else
+        {
+            // Fan triangulation of polygons
+            triangles_copy_.reserve(3 * number_of_cells);
+            triangle_cells_.reserve(number_of_cells);
+            vtkIdType *indices;
+            vtkIdType numberOfPoints;
+            vtkIdType index_cell = 0;
+            for (polys->InitTraversal(); polys->GetNextCell(numberOfPoints, indices); index_cell++)
+            {
+                for (vtkIdType i = 1; i + 1 < numberOfPoints; i++)
+                {
+                    triangles_copy_.push_back(indices[0]);
+                    triangles_copy_.push_back(indices[i]);
+                    triangles_copy_.push_back(indices[i + 1]);
+                    triangle_cells_.push_back(index_cell);
+                }
+            }
+            number_of_triangles_ = triangles_copy_.size() / 3;
+            triangles_ = triangles_copy_.empty() ? NULL : &triangles_copy_[0];
+        }
+    }
+
+    //////////// NORMALS ////////////
+    vtkDataArray *normals = poly_data_->GetPointData()->GetNormals();
+    if (normals && normals->GetNumberOfTuples() == number_of_points_ && normals->GetNumberOfComponents() == 3)
+    {
+        vtkFloatArray *float_normals = vtkFloatArray::SafeDownCast(normals);
+        if (float_normals)
+            normals_ = float_normals->GetPointer(0); //zero copy
+        else
+        {
+            normals_copy_.resize(3 * number_of_points_);
+            for (vtkIdType i = 0; i < number_of_points_; i++)
+            {
+                double n[3];
+                normals->GetTuple(i, n);
+                normals_copy_[3 * i] = n[0];
+                normals_copy_[3 * i + 1] = n[1];
+                normals_copy_[3 * i + 2] = n[2];
+            }
+            normals_ = normals_copy_.empty() ? NULL : &normals_copy_[0];
+        }
+    }
+}
+
+vtkSmartPointer<vtkPolyData> BezierMeshView::extractTriangles(const std::vector<unsigned char> &keep) const
+{
+    // Each point is its own representative
+    std::vector<long> representative(number_of_points_);
+    for (vtkIdType i = 0; i < number_of_points_; i++)
+        representative[i] = i;
+    return extractTriangles(keep, representative);
+}
+
+vtkSmartPointer<vtkPolyData> BezierMeshView::extractTriangles(const std::vector<unsigned char> &keep, const std::vector<long> &representative) const
+{
+    // Give a new index to each representative referenced by a kept triangle (-1 : unused point)
+    std::vector<vtkIdType> point_map(number_of_points_, -1);
+    vtkIdType new_number_of_points = 0;
+    vtkIdType new_number_of_triangles = 0;
+    for (vtkIdType index_triangle = 0; index_triangle < number_of_triangles_; index_triangle++)
+    {
+        if (!keep[index_triangle])
+            continue;
+        const vtkIdType *ids = triangle(index_triangle);
+        for (int i = 0; i < 3; i++)
+        {
+            long id = representative[ids[i]];
+            if (point_map[id] < 0)
+                point_map[id] = new_number_of_points++;
+        }
+        new_number_of_triangles++;
+    }
+
+    // Copy referenced points (source precision) and their data (normals...)
+    vtkSmartPointer<vtkPolyData> compact_poly_data = vtkSmartPointer<vtkPolyData>::New();
+    vtkSmartPointer<vtkPoints> new_points = vtkSmartPointer<vtkPoints>::New();
+    vtkPoints *old_points = poly_data_->GetPoints();
+    const bool float_points = points_copy_.empty();
+    if (float_points)
+        new_points->SetDataTypeToFloat();
+    else
+        new_points->SetDataType(old_points->GetDataType());
+    new_points->SetNumberOfPoints(new_number_of_points);
+    float *new_coordinates = float_points ? vtkFloatArray::SafeDownCast(new_points->GetData())->GetPointer(0) : NULL;
+    vtkPointData *old_point_data = poly_data_->GetPointData();
+    vtkPointData *new_point_data = compact_poly_data->GetPointData();
+    new_point_data->CopyAllocate(old_point_data, new_number_of_points);
+    for (vtkIdType old_id = 0; old_id < number_of_points_; old_id++)
+    {
+        vtkIdType new_id = point_map[old_id];
+        if (new_id < 0)
+            continue;
+        if (float_points)
+        {
+            new_coordinates[3 * new_id] = points_[3 * old_id];
+            new_coordinates[3 * new_id + 1] = points_[3 * old_id + 1];
+            new_coordinates[3 * new_id + 2] = points_[3 * old_id + 2];
+        }
+        else
+            new_points->SetPoint(new_id, old_points->GetPoint(old_id));
+        new_point_data->CopyData(old_point_data, old_id, new_id);
+    }
+
+    // Remap connectivity : written directly in VTK layout (3, id0, id1, id2). Cell data follow their polygon.
+    vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+    connectivity->SetNumberOfValues(4 * new_number_of_triangles);
+    vtkIdType *cell = connectivity->GetPointer(0);
+    vtkCellData *old_cell_data = poly_data_->GetCellData();
+    vtkCellData *new_cell_data = compact_poly_data->GetCellData();
+    new_cell_data->CopyAllocate(old_cell_data, new_number_of_triangles);
+    vtkIdType new_cell = 0;
+    for (vtkIdType index_triangle = 0; index_triangle < number_of_triangles_; index_triangle++)
+    {
+        if (!keep[index_triangle])
+            continue;
+        const vtkIdType *ids = triangle(index_triangle);
+        cell[0] = 3;
+        cell[1] = point_map[representative[ids[0]]];
+        cell[2] = point_map[representative[ids[1]]];
+        cell[3] = point_map[representative[ids[2]]];
+        cell += 4;
+        new_cell_data->CopyData(old_cell_data, this->cell(index_triangle), new_cell++);
+    }
+    vtkSmartPointer<vtkCellArray> new_polys = vtkSmartPointer<vtkCellArray>::New();
+    new_polys->SetCells(new_number_of_triangles, connectivity);
+
+    compact_poly_data->SetPoints(new_points);
+    compact_poly_data->SetPolys(new_polys);
+    return compact_poly_data;
+}
@@ -0,0 +1,224 @@
+#include "bezier_library/bezier_normals.hpp"
+#include "bezier_library/bezier_mesh_view.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// VTK headers
+#include <vtkFloatArray.h>
+#include <vtkPointData.h>
+
+BezierNormals::BezierNormals() :
+        number_of_computations_(0)
+{
+}
+
+void BezierNormals::clear()
+{
+    cache_.clear();
+}
+
+namespace
+{
+/** @brief Triangle edge, oriented as traversed by the triangle */
+struct TriangleEdge
+{
+    vtkIdType low;
+    vtkIdType high;
+    long triangle;
+    bool forward;
+    bool operator<(const TriangleEdge &other) const
+    {
+        if (low != other.low)
+            return low < other.low;
+        return high < other.high;
+    }
+};
+}
+
+void BezierNormals::consistentOrientation(const BezierMeshView &view, std::vector<signed char> &signs)
+{
+    const long number_of_triangles = view.numberOfTriangles();
+    signs.assign(number_of_triangles, 0);
+
+    // Edges sorted by end points : triangles sharing an edge are contiguous
+    std::vector<TriangleEdge> edges(3 * number_of_triangles);
+    for (long index_triangle = 0; index_triangle < number_of_triangles; index_triangle++)
+    {
+        const vtkIdType *ids = view.triangle(index_triangle);
+        for (int k = 0; k < 3; k++)
+        {
+            TriangleEdge &edge = edges[3 * index_triangle + k];
+            const vtkIdType from = ids[k], to = ids[(k + 1) % 3];
+            edge.low = std::min(from, to);
+            edge.high = std::max(from, to);
+            edge.triangle = index_triangle;
+            edge.forward = (from < to);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    // Neighbours across manifold edges (non manifold edges do not propagate orientation)
+    std::vector<long> neighbours(3 * number_of_triangles, -1);
+    std::vector<bool> same_direction(3 * number_of_triangles, false);
+    std::vector<unsigned char> number_of_neighbours(number_of_triangles, 0);
+    for (size_t begin = 0; begin < edges.size();)
+    {
+        size_t end = begin + 1;
+        while (end < edges.size() && edges[end].low == edges[begin].low && edges[end].high == edges[begin].high)
+            end++;
+        if (end - begin == 2 && edges[begin].triangle != edges[begin + 1].triangle)
+        {
+            const TriangleEdge &first = edges[begin], &second = edges[begin + 1];
+            const bool same = (first.forward == second.forward);
+            neighbours[3 * first.triangle + number_of_neighbours[first.triangle]] = second.triangle;
+            same_direction[3 * first.triangle + number_of_neighbours[first.triangle]++] = same;
+            neighbours[3 * second.triangle + number_of_neighbours[second.triangle]] = first.triangle;
+            same_direction[3 * second.triangle + number_of_neighbours[second.triangle]++] = same;
+        }
+        begin = end;
+    }
+
+    // Breadth-first propagation : neighbours must traverse their shared edge in opposite directions
+    std::vector<long> component;
+    for (long seed = 0; seed < number_of_triangles; seed++)
+    {
+        if (signs[seed] != 0)
+            continue;
+        component.clear();
+        component.push_back(seed);
+        signs[seed] = 1;
+        long reversed = 0;
+        for (size_t index = 0; index < component.size(); index++)
+        {
+            const long current = component[index];
+            for (int k = 0; k < number_of_neighbours[current]; k++)
+            {
+                const long neighbour = neighbours[3 * current + k];
+                if (signs[neighbour] != 0)
+                    continue;
+                signs[neighbour] = same_direction[3 * current + k] ? -signs[current] : signs[current];
+                if (signs[neighbour] < 0)
+                    reversed++;
+                component.push_back(neighbour);
+            }
+        }
+        // The component keeps the orientation of the majority of its triangles
+        if (2 * reversed > (long) component.size())
+            for (size_t index = 0; index < component.size(); index++)
+                signs[component[index]] = -signs[component[index]];
+    }
+}
+
+void BezierNormals::areaWeightedNormals(const BezierMeshView &view, bool flip, float *normals)
+{
+    const long number_of_points = view.numberOfPoints();
+    const long number_of_triangles = view.numberOfTriangles();
+
+    // Orientation of each triangle (+1 / -1) so that each connected component is consistently oriented
+    std::vector<signed char> signs;
+    consistentOrientation(view, signs);
+
+    // Triangle normals (not normalized : norm = 2 * area), consistently oriented
+    std::vector<float> triangle_normals(3 * number_of_triangles);
+#pragma omp parallel for
+    for (long index_triangle = 0; index_triangle < number_of_triangles; index_triangle++)
+    {
+        const vtkIdType *ids = view.triangle(index_triangle);
+        const float *a = view.point(ids[0]), *b = view.point(ids[1]), *c = view.point(ids[2]);
+        float u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        float v[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+        float *n = &triangle_normals[3 * index_triangle];
+        n[0] = u[1] * v[2] - u[2] * v[1];
+        n[1] = u[2] * v[0] - u[0] * v[2];
+        n[2] = u[0] * v[1] - u[1] * v[0];
+        if (signs[index_triangle] < 0)
+        {
+            n[0] = -n[0];
+            n[1] = -n[1];
+            n[2] = -n[2];
+        }
+    }
+
+    // Point -> triangles adjacency (compressed rows)
+    std::vector<long> offsets(number_of_points + 1, 0);
+    for (long index_triangle = 0; index_triangle < number_of_triangles; index_triangle++)
+    {
+        const vtkIdType *ids = view.triangle(index_triangle);
+        offsets[ids[0] + 1]++;
+        offsets[ids[1] + 1]++;
+        offsets[ids[2] + 1]++;
+    }
+    for (long i = 0; i < number_of_points; i++)
+        offsets[i + 1] += offsets[i];
+    std::vector<long> adjacency(offsets[number_of_points]);
+    std::vector<long> cursor(offsets.begin(), offsets.end() - 1);
+    for (long index_triangle = 0; index_triangle < number_of_triangles; index_triangle++)
+    {
+        const vtkIdType *ids = view.triangle(index_triangle);
+        adjacency[cursor[ids[0]]++] = index_triangle;
+        adjacency[cursor[ids[1]]++] = index_triangle;
+        adjacency[cursor[ids[2]]++] = index_triangle;
+    }
+
+    // Point normals : gather (no write conflict between threads)
+    const float sign = flip ? -1.0f : 1.0f;
+#pragma omp parallel for
+    for (long index_point = 0; index_point < number_of_points; index_point++)
+    {
+        double sum[3] = {0, 0, 0};
+        for (long k = offsets[index_point]; k < offsets[index_point + 1]; k++)
+        {
+            const float *n = &triangle_normals[3 * adjacency[k]];
+            sum[0] += n[0];
+            sum[1] += n[1];
+            sum[2] += n[2];
+        }
+        double norm = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+        double scale = (norm > 0) ? sign / norm : 0;
+        normals[3 * index_point] = sum[0] * scale;
+        normals[3 * index_point + 1] = sum[1] * scale;
+        normals[3 * index_point + 2] = sum[2] * scale;
+    }
+}
+
+bool BezierNormals::compute(vtkSmartPointer<vtkPolyData> poly_data, bool flip)
+{
+    // Look for this mesh version in cache (and purge deleted meshes)
+    for (size_t i = 0; i < cache_.size();)
+    {
+        if (!cache_[i].poly_data)
+        {
+            cache_.erase(cache_.begin() + i);
+            continue;
+        }
+        if (cache_[i].poly_data == poly_data.GetPointer())
+        {
+            if (cache_[i].mtime == poly_data->GetMTime() && cache_[i].flip == flip && poly_data->GetPointData()->GetNormals())
+                return true; //already computed
+            cache_.erase(cache_.begin() + i); //mesh has been modified
+            continue;
+        }
+        i++;
+    }
+
+    // Compute normals
+    BezierMeshView view(poly_data);
+    if (view.numberOfPoints() == 0 || view.numberOfTriangles() == 0)
+        return false;
+    vtkSmartPointer<vtkFloatArray> normals = vtkSmartPointer<vtkFloatArray>::New();
+    normals->SetName("Normals");
+    normals->SetNumberOfComponents(3);
+    normals->SetNumberOfTuples(view.numberOfPoints());
+    areaWeightedNormals(view, flip, normals->GetPointer(0));
+    poly_data->GetPointData()->SetNormals(normals);
+    number_of_computations_++;
+
+    // Cache this mesh version (modification time after normals are set)
+    CacheEntry entry;
+    entry.poly_data = poly_data.GetPointer();
+    entry.mtime = poly_data->GetMTime();
+    entry.flip = flip;
+    cache_.push_back(entry);
+    return true;
+}
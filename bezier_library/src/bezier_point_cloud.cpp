@@ -0,0 +1,244 @@
+#include "bezier_library/bezier_point_cloud.hpp"
+#include "bezier_library/bezier_impl.hpp"
+#include "bezier_library/bezier_mesh_view.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// VTK headers
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkKdTreePointLocator.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+
+//////////////////// CONSTRUCTORS ////////////////////
+BezierPointCloud::BezierPointCloud(const PointNormalCloudT &input_cloud, const PointNormalCloudT &default_cloud, double grind_depth,
+                                   double effector_diameter, double covering, int extrication_coefficiant, int extrication_frequency) :
+        Bezier(new BezierImpl(input_cloud, default_cloud, grind_depth, effector_diameter, covering, extrication_coefficiant, extrication_frequency))
+{
+}
+
+//Point cloud Constructor
+BezierImpl::BezierImpl(const PointNormalCloudT &input_cloud, const PointNormalCloudT &default_cloud, double grind_depth, double effector_diameter,
+                       double covering, int extrication_coefficiant, int extrication_frequency) :
+        grind_depth_(grind_depth), extrication_coefficiant_(extrication_coefficiant), extrication_frequency_(extrication_frequency),
+        effector_diameter_(effector_diameter), covering_(covering), weld_tolerance_(0.00001), stitch_gap_(0),
+        resampling_chordal_tolerance_(0), resampling_angular_tolerance_(0), smoothing_window_(0), smoothing_max_deviation_(0), decimated_(false),
+        max_reorientation_(0),
+        gouge_check_(false), gouge_max_tilt_(0), gouge_max_lift_(0),
+        prepared_(false), passes_depth_(0), distance_field_depth_(0), distance_field_grind_depth_(0), tile_memory_budget_(0), parallel_tiles_(1),
+        dilation_cache_grind_depth_(0), point_cloud_(true), cloud_band_width_(0), cloud_bin_length_(0), mesh_normal_vector_(Eigen::Vector3d::Identity()),
+        vector_dir_(Eigen::Vector3d::Identity())
+{
+    this->inputPolyData_ = cloudToPolyData(input_cloud);
+    this->defaultPolyData_ = cloudToPolyData(default_cloud);
+    printf("\nPoint cloud mode : %ld input points, %ld default points", (long)this->inputPolyData_->GetNumberOfPoints(),
+           (long)this->defaultPolyData_->GetNumberOfPoints());
+    if (this->inputPolyData_->GetNumberOfPoints() == 0)
+        printf("Can't load input cloud");
+    if (this->defaultPolyData_->GetNumberOfPoints() == 0)
+        printf("Can't load default cloud");
+    this->printSelf();
+}
+
+//////////////////// POINT CLOUD MODE ////////////////////
+///@brief Build a cloud (points and normals, no cells) with a subset of the points of a view
+static vtkSmartPointer<vtkPolyData> extractPoints(const BezierMeshView &view, const std::vector<unsigned char> &keep)
+{
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkFloatArray> normals = vtkSmartPointer<vtkFloatArray>::New();
+    normals->SetNumberOfComponents(3);
+    normals->SetName("Normals");
+    vtkIdType number_of_points = std::count(keep.begin(), keep.end(), 1);
+    points->Allocate(number_of_points);
+    normals->Allocate(3 * number_of_points);
+    for (vtkIdType i = 0; i < view.numberOfPoints(); i++)
+    {
+        if (!keep[i])
+            continue;
+        points->InsertNextPoint(view.point(i));
+        normals->InsertNextTuple(view.normal(i));
+    }
+    vtkSmartPointer<vtkPolyData> poly_data = vtkSmartPointer<vtkPolyData>::New();
+    poly_data->SetPoints(points);
+    poly_data->GetPointData()->SetNormals(normals);
+    return poly_data;
+}
+
+vtkSmartPointer<vtkPolyData> BezierImpl::cloudToPolyData(const PointNormalCloudT &cloud)
+{
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkFloatArray> normals = vtkSmartPointer<vtkFloatArray>::New();
+    normals->SetNumberOfComponents(3);
+    normals->SetName("Normals");
+    points->Allocate(cloud.size());
+    normals->Allocate(3 * cloud.size());
+    for (size_t i = 0; i < cloud.size(); i++)
+    {
+        const PointNormalT &p = cloud.points[i];
+        Eigen::Vector3f normal(p.normal_x, p.normal_y, p.normal_z);
+        if (!pcl::isFinite(p) || !pcl_isfinite(p.normal_x) || !pcl_isfinite(p.normal_y) || !pcl_isfinite(p.normal_z) || normal.squaredNorm() == 0)
+            continue;
+        normal.normalize();
+        points->InsertNextPoint(p.x, p.y, p.z);
+        normals->InsertNextTuple3(normal[0], normal[1], normal[2]);
+    }
+    vtkSmartPointer<vtkPolyData> poly_data = vtkSmartPointer<vtkPolyData>::New();
+    poly_data->SetPoints(points);
+    poly_data->GetPointData()->SetNormals(normals);
+    return poly_data;
+}
+
+bool BezierImpl::offsetCloud(double depth, vtkSmartPointer<vtkPolyData> &offset_poly_data)
+{
+    BezierMeshView input_view(this->inputPolyData_);
+    if (!input_view.hasNormals() || input_view.numberOfPoints() == 0)
+        return false;
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkFloatArray> normals = vtkSmartPointer<vtkFloatArray>::New();
+    normals->SetNumberOfComponents(3);
+    normals->SetName("Normals");
+    points->SetNumberOfPoints(input_view.numberOfPoints());
+    normals->SetNumberOfTuples(input_view.numberOfPoints());
+    for (vtkIdType i = 0; i < input_view.numberOfPoints(); i++)
+    {
+        const float *p = input_view.point(i);
+        const float *n = input_view.normal(i);
+        points->SetPoint(i, p[0] + depth * n[0], p[1] + depth * n[1], p[2] + depth * n[2]);
+        normals->SetTuple3(i, -n[0], -n[1], -n[2]); //oriented towards input cloud
+    }
+    offset_poly_data = vtkSmartPointer<vtkPolyData>::New();
+    offset_poly_data->SetPoints(points);
+    offset_poly_data->GetPointData()->SetNormals(normals);
+    return true;
+}
+
+bool BezierImpl::defaultIntersectionCloud(vtkSmartPointer<vtkPolyData> &poly_data)
+{
+    // Build a Kdtree on default
+    vtkSmartPointer<vtkKdTreePointLocator> kDTreeDefault = vtkSmartPointer<vtkKdTreePointLocator>::New();
+    kDTreeDefault->SetDataSet(this->defaultPolyData_);
+    kDTreeDefault->BuildLocator();
+    BezierMeshView default_view(this->defaultPolyData_);
+    BezierMeshView view(poly_data);
+    if (!default_view.hasNormals() || !view.hasNormals() || default_view.numberOfPoints() == 0)
+        return false;
+    std::vector<unsigned char> keep_points(view.numberOfPoints(), 0);
+    bool intersection_flag = false;
+    for (vtkIdType index_point = 0; index_point < view.numberOfPoints(); index_point++)
+    {
+        if (!this->progress_.keepGoing())
+            return false;
+        const float *p = view.point(index_point);
+        double pt[3] = {p[0], p[1], p[2]};
+        //get closest point (in default cloud)
+        vtkIdType iD = kDTreeDefault->FindClosestPoint(pt);
+        const float *closestPoint = default_view.point(iD);
+        Eigen::Vector3d direction_vector(closestPoint[0] - pt[0], closestPoint[1] - pt[1], closestPoint[2] - pt[2]);
+        const float *normal = default_view.normal(iD);
+        Eigen::Vector3d normal_vector(normal[0], normal[1], normal[2]);
+        direction_vector.normalize();
+        //point is inside default cloud if default outward normal points away from it (same threshold as meshes)
+        if (normal_vector.dot(direction_vector) > 0.1)
+        {
+            keep_points[index_point] = 1;
+            intersection_flag = true;
+        }
+    }
+    //remove outside points
+    poly_data = extractPoints(view, keep_points);
+    return intersection_flag;
+}
+
+vtkSmartPointer<vtkPolyData> BezierImpl::sliceCloud(vtkSmartPointer<vtkPolyData> poly_data, const double origin[3], const Eigen::Vector3d &cut_dir,
+                                                    int number_of_slices, double min_value, double max_value)
+{
+    vtkSmartPointer<vtkPolyData> slices = vtkSmartPointer<vtkPolyData>::New();
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+    vtkSmartPointer<vtkFloatArray> normals = vtkSmartPointer<vtkFloatArray>::New();
+    normals->SetNumberOfComponents(3);
+    normals->SetName("Normals");
+    slices->SetPoints(points);
+    slices->SetLines(lines);
+    slices->GetPointData()->SetNormals(normals);
+    BezierMeshView view(poly_data);
+    if (!view.hasNormals() || number_of_slices < 1)
+        return slices;
+
+    // Planes are placed like vtkCutter::GenerateValues
+    const double increment = (number_of_slices > 1) ? (max_value - min_value) / (number_of_slices - 1) : 0;
+    const double virtual_effector_diameter = this->effector_diameter_ * (1 - this->covering_);
+    const double band_width = (this->cloud_band_width_ > 0) ? this->cloud_band_width_ : virtual_effector_diameter / 10;
+    const double bin_length = (this->cloud_bin_length_ > 0) ? this->cloud_bin_length_ : band_width;
+    const Eigen::Vector3d plane_origin(origin[0], origin[1], origin[2]);
+    Eigen::Vector3d slice_dir = cut_dir.cross(this->mesh_normal_vector_);
+    if (slice_dir.squaredNorm() == 0)
+        return slices;
+    slice_dir.normalize();
+
+    //////////// GATHER POINTS CLOSE TO EACH PLANE : (position along slice, point id) ////////////
+    std::vector<std::vector<std::pair<double, vtkIdType> > > bands(number_of_slices);
+    for (vtkIdType i = 0; i < view.numberOfPoints(); i++)
+    {
+        const float *p = view.point(i);
+        Eigen::Vector3d point(p[0], p[1], p[2]);
+        double value = cut_dir.dot(point - plane_origin);
+        int index_slice = (increment > 0) ? (int)std::floor((value - min_value) / increment + 0.5) : 0;
+        if (index_slice < 0 || index_slice >= number_of_slices || std::abs(value - (min_value + index_slice * increment)) > band_width / 2)
+            continue;
+        bands[index_slice].push_back(std::make_pair(slice_dir.dot(point), i));
+    }
+
+    //////////// ORDER POINTS ALONG EACH SLICE AND AVERAGE THEM IN BINS ////////////
+    for (int index_slice = 0; index_slice < number_of_slices; index_slice++)
+    {
+        std::vector<std::pair<double, vtkIdType> > &band = bands[index_slice];
+        if (band.empty())
+            continue;
+        std::sort(band.begin(), band.end());
+        const double plane_value = min_value + index_slice * increment;
+        std::vector<vtkIdType> line; // point ids (in slices) of current polyline
+        double last_position = 0;
+        for (size_t begin = 0; begin < band.size();)
+        {
+            // Points of this bin
+            size_t end = begin;
+            Eigen::Vector3d point(Eigen::Vector3d::Zero()), normal(Eigen::Vector3d::Zero());
+            for (; end < band.size() && band[end].first < band[begin].first + bin_length; end++)
+            {
+                const float *p = view.point(band[end].second);
+                const float *n = view.normal(band[end].second);
+                point += Eigen::Vector3d(p[0], p[1], p[2]);
+                normal += Eigen::Vector3d(n[0], n[1], n[2]);
+            }
+            point /= (end - begin);
+            if (normal.squaredNorm() > 0)
+                normal.normalize();
+            else
+            {
+                const float *n = view.normal(band[begin].second);
+                normal = Eigen::Vector3d(n[0], n[1], n[2]);
+            }
+            // Bin is projected on its plane
+            point -= (cut_dir.dot(point - plane_origin) - plane_value) * cut_dir;
+            // Missing bins (hole in cloud) : a new polyline begins, fragments are stitched later (see generateStripperOnSurface)
+            double position = slice_dir.dot(point);
+            if (!line.empty() && position - last_position > 2 * bin_length)
+            {
+                if (line.size() > 1)
+                    lines->InsertNextCell(line.size(), &line[0]);
+                line.clear();
+            }
+            line.push_back(points->InsertNextPoint(point[0], point[1], point[2]));
+            normals->InsertNextTuple3(normal[0], normal[1], normal[2]);
+            last_position = position;
+            begin = end;
+        }
+        if (line.size() > 1)
+            lines->InsertNextCell(line.size(), &line[0]);
+    }
+    return slices;
+}
@@ -0,0 +1,128 @@
+#include "bezier_library/bezier_preview.hpp"
+#include "bezier_library/bezier_impl.hpp"
+
+#include <cstdio>
+
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread_time.hpp>
+
+//////////////////// CONSTRUCTORS & DESTRUCTOR ////////////////////
+BezierPreview::BezierPreview(std::string filename_inputMesh, std::string filename_defaultMesh, double grind_depth, double effector_diameter,
+                             double covering, int extrication_coefficiant, int extrication_frequency, double weld_tolerance) :
+        Bezier(filename_inputMesh, filename_defaultMesh, grind_depth, effector_diameter, covering, extrication_coefficiant, extrication_frequency,
+               weld_tolerance),
+        preview_resolution_(BezierResolution::preview()), refinement_status_(BEZIER_FAILED), refining_(false)
+{
+}
+
+BezierPreview::~BezierPreview()
+{
+    this->cancelRefinement();
+}
+
+//////////////////// PUBLIC FUNCTIONS ////////////////////
+void BezierPreview::set_preview_resolution(const BezierResolution &resolution)
+{
+    this->preview_resolution_ = resolution;
+}
+
+bool BezierPreview::generatePreview(std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector,
+                                    std::vector<bool> &color_vector, std::vector<int> &index_vector, double time_budget)
+{
+    // Full quality object is only read by the preview : refinement must not run
+    this->cancelRefinement();
+    //////////// PREVIEW : DECIMATED MESHES, COARSE DISTANCE FIELD, FEWER SLICES ////////////
+    boost::scoped_ptr<BezierImpl> preview(this->get_impl().createPreview(this->preview_resolution_));
+    preview->set_deadline(time_budget);
+    bool success = preview->generateTrajectory(way_points_vector, color_vector, index_vector);
+    if (success)
+        printf("\nPreview trajectory : %lu poses, %lu passes\n", (unsigned long)way_points_vector.size(),
+               (unsigned long)(index_vector.empty() ? 0 : index_vector.size() - 1));
+    //////////// FULL QUALITY REFINEMENT IN BACKGROUND ////////////
+    this->refinement_token_.reset();
+    this->Bezier::set_cancellation_token(&this->refinement_token_);
+    {
+        boost::mutex::scoped_lock lock(this->mutex_);
+        this->refined_way_points_.clear();
+        this->refined_colors_.clear();
+        this->refined_indices_.clear();
+        this->refinement_status_ = BEZIER_RUNNING;
+        this->refining_ = true;
+    }
+    this->thread_ = boost::thread(boost::bind(&BezierPreview::refine, this));
+    return success;
+}
+
+void BezierPreview::set_cancellation_token(const BezierCancellationToken *)
+{
+    printf("\nBezierPreview : refinement keeps its own cancellation token, use cancelRefinement\n");
+}
+
+bool BezierPreview::waitRefinement(double timeout)
+{
+    boost::mutex::scoped_lock lock(this->mutex_);
+    if (timeout < 0)
+    {
+        while (this->refining_)
+            this->condition_.wait(lock);
+        return true;
+    }
+    boost::system_time deadline = boost::get_system_time() + boost::posix_time::microseconds((long)(timeout * 1e6));
+    while (this->refining_)
+    {
+        if (!this->condition_.timed_wait(lock, deadline))
+            return !this->refining_;
+    }
+    return true;
+}
+
+bool BezierPreview::refinementFinished()
+{
+    boost::mutex::scoped_lock lock(this->mutex_);
+    return !this->refining_;
+}
+
+bool BezierPreview::getRefinedTrajectory(std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector,
+                                         std::vector<bool> &color_vector, std::vector<int> &index_vector)
+{
+    boost::mutex::scoped_lock lock(this->mutex_);
+    if (this->refining_ || this->refinement_status_ != BEZIER_SUCCEEDED)
+        return false;
+    way_points_vector = this->refined_way_points_;
+    color_vector = this->refined_colors_;
+    index_vector = this->refined_indices_;
+    return true;
+}
+
+void BezierPreview::cancelRefinement()
+{
+    this->refinement_token_.cancel();
+    if (this->thread_.joinable())
+        this->thread_.join();
+}
+
+BezierStatus BezierPreview::get_refinement_status()
+{
+    boost::mutex::scoped_lock lock(this->mutex_);
+    return this->refinement_status_;
+}
+
+//////////////////// PRIVATE FUNCTIONS ////////////////////
+void BezierPreview::refine()
+{
+    std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > way_points_vector;
+    std::vector<bool> color_vector;
+    std::vector<int> index_vector;
+    this->generateTrajectory(way_points_vector, color_vector, index_vector);
+    BezierStatus status = this->get_status();
+    {
+        boost::mutex::scoped_lock lock(this->mutex_);
+        this->refined_way_points_.swap(way_points_vector);
+        this->refined_colors_.swap(color_vector);
+        this->refined_indices_.swap(index_vector);
+        this->refinement_status_ = status;
+        this->refining_ = false;
+    }
+    this->condition_.notify_all();
+}
@@ -0,0 +1,123 @@
+#include "bezier_library/bezier_progress.hpp"
+
+#include <algorithm>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+///@brief Overall fraction done at the beginning of each stage (last value : done)
+static const double stage_start[BEZIER_STAGE_DONE + 1] = {0.0, 0.05, 0.4, 0.95, 0.975, 1.0};
+
+///@brief Clock is read once every clock_period calls of keepGoing
+static const unsigned int clock_period = 64;
+
+BezierProgressTracker::BezierProgressTracker() :
+        callback_(NULL), token_(NULL), deadline_(0), running_(false), calls_(0), status_(BEZIER_SUCCEEDED), reported_fraction_(0)
+{
+    this->progress_.stage = BEZIER_STAGE_DONE;
+    this->progress_.status = BEZIER_SUCCEEDED;
+    this->progress_.passe = -1;
+    this->progress_.number_of_passes = 0;
+    this->progress_.fraction = 0;
+    this->progress_.elapsed_time = 0;
+    this->progress_.remaining_time = -1;
+}
+
+void BezierProgressTracker::start()
+{
+    this->start_time_ = boost::posix_time::microsec_clock::universal_time();
+    this->running_ = true;
+    this->calls_ = 0;
+    this->status_ = BEZIER_RUNNING;
+    this->progress_.stage = BEZIER_STAGE_PREPARATION;
+    this->progress_.status = BEZIER_RUNNING;
+    this->progress_.fraction = 0;
+    this->progress_.passe = -1;
+    this->progress_.number_of_passes = 0;
+    this->reported_fraction_ = 0;
+}
+
+bool BezierProgressTracker::stage(BezierStage stage, int number_of_passes)
+{
+    if (!this->running_)
+        return true;
+    this->progress_.stage = stage;
+    this->progress_.passe = -1;
+    this->progress_.number_of_passes = number_of_passes;
+    this->progress_.fraction = stage_start[stage];
+    this->calls_ = clock_period; // check deadline now
+    if (!keepGoing())
+        return false;
+    report();
+    return true;
+}
+
+bool BezierProgressTracker::update(int passe, double stage_fraction)
+{
+    if (!this->running_)
+        return true;
+    if (!keepGoing())
+        return false;
+    const BezierStage stage = this->progress_.stage;
+    if (stage == BEZIER_STAGE_DONE)
+        return true;
+    stage_fraction = std::min(1.0, std::max(0.0, stage_fraction));
+    this->progress_.passe = passe;
+    this->progress_.fraction = stage_start[stage] + stage_fraction * (stage_start[stage + 1] - stage_start[stage]);
+    if (this->progress_.fraction - this->reported_fraction_ >= 0.005)
+        report();
+    return true;
+}
+
+bool BezierProgressTracker::keepGoing()
+{
+    if (!this->running_)
+        return true;
+    if (this->status_ != BEZIER_RUNNING)
+        return false;
+    if (this->token_ && this->token_->cancelled())
+    {
+        this->status_ = BEZIER_CANCELLED;
+        return false;
+    }
+    if (this->deadline_ > 0 && ++this->calls_ >= clock_period)
+    {
+        this->calls_ = 0;
+        boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::universal_time() - this->start_time_;
+        if (elapsed.total_microseconds() * 1e-6 > this->deadline_)
+        {
+            this->status_ = BEZIER_DEADLINE_EXCEEDED;
+            return false;
+        }
+    }
+    return true;
+}
+
+BezierStatus BezierProgressTracker::finish(bool success)
+{
+    this->running_ = false;
+    if (this->status_ == BEZIER_RUNNING)
+        this->status_ = success ? BEZIER_SUCCEEDED : BEZIER_FAILED;
+    this->progress_.stage = BEZIER_STAGE_DONE;
+    this->progress_.status = this->status_;
+    this->progress_.passe = -1;
+    if (this->status_ == BEZIER_SUCCEEDED)
+        this->progress_.fraction = 1.0;
+    report();
+    return this->status_;
+}
+
+void BezierProgressTracker::report()
+{
+    if (!this->callback_)
+        return;
+    boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::universal_time() - this->start_time_;
+    this->progress_.elapsed_time = elapsed.total_microseconds() * 1e-6;
+    if (this->progress_.stage == BEZIER_STAGE_DONE)
+        this->progress_.remaining_time = 0;
+    else if (this->progress_.fraction > 0.01)
+        this->progress_.remaining_time = this->progress_.elapsed_time * (1 - this->progress_.fraction) / this->progress_.fraction;
+    else
+        this->progress_.remaining_time = -1;
+    this->reported_fraction_ = this->progress_.fraction;
+    this->callback_->progress(this->progress_);
+}
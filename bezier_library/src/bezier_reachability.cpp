@@ -0,0 +1,207 @@
+#include "bezier_library/bezier_reachability.hpp"
+
+#include <cmath>
+#include <limits>
+
+//////////////////// ROBOT MODEL ////////////////////
+BezierRobotModel::BezierRobotModel() :
+        a1(0.15), a2(-0.2), b(0), c1(0.45), c2(0.6), c3(0.64), c4(0.1), tool(Eigen::Affine3d::Identity())
+{
+    const double offsets_m10ia[6] = {0, 0, -M_PI / 2, 0, 0, 0};
+    const int signs_m10ia[6] = {1, 1, -1, -1, -1, -1};
+    const double min_m10ia[6] = {-2.9671, -1.5707, -2.4435, -3.3161, -2.4434, -4.7123};
+    const double max_m10ia[6] = {2.9671, 2.7925, 4.0142, 3.3161, 2.4434, 4.7123};
+    for (int i = 0; i < 6; i++)
+    {
+        offsets[i] = offsets_m10ia[i];
+        sign_corrections[i] = signs_m10ia[i];
+        joint_min[i] = min_m10ia[i];
+        joint_max[i] = max_m10ia[i];
+    }
+}
+
+//////////////////// KINEMATICS ////////////////////
+BezierReachability::BezierReachability(const BezierRobotModel &model) :
+        model_(model), tool_inverse_(model.tool.inverse())
+{
+}
+
+Eigen::Affine3d BezierReachability::forward(const double joints[6]) const
+{
+    const BezierRobotModel &m = this->model_;
+    double q[6];
+    for (int i = 0; i < 6; i++)
+        q[i] = joints[i] * m.sign_corrections[i] - m.offsets[i];
+
+    // Wrist center
+    const double psi3 = std::atan2(m.a2, m.c3);
+    const double k = std::sqrt(m.a2 * m.a2 + m.c3 * m.c3);
+    const double cx1 = m.c2 * std::sin(q[1]) + k * std::sin(q[1] + q[2] + psi3) + m.a1;
+    const double cy1 = m.b;
+    const double cz1 = m.c2 * std::cos(q[1]) + k * std::cos(q[1] + q[2] + psi3);
+    Eigen::Vector3d center(cx1 * std::cos(q[0]) - cy1 * std::sin(q[0]), cx1 * std::sin(q[0]) + cy1 * std::cos(q[0]), cz1 + m.c1);
+
+    // Orientation
+    Eigen::Matrix3d rotation;
+    rotation = Eigen::AngleAxisd(q[0], Eigen::Vector3d::UnitZ()) * Eigen::AngleAxisd(q[1] + q[2], Eigen::Vector3d::UnitY())
+            * Eigen::AngleAxisd(q[3], Eigen::Vector3d::UnitZ()) * Eigen::AngleAxisd(q[4], Eigen::Vector3d::UnitY())
+            * Eigen::AngleAxisd(q[5], Eigen::Vector3d::UnitZ());
+
+    Eigen::Affine3d flange(Eigen::Affine3d::Identity());
+    flange.linear() = rotation;
+    flange.translation() = center + m.c4 * rotation.col(2);
+    return flange * m.tool;
+}
+
+int BezierReachability::inverse(const Eigen::Affine3d &pose, double solutions[8][6]) const
+{
+    const BezierRobotModel &m = this->model_;
+    const Eigen::Affine3d flange(pose * this->tool_inverse_);
+    const Eigen::Matrix3d &r = flange.linear();
+    const Eigen::Vector3d center(flange.translation() - m.c4 * r.col(2));
+
+    // Position : axes 1, 2 and 3 (4 configurations)
+    const double nx1 = std::sqrt(center[0] * center[0] + center[1] * center[1] - m.b * m.b) - m.a1;
+    const double tmp1 = std::atan2(center[1], center[0]);
+    const double tmp2 = std::atan2(m.b, nx1 + m.a1);
+    const double theta1_i = tmp1 - tmp2;
+    const double theta1_ii = tmp1 + tmp2 - M_PI;
+
+    const double tmp3 = center[2] - m.c1;
+    const double s1_2 = nx1 * nx1 + tmp3 * tmp3;
+    const double tmp4 = nx1 + 2 * m.a1;
+    const double s2_2 = tmp4 * tmp4 + tmp3 * tmp3;
+    const double kappa_2 = m.a2 * m.a2 + m.c3 * m.c3;
+    const double c2_2 = m.c2 * m.c2;
+    const double s1 = std::sqrt(s1_2), s2 = std::sqrt(s2_2);
+
+    const double tmp5 = std::acos((s1_2 + c2_2 - kappa_2) / (2 * s1 * m.c2));
+    const double tmp6 = std::acos((s2_2 + c2_2 - kappa_2) / (2 * s2 * m.c2));
+    const double theta2_i = -tmp5 + std::atan2(nx1, tmp3);
+    const double theta2_ii = tmp5 + std::atan2(nx1, tmp3);
+    const double theta2_iii = -tmp6 - std::atan2(tmp4, tmp3);
+    const double theta2_iv = tmp6 - std::atan2(tmp4, tmp3);
+
+    const double tmp9 = 2 * m.c2 * std::sqrt(kappa_2);
+    const double tmp7 = std::acos((s1_2 - c2_2 - kappa_2) / tmp9);
+    const double tmp8 = std::acos((s2_2 - c2_2 - kappa_2) / tmp9);
+    const double psi3 = std::atan2(m.a2, m.c3);
+    const double theta3_i = tmp7 - psi3;
+    const double theta3_ii = -tmp7 - psi3;
+    const double theta3_iii = tmp8 - psi3;
+    const double theta3_iv = -tmp8 - psi3;
+
+    const double theta1[4] = {theta1_i, theta1_i, theta1_ii, theta1_ii};
+    const double theta2[4] = {theta2_i, theta2_ii, theta2_iii, theta2_iv};
+    const double theta3[4] = {theta3_i, theta3_ii, theta3_iii, theta3_iv};
+
+    // Orientation : spherical wrist (2 configurations for each position)
+    int number_of_solutions = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        const double sin1 = std::sin(theta1[i]), cos1 = std::cos(theta1[i]);
+        const double s23 = std::sin(theta2[i] + theta3[i]), c23 = std::cos(theta2[i] + theta3[i]);
+        const double mm = r(0, 2) * s23 * cos1 + r(1, 2) * s23 * sin1 + r(2, 2) * c23;
+        const double theta5 = std::atan2(std::sqrt(std::max(0.0, 1 - mm * mm)), mm);
+        const double theta4 = std::atan2(r(1, 2) * cos1 - r(0, 2) * sin1, r(0, 2) * c23 * cos1 + r(1, 2) * c23 * sin1 - r(2, 2) * s23);
+        const double theta6 = std::atan2(r(0, 1) * s23 * cos1 + r(1, 1) * s23 * sin1 + r(2, 1) * c23,
+                                         -r(0, 0) * s23 * cos1 - r(1, 0) * s23 * sin1 - r(2, 0) * c23);
+        const double model_solutions[2][6] = {{theta1[i], theta2[i], theta3[i], theta4, theta5, theta6},
+                                              {theta1[i], theta2[i], theta3[i], theta4 + M_PI, -theta5, theta6 - M_PI}};
+        for (int wrist = 0; wrist < 2; wrist++)
+        {
+            double *solution = solutions[2 * i + wrist];
+            bool finite = true;
+            for (int j = 0; j < 6; j++)
+            {
+                double value = (model_solutions[wrist][j] + m.offsets[j]) * m.sign_corrections[j];
+                // Wrap in ]-pi, pi]
+                value = std::atan2(std::sin(value), std::cos(value));
+                solution[j] = value;
+                finite = finite && (value == value);
+            }
+            if (finite)
+                number_of_solutions++;
+        }
+    }
+    return number_of_solutions;
+}
+
+bool BezierReachability::withinLimits(double joints[6]) const
+{
+    for (int j = 0; j < 6; j++)
+    {
+        if (!(joints[j] == joints[j]))
+            return false;
+        if (joints[j] < this->model_.joint_min[j])
+            joints[j] += 2 * M_PI;
+        else if (joints[j] > this->model_.joint_max[j])
+            joints[j] -= 2 * M_PI;
+        if (joints[j] < this->model_.joint_min[j] || joints[j] > this->model_.joint_max[j])
+            return false;
+    }
+    return true;
+}
+
+bool BezierReachability::reachable(const Eigen::Affine3d &pose, double *joints) const
+{
+    double solutions[8][6];
+    if (inverse(pose, solutions) == 0)
+        return false;
+    for (int i = 0; i < 8; i++)
+    {
+        if (withinLimits(solutions[i]))
+        {
+            if (joints)
+                for (int j = 0; j < 6; j++)
+                    joints[j] = solutions[i][j];
+            return true;
+        }
+    }
+    return false;
+}
+
+//////////////////// BATCH ////////////////////
+long BezierReachability::check(const Poses &poses, std::vector<unsigned char> &reachable_flags) const
+{
+    const long number_of_poses = poses.size();
+    reachable_flags.assign(number_of_poses, 0);
+    long unreachable_poses = 0;
+#pragma omp parallel for schedule(dynamic, 256) reduction(+:unreachable_poses)
+    for (long i = 0; i < number_of_poses; i++)
+    {
+        reachable_flags[i] = reachable(poses[i]);
+        if (!reachable_flags[i])
+            unreachable_poses++;
+    }
+    return unreachable_poses;
+}
+
+long BezierReachability::reorient(Poses &poses, std::vector<unsigned char> &reachable_flags, double max_angle, double step) const
+{
+    const long number_of_poses = poses.size();
+    if (reachable_flags.size() != poses.size())
+        check(poses, reachable_flags);
+    long unreachable_poses = 0;
+#pragma omp parallel for schedule(dynamic, 16) reduction(+:unreachable_poses)
+    for (long i = 0; i < number_of_poses; i++)
+    {
+        if (reachable_flags[i])
+            continue;
+        for (double angle = step; step > 0 && angle <= max_angle + 1e-9 && !reachable_flags[i]; angle += step)
+        {
+            for (int sign = 1; sign >= -1 && !reachable_flags[i]; sign -= 2)
+            {
+                Eigen::Affine3d pose(poses[i] * Eigen::AngleAxisd(sign * angle, Eigen::Vector3d::UnitZ()));
+                if (reachable(pose))
+                {
+                    poses[i] = pose;
+                    reachable_flags[i] = 1;
+                }
+            }
+        }
+        if (!reachable_flags[i])
+            unreachable_poses++;
+    }
+    return unreachable_poses;
+}
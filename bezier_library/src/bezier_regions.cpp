@@ -0,0 +1,217 @@
+#include "bezier_library/bezier_regions.hpp"
+#include "bezier_library/bezier_impl.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+
+typedef std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > Poses;
+typedef std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> > Positions;
+
+//////////////////// CONSTRUCTORS ////////////////////
+BezierRegions::BezierRegions(std::string filename_inputMesh, std::string filename_defaultMesh, double grind_depth, double effector_diameter,
+                             double covering, int extrication_coefficiant, int extrication_frequency) :
+        grind_depth_(grind_depth), extrication_coefficiant_(extrication_coefficiant)
+{
+    this->impl_.reset(new BezierImpl(filename_inputMesh, filename_defaultMesh, grind_depth, effector_diameter, covering,
+                                     extrication_coefficiant, extrication_frequency));
+    //////////// NORMALS, PLANE MODEL AND CUT DIRECTION : ONCE FOR ALL REGIONS ////////////
+    if (!this->impl_->prepare())
+        return;
+    std::vector<vtkSmartPointer<vtkPolyData> > meshes;
+    this->impl_->splitDefaultMesh(meshes);
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        boost::shared_ptr<BezierImpl> region(new BezierImpl(*this->impl_, grind_depth, effector_diameter, covering,
+                                                            extrication_coefficiant, extrication_frequency));
+        region->set_default_mesh(meshes[i]);
+        this->regions_.push_back(region);
+    }
+}
+
+BezierRegions::BezierRegions(std::string filename_inputMesh, const std::vector<std::string> &filename_defaultMeshes, double grind_depth,
+                             double effector_diameter, double covering, int extrication_coefficiant, int extrication_frequency) :
+        grind_depth_(grind_depth), extrication_coefficiant_(extrication_coefficiant)
+{
+    this->impl_.reset(new BezierImpl(filename_inputMesh, filename_defaultMeshes.empty() ? std::string() : filename_defaultMeshes[0],
+                                     grind_depth, effector_diameter, covering, extrication_coefficiant, extrication_frequency));
+    //////////// NORMALS, PLANE MODEL AND CUT DIRECTION : ONCE FOR ALL REGIONS ////////////
+    if (!this->impl_->prepare())
+        return;
+    for (size_t i = 0; i < filename_defaultMeshes.size(); i++)
+    {
+        vtkSmartPointer<vtkPolyData> mesh;
+        if (!this->impl_->loadMesh(filename_defaultMeshes[i], mesh))
+        {
+            printf("\nCan't load default mesh %s", filename_defaultMeshes[i].c_str());
+            continue;
+        }
+        boost::shared_ptr<BezierImpl> region(new BezierImpl(*this->impl_, grind_depth, effector_diameter, covering,
+                                                            extrication_coefficiant, extrication_frequency));
+        region->set_default_mesh(mesh);
+        this->regions_.push_back(region);
+    }
+}
+
+BezierRegions::~BezierRegions(){}
+
+//////////////////// PATH GENERATION ////////////////////
+void BezierRegions::orderRegions(const Positions &starts, const Positions &ends, const Eigen::Vector3d &final_start, std::vector<int> &order)
+{
+    const int number_of_regions = starts.size();
+    double best_travel = std::numeric_limits<double>::max();
+    order.clear();
+    for (int first = 0; first < number_of_regions; first++)
+    {
+        std::vector<int> chain(1, first);
+        std::vector<bool> used(number_of_regions, false);
+        used[first] = true;
+        double travel = 0;
+        for (int k = 1; k < number_of_regions; k++)
+        {
+            // Closest region start from the end of the current region
+            int next = -1;
+            double next_distance = std::numeric_limits<double>::max();
+            for (int region = 0; region < number_of_regions; region++)
+            {
+                double distance = (starts[region] - ends[chain.back()]).norm();
+                if (!used[region] && distance < next_distance)
+                {
+                    next = region;
+                    next_distance = distance;
+                }
+            }
+            used[next] = true;
+            chain.push_back(next);
+            travel += next_distance;
+        }
+        travel += (final_start - ends[chain.back()]).norm();
+        if (travel < best_travel)
+        {
+            best_travel = travel;
+            order.swap(chain);
+        }
+    }
+}
+
+///@brief Pose moved back along its tool axis (Z axis points towards the surface)
+static Eigen::Affine3d liftPose(const Eigen::Affine3d &pose, double lift)
+{
+    Eigen::Affine3d lifted_pose(pose);
+    lifted_pose.translation() -= lift * pose.linear().col(2);
+    return lifted_pose;
+}
+
+bool BezierRegions::generateTrajectory(Poses &way_points_vector, std::vector<bool> &color_vector, std::vector<int> &index_vector,
+                                       std::vector<int> &region_vector)
+{
+    way_points_vector.clear();
+    color_vector.clear();
+    index_vector.clear();
+    region_vector.clear();
+    const int number_of_regions = this->regions_.size();
+    if (number_of_regions == 0)
+        return false;
+
+    //////////// DILATIONS : ONCE FOR ALL REGIONS, DEEP ENOUGH FOR THE DEEPEST PASS AND EXTRICATION ////////////
+    int number_of_depths = 0;
+    for (int region = 0; region < number_of_regions; region++)
+        number_of_depths = std::max(number_of_depths, this->regions_[region]->estimateNumberOfPasses());
+    number_of_depths += std::max(1, this->extrication_coefficiant_);
+    printf("\nRegions : %d regions, %d shared dilations", number_of_regions, number_of_depths);
+    if (!this->impl_->cacheDilations(number_of_depths))
+        return false;
+    for (int region = 0; region < number_of_regions; region++)
+        this->regions_[region]->shareDilations(*this->impl_);
+
+    //////////// REGIONS : DEFAULT INTERSECTION, SLICING, POSES AND EXTRICATIONS IN PARALLEL ////////////
+    std::vector<Poses> poses(number_of_regions);
+    std::vector<std::vector<bool> > colors(number_of_regions);
+    std::vector<std::vector<int> > indices(number_of_regions);
+    std::vector<unsigned char> succeeded(number_of_regions, 0);
+    int failures = 0;
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:failures)
+    for (int region = 0; region < number_of_regions; region++)
+    {
+        succeeded[region] = this->regions_[region]->generateTrajectory(poses[region], colors[region], indices[region]);
+        if (!succeeded[region])
+            failures++;
+    }
+
+    //////////// TRAVEL ORDER : REGION PASSES (INPUT MESH PASSE EXCLUDED) ////////////
+    // index_vector of a region : -1, end of each passe. Last passe is input mesh itself.
+    std::vector<int> active; // regions with at least one dilated passe
+    Positions starts, ends;
+    int final_region = -1; // region providing the final input mesh passe
+    int max_passes = 0;
+    for (int region = 0; region < number_of_regions; region++)
+    {
+        const int number_of_passes = succeeded[region] ? (int)indices[region].size() - 1 : 0;
+        if (number_of_passes < 1)
+            continue;
+        max_passes = std::max(max_passes, number_of_passes);
+        if (final_region < 0)
+            final_region = region;
+        if (number_of_passes < 2)
+            continue;
+        const int end = indices[region][number_of_passes - 1]; // last pose of last dilated passe
+        active.push_back(region);
+        starts.push_back(poses[region].front().translation());
+        ends.push_back(poses[region][end].translation());
+    }
+    if (final_region < 0)
+        return false;
+    const std::vector<int> &final_indices = indices[final_region];
+    const Eigen::Vector3d final_start = poses[final_region][final_indices[final_indices.size() - 2] + 1].translation();
+    std::vector<int> order;
+    orderRegions(starts, ends, final_start, order);
+
+    //////////// CONCATENATE REGIONS WITH LIFTED TRANSIT POSES ////////////
+    const double lift = (this->extrication_coefficiant_ + max_passes) * this->grind_depth_;
+    size_t total_poses = 2 * (order.size() + 1); // transit poses
+    for (int region = 0; region < number_of_regions; region++)
+        total_poses += poses[region].size();
+    way_points_vector.reserve(total_poses);
+    color_vector.reserve(total_poses);
+    index_vector.reserve(max_passes * number_of_regions + 1);
+    region_vector.reserve(max_passes * number_of_regions);
+    index_vector.push_back(-1);
+    for (size_t k = 0; k < order.size(); k++)
+    {
+        const int region = active[order[k]];
+        const int number_of_passes = indices[region].size() - 1;
+        if (!way_points_vector.empty())
+        {
+            way_points_vector.push_back(liftPose(way_points_vector.back(), lift));
+            way_points_vector.push_back(liftPose(poses[region].front(), lift));
+            color_vector.push_back(false);
+            color_vector.push_back(false);
+        }
+        const int offset = way_points_vector.size();
+        const int end = indices[region][number_of_passes - 1];
+        way_points_vector.insert(way_points_vector.end(), poses[region].begin(), poses[region].begin() + end + 1);
+        color_vector.insert(color_vector.end(), colors[region].begin(), colors[region].begin() + end + 1);
+        for (int passe = 0; passe < number_of_passes - 1; passe++)
+        {
+            index_vector.push_back(offset + indices[region][passe + 1]);
+            region_vector.push_back(region);
+        }
+    }
+    // Final passe : input mesh itself, ground once after all regions
+    const int final_begin = final_indices[final_indices.size() - 2] + 1;
+    if (!way_points_vector.empty())
+    {
+        way_points_vector.push_back(liftPose(way_points_vector.back(), lift));
+        way_points_vector.push_back(liftPose(poses[final_region][final_begin], lift));
+        color_vector.push_back(false);
+        color_vector.push_back(false);
+    }
+    way_points_vector.insert(way_points_vector.end(), poses[final_region].begin() + final_begin, poses[final_region].end());
+    color_vector.insert(color_vector.end(), colors[final_region].begin() + final_begin, colors[final_region].end());
+    index_vector.push_back(way_points_vector.size() - 1);
+    region_vector.push_back(-1);
+
+    printf("\nRegions : %lu regions with passes, %d failed, %lu poses\n", (unsigned long)order.size(), failures,
+           (unsigned long)way_points_vector.size());
+    return failures == 0;
+}
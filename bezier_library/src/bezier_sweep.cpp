@@ -0,0 +1,121 @@
+#include "bezier_library/bezier_sweep.hpp"
+#include "bezier_library/bezier_impl.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+#include <boost/shared_ptr.hpp>
+
+// PCL headers
+#include <pcl/common/time.h>
+
+//////////////////// SWEEP ////////////////////
+BezierSweep::BezierSweep(std::string filename_inputMesh, std::string filename_defaultMesh) :
+        shared_time_(0)
+{
+    BezierParameters parameters;
+    this->impl_.reset(new BezierImpl(filename_inputMesh, filename_defaultMesh, parameters.grind_depth, parameters.effector_diameter,
+                                     parameters.covering, parameters.extrication_coefficiant, parameters.extrication_frequency));
+}
+
+BezierSweep::~BezierSweep(){}
+
+void BezierSweep::grid(const std::vector<double> &grind_depths, const std::vector<double> &effector_diameters,
+                       const std::vector<double> &coverings, const std::vector<int> &extrication_coefficiants,
+                       const std::vector<int> &extrication_frequencies, std::vector<BezierParameters> &parameters)
+{
+    parameters.clear();
+    parameters.reserve(grind_depths.size() * effector_diameters.size() * coverings.size() * extrication_coefficiants.size()
+                       * extrication_frequencies.size());
+    for (size_t a = 0; a < grind_depths.size(); a++)
+        for (size_t b = 0; b < effector_diameters.size(); b++)
+            for (size_t c = 0; c < coverings.size(); c++)
+                for (size_t d = 0; d < extrication_coefficiants.size(); d++)
+                    for (size_t e = 0; e < extrication_frequencies.size(); e++)
+                        parameters.push_back(BezierParameters(grind_depths[a], effector_diameters[b], coverings[c],
+                                                              extrication_coefficiants[d], extrication_frequencies[e]));
+}
+
+bool BezierSweep::run(const std::vector<BezierParameters> &parameters, std::vector<BezierSweepResult> &results)
+{
+    results.clear();
+    if (parameters.empty())
+        return false;
+    pcl::StopWatch watch;
+    //////////// NORMALS, PLANE MODEL AND CUT DIRECTION : ONCE FOR ALL SETS ////////////
+    if (!this->impl_->prepare())
+        return false;
+
+    //////////// DISTANCE FIELD AND PASSES : ONCE PER GRIND DEPTH ////////////
+    std::vector<double> grind_depths;
+    std::vector<int> depth_indices(parameters.size());
+    for (size_t i = 0; i < parameters.size(); i++)
+    {
+        std::vector<double>::iterator it = std::find(grind_depths.begin(), grind_depths.end(), parameters[i].grind_depth);
+        depth_indices[i] = it - grind_depths.begin();
+        if (it == grind_depths.end())
+            grind_depths.push_back(parameters[i].grind_depth);
+    }
+    std::vector<boost::shared_ptr<BezierImpl> > passes(grind_depths.size());
+    for (size_t index_depth = 0; index_depth < grind_depths.size(); index_depth++)
+    {
+        // Deepest extrication of this grind depth : distance field is computed once for all sets
+        size_t first = std::find(depth_indices.begin(), depth_indices.end(), (int)index_depth) - depth_indices.begin();
+        int extrication_coefficiant = parameters[first].extrication_coefficiant;
+        for (size_t i = first; i < parameters.size(); i++)
+            if (depth_indices[i] == (int)index_depth)
+                extrication_coefficiant = std::max(extrication_coefficiant, parameters[i].extrication_coefficiant);
+        passes[index_depth].reset(new BezierImpl(*this->impl_, grind_depths[index_depth], parameters[first].effector_diameter,
+                                                 parameters[first].covering, extrication_coefficiant, parameters[first].extrication_frequency));
+        passes[index_depth]->generatePasses();
+    }
+
+    //////////// PARAMETER SETS : OBJECTS ARE BUILT FIRST (SHARED MESHES), PATHS ARE GENERATED IN PARALLEL ////////////
+    std::vector<boost::shared_ptr<BezierImpl> > sets(parameters.size());
+    for (size_t i = 0; i < parameters.size(); i++)
+        sets[i].reset(new BezierImpl(*passes[depth_indices[i]], parameters[i].grind_depth, parameters[i].effector_diameter,
+                                     parameters[i].covering, parameters[i].extrication_coefficiant, parameters[i].extrication_frequency));
+    this->shared_time_ = watch.getTimeSeconds();
+
+    results.resize(parameters.size());
+    int failures = 0;
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:failures)
+    for (int i = 0; i < (int)parameters.size(); i++)
+    {
+        pcl::StopWatch set_watch;
+        std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > way_points_vector;
+        std::vector<bool> color_vector;
+        std::vector<int> index_vector;
+        BezierSweepResult &result = results[i];
+        result.parameters = parameters[i];
+        result.success = sets[i]->generateTrajectory(way_points_vector, color_vector, index_vector);
+        result.number_of_passes = index_vector.empty() ? 0 : index_vector.size() - 1;
+        result.number_of_poses = way_points_vector.size();
+        result.path_length = 0;
+        for (size_t k = 1; k < way_points_vector.size(); k++)
+            result.path_length += (way_points_vector[k].translation() - way_points_vector[k - 1].translation()).norm();
+        BezierTrajectory::estimateCycleTime(way_points_vector, color_vector, index_vector, this->limits_, result.cycle);
+        result.compute_time = set_watch.getTimeSeconds();
+        sets[i].reset(); // release meshes of this set
+        if (!result.success)
+            failures++;
+    }
+    return failures == 0;
+}
+
+void BezierSweep::printTable(const std::vector<BezierSweepResult> &results)
+{
+    printf("\n%10s %10s %10s %6s %6s | %7s %8s %10s %9s | %9s %9s %5s %9s\n", "depth(mm)", "diam(mm)", "cover(%)", "ext.c", "ext.f",
+           "passes", "poses", "length(m)", "time(s)", "grind(m)", "air(m)", "rev.", "cycle(s)");
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BezierSweepResult &result = results[i];
+        printf("%10.2f %10.2f %10.1f %6d %6d | ", result.parameters.grind_depth * 1000.0, result.parameters.effector_diameter * 1000.0,
+               result.parameters.covering * 100.0, result.parameters.extrication_coefficiant, result.parameters.extrication_frequency);
+        if (result.success)
+            printf("%7d %8ld %10.3f %9.2f | %9.3f %9.3f %5d %9.1f\n", result.number_of_passes, result.number_of_poses, result.path_length,
+                   result.compute_time, result.cycle.grind_length, result.cycle.air_length, result.cycle.reversals, result.cycle.time);
+        else
+            printf("%7s %8s %10s %9.2f | %9s %9s %5s %9s\n", "failed", "-", "-", result.compute_time, "-", "-", "-", "-");
+    }
+}
@@ -0,0 +1,50 @@
+#include "bezier_library/bezier_tiling.hpp"
+#include "bezier_library/bezier_mesh_view.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+///@brief Estimated memory (in bytes) per triangle of a tile while it is dilated or sliced (tile copy, normals, kd-tree, cutter)
+static const double bytes_per_cell = 300;
+
+///@brief Maximal number of tiles
+static const int max_tiles = 256;
+
+BezierTiling::BezierTiling(const BezierMeshView &view, const Eigen::Vector3d &axis, int number_of_tiles) :
+        view_(view), axis_(axis)
+{
+    const vtkIdType number_of_triangles = view.numberOfTriangles();
+    this->projections_.resize(number_of_triangles);
+    double min_value = std::numeric_limits<double>::max(), max_value = -std::numeric_limits<double>::max();
+    for (vtkIdType index_triangle = 0; index_triangle < number_of_triangles; index_triangle++)
+    {
+        const vtkIdType *ids = view.triangle(index_triangle);
+        double projection = (project(view.point(ids[0])) + project(view.point(ids[1])) + project(view.point(ids[2]))) / 3;
+        this->projections_[index_triangle] = projection;
+        min_value = std::min(min_value, projection);
+        max_value = std::max(max_value, projection);
+    }
+    number_of_tiles = std::max(1, number_of_tiles);
+    this->limits_.resize(number_of_tiles + 1);
+    for (int tile = 0; tile <= number_of_tiles; tile++)
+        this->limits_[tile] = min_value + (max_value - min_value) * tile / number_of_tiles;
+}
+
+vtkSmartPointer<vtkPolyData> BezierTiling::extract(int tile, double margin) const
+{
+    const bool first = (tile == 0), last = (tile + 1 == numberOfTiles());
+    const double begin = this->limits_[tile] - margin, end = this->limits_[tile + 1] + margin;
+    std::vector<unsigned char> keep(this->projections_.size());
+    for (size_t index_triangle = 0; index_triangle < this->projections_.size(); index_triangle++)
+        keep[index_triangle] = (first || this->projections_[index_triangle] >= begin) && (last || this->projections_[index_triangle] < end);
+    return this->view_.extractTriangles(keep);
+}
+
+int BezierTiling::numberOfTiles(vtkIdType number_of_cells, double memory_budget, int parallel_tiles)
+{
+    if (!(memory_budget > 0) || number_of_cells <= 0)
+        return 1;
+    double memory = number_of_cells * bytes_per_cell * std::max(1, parallel_tiles);
+    return std::min(max_tiles, std::max(1, (int)std::ceil(memory / (memory_budget * 1e6))));
+}
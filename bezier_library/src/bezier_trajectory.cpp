@@ -0,0 +1,244 @@
+#include "bezier_library/bezier_trajectory.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+//////////////////// LIMITS ////////////////////
+BezierTrajectoryLimits::BezierTrajectoryLimits() :
+        grind_velocity(0.02), extrication_velocity(0.1), acceleration(0.5), angular_velocity(1.0), junction_deviation(0.0005)
+{
+}
+
+BezierCycleEstimate::BezierCycleEstimate() :
+        grind_length(0), air_length(0), reversals(0), stops(0), time(0)
+{
+}
+
+//////////////////// TIME PARAMETERISATION ////////////////////
+///@brief Time needed to travel a segment from velocity v_start to v_end, with cruise velocity v_max and acceleration a
+static double segmentTime(double length, double v_start, double v_end, double v_max, double a)
+{
+    // Peak velocity reached if there is no cruise
+    double v_peak = std::min(v_max, std::sqrt((2 * a * length + v_start * v_start + v_end * v_end) / 2));
+    if (v_peak <= 0)
+        return 0;
+    double d_acceleration = (v_peak * v_peak - v_start * v_start) / (2 * a);
+    double d_deceleration = (v_peak * v_peak - v_end * v_end) / (2 * a);
+    double d_cruise = std::max(0.0, length - d_acceleration - d_deceleration);
+    return (v_peak - v_start) / a + (v_peak - v_end) / a + d_cruise / v_peak;
+}
+
+bool BezierTrajectory::timeParameterise(const std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector,
+                                        const std::vector<bool> &color_vector, const BezierTrajectoryLimits &limits, Points &trajectory)
+{
+    trajectory.clear();
+    if (way_points_vector.size() != color_vector.size())
+    {
+        printf("\nTrajectory vector and bool vector have differents sizes in timeParameterise function");
+        return false;
+    }
+    if (limits.grind_velocity <= 0 || limits.extrication_velocity <= 0 || limits.acceleration <= 0 || limits.angular_velocity <= 0)
+    {
+        printf("\nTrajectory limits must be strictly positive");
+        return false;
+    }
+    if (way_points_vector.empty())
+        return true;
+
+    // Remove duplicate poses
+    trajectory.reserve(way_points_vector.size());
+    std::vector<Eigen::Quaterniond, Eigen::aligned_allocator<Eigen::Quaterniond> > rotations;
+    rotations.reserve(way_points_vector.size());
+    for (size_t i = 0; i < way_points_vector.size(); i++)
+    {
+        Eigen::Quaterniond rotation(way_points_vector[i].linear());
+        if (!trajectory.empty() && (way_points_vector[i].translation() - trajectory.back().pose.translation()).norm() < 1e-9
+                && rotations.back().angularDistance(rotation) < 1e-9)
+            continue;
+        BezierTrajectoryPoint point;
+        point.pose = way_points_vector[i];
+        point.velocity.setZero();
+        point.time = 0;
+        point.grind = color_vector[i];
+        trajectory.push_back(point);
+        rotations.push_back(rotation);
+    }
+    const size_t number_of_points = trajectory.size();
+    if (number_of_points < 2)
+        return true;
+
+    // Segments : length, direction, angle and velocity limit
+    const size_t number_of_segments = number_of_points - 1;
+    std::vector<double> lengths(number_of_segments), angles(number_of_segments), segment_velocities(number_of_segments);
+    std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> > directions(number_of_segments);
+    for (size_t k = 0; k < number_of_segments; k++)
+    {
+        Eigen::Vector3d segment(trajectory[k + 1].pose.translation() - trajectory[k].pose.translation());
+        lengths[k] = segment.norm();
+        directions[k] = lengths[k] > 0 ? Eigen::Vector3d(segment / lengths[k]) : Eigen::Vector3d::Zero();
+        angles[k] = rotations[k].angularDistance(rotations[k + 1]);
+        segment_velocities[k] = (trajectory[k].grind && trajectory[k + 1].grind) ? limits.grind_velocity : limits.extrication_velocity;
+        if (angles[k] > 0) //tool rotation must not be faster than angular velocity
+            segment_velocities[k] = std::min(segment_velocities[k], lengths[k] * limits.angular_velocity / angles[k]);
+    }
+
+    // Velocity at each point : segment limits and junction deviation (start and end at rest)
+    std::vector<double> velocities(number_of_points, 0);
+    for (size_t k = 1; k + 1 < number_of_points; k++)
+    {
+        double velocity = std::min(segment_velocities[k - 1], segment_velocities[k]);
+        if (lengths[k - 1] == 0 || lengths[k] == 0)
+            velocity = 0; //rotation in place
+        else
+        {
+            double cos_theta = -directions[k - 1].dot(directions[k]);
+            double sin_half_theta = std::sqrt(std::max(0.0, (1 - cos_theta) / 2));
+            if (sin_half_theta < 1 - 1e-6) //not a straight line
+                velocity = std::min(velocity, std::sqrt(limits.acceleration * limits.junction_deviation * sin_half_theta / (1 - sin_half_theta)));
+        }
+        velocities[k] = velocity;
+    }
+    // Acceleration limit : forward then backward pass
+    for (size_t k = 0; k < number_of_segments; k++)
+        velocities[k + 1] = std::min(velocities[k + 1], std::sqrt(velocities[k] * velocities[k] + 2 * limits.acceleration * lengths[k]));
+    for (size_t k = number_of_segments; k > 0; k--)
+        velocities[k - 1] = std::min(velocities[k - 1], std::sqrt(velocities[k] * velocities[k] + 2 * limits.acceleration * lengths[k - 1]));
+
+    // Times and velocity vectors
+    for (size_t k = 0; k < number_of_segments; k++)
+    {
+        double time = segmentTime(lengths[k], velocities[k], velocities[k + 1], segment_velocities[k], limits.acceleration);
+        time = std::max(time, angles[k] / limits.angular_velocity);
+        trajectory[k + 1].time = trajectory[k].time + time;
+        trajectory[k].velocity = velocities[k] * directions[k];
+    }
+    trajectory.back().velocity.setZero();
+    return true;
+}
+
+Eigen::Affine3d BezierTrajectory::sample(const Points &trajectory, double time)
+{
+    if (trajectory.empty())
+        return Eigen::Affine3d::Identity();
+    if (time <= trajectory.front().time)
+        return trajectory.front().pose;
+    if (time >= trajectory.back().time)
+        return trajectory.back().pose;
+    // First point after time
+    size_t begin = 0, end = trajectory.size() - 1;
+    while (end - begin > 1)
+    {
+        size_t middle = (begin + end) / 2;
+        if (trajectory[middle].time <= time)
+            begin = middle;
+        else
+            end = middle;
+    }
+    const BezierTrajectoryPoint &a = trajectory[begin];
+    const BezierTrajectoryPoint &b = trajectory[end];
+    double ratio = (b.time > a.time) ? (time - a.time) / (b.time - a.time) : 1;
+    Eigen::Affine3d pose(Eigen::Affine3d::Identity());
+    pose.linear() = Eigen::Quaterniond(a.pose.linear()).slerp(ratio, Eigen::Quaterniond(b.pose.linear())).toRotationMatrix();
+    pose.translation() = (1 - ratio) * a.pose.translation() + ratio * b.pose.translation();
+    return pose;
+}
+
+//////////////////// CYCLE TIME ESTIMATE ////////////////////
+///@brief Time of a run between two stops : cruise time, plus acceleration from v_start and deceleration to v_end
+static double runTime(double length, double cruise_time, double v_start, double v_end, double a)
+{
+    if (length <= 0)
+        return cruise_time;
+    if (length >= (v_start * v_start + v_end * v_end) / (2 * a))
+        return cruise_time + (v_start + v_end) / (2 * a);
+    return std::max(cruise_time, 2 * std::sqrt(length / a)); // velocity limit never reached
+}
+
+bool BezierTrajectory::estimateCycleTime(const std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > &way_points_vector,
+                                         const std::vector<bool> &color_vector, const std::vector<int> &index_vector,
+                                         const BezierTrajectoryLimits &limits, BezierCycleEstimate &estimate)
+{
+    estimate = BezierCycleEstimate();
+    if (way_points_vector.size() != color_vector.size())
+    {
+        printf("\nTrajectory vector and bool vector have differents sizes in estimateCycleTime function");
+        return false;
+    }
+    if (limits.grind_velocity <= 0 || limits.extrication_velocity <= 0 || limits.acceleration <= 0 || limits.angular_velocity <= 0)
+    {
+        printf("\nTrajectory limits must be strictly positive");
+        return false;
+    }
+    const double a = limits.acceleration;
+    size_t next_passe = 1; // first passe whose last pose is not before the previous pose
+    // Current run
+    double run_length = 0, run_cruise_time = 0, run_v_start = 0, run_v_end = 0;
+    // Directions of the two previous segments : a turnaround often has a short move in between (line step, extrication lift)
+    Eigen::Vector3d previous_direction(Eigen::Vector3d::Zero()), previous_direction2(Eigen::Vector3d::Zero());
+    bool pending_stop = false;
+    for (size_t k = 0; k + 1 < way_points_vector.size(); k++)
+    {
+        const Eigen::Vector3d segment(way_points_vector[k + 1].translation() - way_points_vector[k].translation());
+        const double length = segment.norm();
+        // Rotation angle between frames : trace of relative rotation
+        const double trace = (way_points_vector[k].linear().transpose() * way_points_vector[k + 1].linear()).trace();
+        const double angle = std::acos(std::min(1.0, std::max(-1.0, (trace - 1) / 2)));
+        const bool grind = color_vector[k] && color_vector[k + 1];
+        (grind ? estimate.grind_length : estimate.air_length) += length;
+
+        // Tool stops before this segment : trajectory start, passe end (segment to next passe), passe start, reversal or rotation in place
+        const int index = k;
+        while (next_passe < index_vector.size() && index_vector[next_passe] < index - 1)
+            next_passe++;
+        bool stop = (k == 0) || pending_stop;
+        for (size_t j = next_passe; j < index_vector.size() && index_vector[j] <= index; j++)
+            stop = true; // index_vector[j] is index - 1 (passe start) or index (passe end)
+        pending_stop = false;
+        if (length < 1e-9 && angle < 1e-9) // duplicate pose : stop is applied to next segment
+        {
+            pending_stop = stop;
+            continue;
+        }
+        const Eigen::Vector3d direction(length > 0 ? Eigen::Vector3d(segment / length) : Eigen::Vector3d::Zero());
+        const bool reversal = length > 0 && (previous_direction.dot(direction) < 0 || previous_direction2.dot(direction) < 0);
+        if (reversal)
+        {
+            estimate.reversals++;
+            previous_direction.setZero(); // a turnaround is counted once
+        }
+        if (stop || reversal || length == 0)
+        {
+            estimate.time += runTime(run_length, run_cruise_time, run_v_start, run_v_end, a);
+            if (run_length > 0)
+                estimate.stops++;
+            run_length = run_cruise_time = run_v_start = run_v_end = 0;
+        }
+        if (length > 0)
+        {
+            previous_direction2 = previous_direction;
+            previous_direction = direction;
+        }
+
+        if (length == 0) // rotation in place
+        {
+            estimate.time += angle / limits.angular_velocity;
+            continue;
+        }
+        double velocity = grind ? limits.grind_velocity : limits.extrication_velocity;
+        if (angle > 0) //tool rotation must not be faster than angular velocity
+            velocity = std::min(velocity, length * limits.angular_velocity / angle);
+        if (run_length == 0)
+            run_v_start = velocity;
+        run_v_end = velocity;
+        run_length += length;
+        run_cruise_time += length / velocity;
+    }
+    if (run_length > 0)
+    {
+        estimate.time += runTime(run_length, run_cruise_time, run_v_start, run_v_end, a);
+        estimate.stops++;
+    }
+    return true;
+}
@@ -0,0 +1,67 @@
+#include "bezier_library/bezier_sweep.hpp"
+
+#include <cstdio>
+#include <vector>
+
+// PCL headers
+#include <pcl/console/parse.h>
+
+/**
+ * @file parameter_sweep.cpp
+ * @brief Generate paths of one part for a grid of grinding parameters and print a table of results.
+ * Usage : parameter_sweep input.ply default.ply [--depth 0.05,0.03] [--diameter 0.1] [--covering 0.3,0.5]
+ *         [--extrication_coefficiant 1] [--extrication_frequency 5] [--feed 0.02] [--rapid 0.1] [--acceleration 0.5]
+ * Each option is a comma separated list of values (lengths in meters), all combinations are generated.
+ * Feed rate, rapid (extrication) velocity and acceleration are single values used to estimate cycle times.
+ */
+
+/** @brief Read a comma separated list of values, keep default value if option is missing
+ * @param[in] argc
+ * @param[in] argv
+ * @param[in] option option name
+ * @param[in] default_value value used if option is missing
+ * @param[out] values list of values */
+template <typename T>
+void parseValues(int argc, char **argv, const char *option, T default_value, std::vector<T> &values)
+{
+    values.clear();
+    if (pcl::console::parse_x_arguments(argc, argv, option, values) < 0 || values.empty())
+        values.assign(1, default_value);
+}
+
+/** @brief The main function
+ * @param[in] argc
+ * @param[in] argv input mesh, default mesh and parameter lists
+ * @return Exit status */
+int main(int argc, char **argv)
+{
+    std::vector<int> ply_indices = pcl::console::parse_file_extension_argument(argc, argv, ".ply");
+    if (ply_indices.size() != 2)
+    {
+        printf("Usage : %s input.ply default.ply [--depth 0.05,0.03] [--diameter 0.1] [--covering 0.3,0.5] "
+               "[--extrication_coefficiant 1] [--extrication_frequency 5] [--feed 0.02] [--rapid 0.1] [--acceleration 0.5]\n", argv[0]);
+        return -1;
+    }
+    BezierParameters defaults;
+    std::vector<double> grind_depths, effector_diameters, coverings;
+    std::vector<int> extrication_coefficiants, extrication_frequencies;
+    parseValues(argc, argv, "--depth", defaults.grind_depth, grind_depths);
+    parseValues(argc, argv, "--diameter", defaults.effector_diameter, effector_diameters);
+    parseValues(argc, argv, "--covering", defaults.covering, coverings);
+    parseValues(argc, argv, "--extrication_coefficiant", defaults.extrication_coefficiant, extrication_coefficiants);
+    parseValues(argc, argv, "--extrication_frequency", defaults.extrication_frequency, extrication_frequencies);
+
+    std::vector<BezierParameters> parameters;
+    BezierSweep::grid(grind_depths, effector_diameters, coverings, extrication_coefficiants, extrication_frequencies, parameters);
+    BezierTrajectoryLimits limits;
+    pcl::console::parse_argument(argc, argv, "--feed", limits.grind_velocity);
+    pcl::console::parse_argument(argc, argv, "--rapid", limits.extrication_velocity);
+    pcl::console::parse_argument(argc, argv, "--acceleration", limits.acceleration);
+    BezierSweep sweep(argv[ply_indices[0]], argv[ply_indices[1]]);
+    sweep.set_trajectory_limits(limits);
+    std::vector<BezierSweepResult> results;
+    bool success = sweep.run(parameters, results);
+    BezierSweep::printTable(results);
+    printf("Shared work (normals, plane model, distance fields and passes) : %.2f s\n", sweep.get_shared_time());
+    return success ? 0 : 1;
+}
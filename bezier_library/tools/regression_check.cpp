@@ -0,0 +1,173 @@
+#include "bezier_library/bezier_library.hpp"
+#include "bezier_library/bezier_checkpoint.hpp"
+#include "bezier_library/bezier_comparison.hpp"
+#ifndef BEZIER_BASELINE_ENGINE
+#include "bezier_library/bezier_preview.hpp"
+#endif
+#include "bezier_library/bezier_sweep.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// PCL headers
+#include <pcl/console/parse.h>
+
+/**
+ * @file regression_check.cpp
+ * @brief Generate paths of meshes and compare them with reference outputs (golden files) within geometric tolerances.
+ * Usage : regression_check [--record] [--reference_directory dir] [--tiling memory_budget] [--distance 0.001]
+ *         [--extrication_distance 0.005] [--angle 0.0175] mesh_1.ply [mesh_2.ply ...]
+ * Each mesh.ply with a mesh_default.ply is planned with bezier_application parameters (see BezierParameters).
+ * With --record, outputs are saved as references (mesh.reference in reference directory, default is the mesh directory).
+ * Without it, outputs are compared with references (see BezierComparison) : exit status is 0 only if all paths are equivalent.
+ * With --tiling, no reference is used : paths planned tile by tile (memory budget in megabytes, see Bezier::set_tiling)
+ * are compared with in-core paths of the same meshes, within the same tolerances. Tiles sample the shared distance field grid :
+ * in-core paths are planned with BezierResolution::shared_field too.
+ * Built with BEZIER_BASELINE_ENGINE, paths are planned with the baseline engine (sources of the baseline commit, see
+ * bezier_library_record_references) : only its public API is used, and --tiling is not available.
+ */
+
+/** @brief Check if a string ends with a suffix
+ * @param[in] value string
+ * @param[in] suffix suffix
+ * @return true if value ends with suffix */
+static bool endsWith(const std::string &value, const std::string &suffix)
+{
+    return value.size() >= suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/** @brief The main function
+ * @param[in] argc
+ * @param[in] argv options and input meshes
+ * @return Exit status */
+int main(int argc, char **argv)
+{
+    std::vector<int> ply_indices = pcl::console::parse_file_extension_argument(argc, argv, ".ply");
+    if (ply_indices.empty())
+    {
+        printf("Usage : %s [--record] [--reference_directory dir] [--tiling memory_budget] [--distance 0.001] "
+               "[--extrication_distance 0.005] [--angle 0.0175] mesh_1.ply [mesh_2.ply ...]\n", argv[0]);
+        return -1;
+    }
+    const bool record = pcl::console::find_switch(argc, argv, "--record");
+    std::string reference_directory;
+    pcl::console::parse_argument(argc, argv, "--reference_directory", reference_directory);
+    if (!reference_directory.empty() && !endsWith(reference_directory, "/"))
+        reference_directory += "/";
+    BezierComparisonTolerances tolerances;
+    pcl::console::parse_argument(argc, argv, "--distance", tolerances.distance);
+    pcl::console::parse_argument(argc, argv, "--extrication_distance", tolerances.extrication_distance);
+    pcl::console::parse_argument(argc, argv, "--angle", tolerances.angle);
+    double tiling = 0;
+    pcl::console::parse_argument(argc, argv, "--tiling", tiling);
+    if (record && tiling > 0)
+    {
+        printf("--record and --tiling can't be used together : tiled paths are compared with in-core paths\n");
+        return -1;
+    }
+#ifdef BEZIER_BASELINE_ENGINE
+    if (tiling > 0)
+    {
+        printf("--tiling can't be used with the baseline engine\n");
+        return -1;
+    }
+#endif
+
+    // References are only valid for the parameters used to record them
+    const BezierParameters parameters;
+    std::ostringstream reference_id;
+    reference_id << "reference " << parameters.grind_depth << " " << parameters.effector_diameter << " " << parameters.covering << " "
+                 << parameters.extrication_coefficiant << " " << parameters.extrication_frequency;
+
+    printf("%-40s %7s %8s | %12s %12s %12s | %s\n", "mesh", "passes", "poses", "lines(mm)", "passes(mm)", "frames(deg)", "result");
+    int failures = 0, checked = 0;
+    for (size_t index_file = 0; index_file < ply_indices.size(); index_file++)
+    {
+        const std::string input_mesh(argv[ply_indices[index_file]]);
+        if (endsWith(input_mesh, "_default.ply"))
+            continue;
+        const std::string stem(input_mesh.substr(0, input_mesh.size() - 4));
+        const std::string default_mesh(stem + "_default.ply");
+        if (!std::ifstream(default_mesh.c_str()))
+            continue;
+        const size_t name_start = stem.find_last_of('/');
+        const std::string name(name_start == std::string::npos ? stem : stem.substr(name_start + 1));
+        const std::string reference_file((reference_directory.empty() ? stem : reference_directory + name) + ".reference");
+        checked++;
+
+        std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > poses;
+        std::vector<bool> colors, reachable;
+        std::vector<int> indices;
+        Bezier bezier(input_mesh, default_mesh, parameters.grind_depth, parameters.effector_diameter, parameters.covering,
+                      parameters.extrication_coefficiant, parameters.extrication_frequency);
+#ifndef BEZIER_BASELINE_ENGINE
+        if (tiling > 0)
+        {
+            BezierResolution shared_field_resolution;
+            shared_field_resolution.shared_field = true;
+            bezier.set_resolution(shared_field_resolution);
+        }
+#endif
+        if (!bezier.generateTrajectory(poses, colors, indices))
+        {
+            printf("%-40s %7s %8s | %12s %12s %12s | %s\n", name.c_str(), "-", "-", "-", "-", "-", "GENERATION FAILED");
+            failures++;
+            continue;
+        }
+        const int passes = indices.size() - 1;
+        if (record)
+        {
+            bool saved = BezierCheckpoint::saveTrajectory(reference_file, reference_id.str(), poses, colors, indices, reachable);
+            printf("%-40s %7d %8lu | %12s %12s %12s | %s\n", name.c_str(), passes, (unsigned long)poses.size(), "-", "-", "-",
+                   saved ? "RECORDED" : "NOT RECORDED");
+            if (!saved)
+                failures++;
+            continue;
+        }
+
+        std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > reference_poses;
+        std::vector<bool> reference_colors, reference_reachable;
+        std::vector<int> reference_indices;
+#ifndef BEZIER_BASELINE_ENGINE
+        if (tiling > 0)
+        {
+            // In-core path is the reference of the tiled path
+            reference_poses.swap(poses);
+            reference_colors.swap(colors);
+            reference_indices.swap(indices);
+            Bezier tiled_bezier(input_mesh, default_mesh, parameters.grind_depth, parameters.effector_diameter, parameters.covering,
+                                parameters.extrication_coefficiant, parameters.extrication_frequency);
+            tiled_bezier.set_tiling(tiling, 1);
+            if (!tiled_bezier.generateTrajectory(poses, colors, indices))
+            {
+                printf("%-40s %7s %8s | %12s %12s %12s | %s\n", name.c_str(), "-", "-", "-", "-", "-", "TILED GENERATION FAILED");
+                failures++;
+                continue;
+            }
+        }
+        else
+#endif
+        if (!BezierCheckpoint::loadTrajectory(reference_file, reference_id.str(), reference_poses, reference_colors, reference_indices,
+                                              reference_reachable))
+        {
+            printf("%-40s %7d %8lu | %12s %12s %12s | %s\n", name.c_str(), passes, (unsigned long)poses.size(), "-", "-", "-",
+                   "NO REFERENCE (use --record)");
+            failures++;
+            continue;
+        }
+        const int compared_passes = indices.size() - 1;
+        BezierComparisonReport report;
+        bool equivalent = BezierComparison::compare(reference_poses, reference_colors, reference_indices, poses, colors, indices,
+                                                    tolerances, report);
+        printf("%-40s %7d %8lu | %12.4f %12.4f %12.4f | %s\n", name.c_str(), compared_passes, (unsigned long)poses.size(), report.max_distance * 1000,
+               report.max_extrication_distance * 1000, report.max_angle * 180 / M_PI, equivalent ? "OK" : report.message.c_str());
+        if (!equivalent)
+            failures++;
+    }
+    printf("%d meshes, %d failures\n", checked, failures);
+    return (failures == 0 && checked > 0) ? 0 : 1;
+}